@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "compare.h"
+
+
+SharedComparePtr Compare::NullComparePtr;
+const uint8_t Compare::Opcode = 0x05;
+
+
+Compare::Compare() : Cmd(Trackable::OBJ_COMPARE)
+{
+    Init(Opcode, DATADIR_TO_DEVICE, 64);
+
+    // No cmd should ever be created which violates these masking possibilities
+    send_64b_bitmask allowPrpMask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+    SetPrpAllowed(allowPrpMask);
+}
+
+
+Compare::~Compare()
+{
+}
+
+
+void
+Compare::SetSLBA(uint64_t lba)
+{
+    LOG_NRM("Setting SLBA = 0x%016llX", (long long unsigned int)lba);
+    SetDword((uint32_t)(lba >> 0), 10);
+    SetDword((uint32_t)(lba >> 32), 11);
+}
+
+
+uint64_t
+Compare::GetSLBA() const
+{
+    uint64_t lba = 0;
+    LOG_NRM("Getting SLBA");
+    lba =  (((uint64_t)GetDword(10)) << 0);
+    lba |= (((uint64_t)GetDword(11)) << 32);
+    return lba;
+}
+
+
+void
+Compare::SetLR(bool lr)
+{
+    LOG_NRM("Setting LR = %d", lr ? 1 : 0);
+    SetBit(lr, 12, 31);
+}
+
+
+bool
+Compare::GetLR() const
+{
+    LOG_NRM("Getting LR");
+    return GetBit(12, 31);
+}
+
+
+void
+Compare::SetFUA(bool fua)
+{
+    LOG_NRM("Setting FUA = %d", fua ? 1 : 0);
+    SetBit(fua, 12, 30);
+}
+
+
+bool
+Compare::GetFUA() const
+{
+    LOG_NRM("Getting FUA");
+    return GetBit(12, 30);
+}
+
+
+void
+Compare::SetPRINFO(uint8_t prinfo)
+{
+    LOG_NRM("Setting PRINFO = 0x%01X", prinfo);
+
+    if (prinfo > 0x0f)
+        throw FrmwkEx(HERE, "Value to large; must fit within 4 bits");
+
+    uint16_t work = GetWord(12, 1);
+    work &= ~0x3C00;
+    work |= (prinfo << 10);
+    SetWord(work, 12, 1);
+}
+
+
+uint8_t
+Compare::GetPRINFO() const
+{
+    LOG_NRM("Getting PRINFO");
+    return (uint8_t)(GetWord(12, 1) >> 10);
+}
+
+
+void
+Compare::SetNLB(uint16_t nlb)
+{
+    LOG_NRM("Setting NLB = 0x%04X", nlb);
+    SetWord(nlb, 12, 0);
+}
+
+
+uint16_t
+Compare::GetNLB() const
+{
+    LOG_NRM("Getting NLB");
+    return GetWord(12, 0);
+}
+
+
+void
+Compare::SetILBRT(uint32_t ilbrt)
+{
+    LOG_NRM("Setting ILBRT = 0x%08X", ilbrt);
+    SetDword(ilbrt, 14);
+}
+
+
+uint32_t
+Compare::GetILBRT() const
+{
+    LOG_NRM("Getting ILBRT");
+    return GetDword(14);
+}
+
+
+void
+Compare::SetLBATM(uint16_t lbatm)
+{
+    LOG_NRM("Setting LBATM = 0x%04X", lbatm);
+    SetWord(lbatm, 15, 1);
+}
+
+
+uint16_t
+Compare::GetLBATM() const
+{
+    LOG_NRM("Getting LBATM");
+    return GetWord(15, 1);
+}
+
+
+void
+Compare::SetLBAT(uint16_t lbat)
+{
+    LOG_NRM("Setting LBAT = 0x%04X", lbat);
+    SetWord(lbat, 15, 0);
+}
+
+
+uint16_t
+Compare::GetLBAT() const
+{
+    LOG_NRM("Getting LBAT");
+    return GetWord(15, 0);
+}
+
@@ -16,6 +16,7 @@
 
 #include "getLogPage.h"
 #include "globals.h"
+#include "../Utils/dumpArchive.h"
 
 #define NUMD_BITMASK        0x0fff
 
@@ -132,7 +133,7 @@ GetLogPage::Dump(DumpFilename filename, string fileHdr) const
     Cmd::Dump(filename, fileHdr);
 
     // Reopen the file and append the same data in a different format
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
+    if ((fp = DumpArchive::OpenDump(filename)) == NULL)
         throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
 
     fprintf(fp, "\n------------------------------------------------------\n");
@@ -161,7 +162,7 @@ GetLogPage::Dump(DumpFilename filename, string fileHdr) const
         break;
     }
 
-    fclose(fp);
+    DumpArchive::CloseDump(fp);
 }
 
 
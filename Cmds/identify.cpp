@@ -19,6 +19,7 @@
 #include <string.h>
 #include "identify.h"
 #include "../Utils/buffers.h"
+#include "../Utils/dumpArchive.h"
 #include "../Utils/fileSystem.h"
 #include "../Singletons/regDefs.h"
 #include "../globals.h"
@@ -186,7 +187,7 @@ Identify::Dump(DumpFilename filename, string fileHdr) const
     Cmd::Dump(filename, fileHdr);
 
     // Reopen the file and append the same data in a different format
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
+    if ((fp = DumpArchive::OpenDump(filename)) == NULL)
         throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
 
     fprintf(fp, "\n------------------------------------------------------\n");
@@ -201,7 +202,7 @@ Identify::Dump(DumpFilename filename, string fileHdr) const
         for (int i = 0; i < IDNAMESPC_FENCE; i++)
             Dump(fp, i, mIdNamespcType);
     }
-    fclose(fp);
+    DumpArchive::CloseDump(fp);
 }
 
 
@@ -25,6 +25,7 @@ PrpData::PrpData()
 {
     mBufRW = MemBuffer::NullMemBufferPtr;
     mBufRO = NULL;
+    mBufOffset = 0;
     mBufSize = 0;
     mPrpFields = (send_64b_bitmask)0;   // What this cmd wants to use
     mPrpAllowed = (send_64b_bitmask)0;  // What this cmd is allowed to use
@@ -59,6 +60,7 @@ PrpData::SetPrpBuffer(send_64b_bitmask prpFields, SharedMemBufferPtr memBuffer)
         mBufRW.reset();
 
     mBufRW = memBuffer;
+    mBufOffset = 0;
     mBufSize = memBuffer->GetBufSize();
     mPrpFields = prpFields;
 }
@@ -73,10 +75,32 @@ PrpData::SetPrpBufferUnsafe(send_64b_bitmask prpFields, SharedMemBufferPtr memBu
         mBufRW.reset();
 
     mBufRW = memBuffer;
+    mBufOffset = 0;
     mBufSize = memBuffer->GetBufSize();
     mPrpFields = prpFields;
 }
 
+void
+PrpData::SetPrpBuffer(send_64b_bitmask prpFields, SharedMemBufferPtr memBuffer,
+    uint64_t offset, uint64_t size)
+{
+    if ((offset + size) > memBuffer->GetBufSize()) {
+        throw FrmwkEx(HERE, "Sub-range 0x%llX+0x%llX exceeds buffer size 0x%X",
+            (long long unsigned int)offset, (long long unsigned int)size,
+            memBuffer->GetBufSize());
+    } else if (offset & 0x3) {
+        throw FrmwkEx(HERE, "Sub-range offset 0x%llX is not DWORD aligned",
+            (long long unsigned int)offset);
+    } else if (size == 0) {
+        throw FrmwkEx(HERE, "Setting zero length PRP buffer not allowed");
+    }
+
+    SetPrpBuffer(prpFields, memBuffer);     // enforces all other rules
+    mBufOffset = offset;
+    mBufSize = size;
+}
+
+
 void
 PrpData::SetPrpBuffer(send_64b_bitmask prpFields, uint8_t const *memBuffer,
     uint64_t bufSize)
@@ -120,7 +144,7 @@ uint8_t const *
 PrpData::GetROPrpBuffer() const
 {
     if (mBufRW != MemBuffer::NullMemBufferPtr)
-        return mBufRW->GetBuffer();
+        return (mBufRW->GetBuffer() + mBufOffset);
     else if (mBufRO != NULL)
         return mBufRO;
     return NULL;
@@ -51,6 +51,24 @@ public:
      */
     void SetPrpBuffer(send_64b_bitmask prpFields, SharedMemBufferPtr memBuffer);
     void SetPrpBufferUnsafe(send_64b_bitmask prpFields, SharedMemBufferPtr memBuffer);
+
+    /**
+     * Accept a sub-range of a previously created RW user space buffer as the
+     * user data buffer, without copying it. Many cmds may thus each reference
+     * a different piece of 1 large buffer. GetRWPrpBuffer() still returns the
+     * entire buffer while GetROPrpBuffer() and GetPrpBufferSize() describe
+     * only the sub-range.
+     * @param prpFields Pass the appropriate combination of bitfields to
+     *      indicate to dnvme how to populate the PRP fields of a cmd with
+     *      this the buffer.
+     * @param memBuffer Pass the buffer containing the sub-range
+     * @param offset Pass the byte offset of the sub-range, must be DWORD
+     *      aligned as required of PRP entries
+     * @param size Pass the number of bytes of the sub-range
+     */
+    void SetPrpBuffer(send_64b_bitmask prpFields, SharedMemBufferPtr memBuffer,
+        uint64_t offset, uint64_t size);
+
     /**
      * This method is only safe to use if and only if the
      * SetPrpBuffer(SharedMemBufferPtr) was used to setup a buffer. This allows
@@ -126,6 +144,8 @@ private:
     SharedMemBufferPtr mBufRW;
     /// Used for RO memory assoc with a IOQ's data memory
     uint8_t const *mBufRO;
+    /// Offset into mBufRW of the 1st byte of user data
+    uint64_t mBufOffset;
     /// Number of bytes consisting of either mBufRO or mBufRW
     uint64_t mBufSize;
 
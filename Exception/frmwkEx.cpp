@@ -21,6 +21,7 @@
 #include "globals.h"
 #include "../Utils/kernelAPI.h"
 #include "../Utils/io.h"
+#include "../Utils/probes.h"
 #include "../Cmds/getLogPage.h"
 
 #define GRP_NAME            "post"
@@ -33,6 +34,7 @@ FrmwkEx::FrmwkEx(string filename, int lineNum)
 {
     LOG_ERR("Exception: %s:#%d: FAILURE: no reason supplied",
         filename.c_str(), lineNum);
+    TNVME_PROBE3(frmwk_ex, filename.c_str(), lineNum, "");
     DumpStateOfTheSystem();
 }
 
@@ -42,6 +44,7 @@ FrmwkEx::FrmwkEx(string filename, int lineNum, string &msg)
     mMsg = msg;
     LOG_ERR("Exception: %s:#%d: FAILURE: %s", filename.c_str(), lineNum,
         mMsg.c_str());
+    TNVME_PROBE3(frmwk_ex, filename.c_str(), lineNum, mMsg.c_str());
     DumpStateOfTheSystem();
 }
 
@@ -58,6 +61,7 @@ FrmwkEx::FrmwkEx(string filename, int lineNum, const char *fmt, ...)
     mMsg = work;
     LOG_ERR("Exception: %s:#%d: FAILURE: %s", filename.c_str(), lineNum,
         mMsg.c_str());
+    TNVME_PROBE3(frmwk_ex, filename.c_str(), lineNum, mMsg.c_str());
     DumpStateOfTheSystem();
 }
 
@@ -82,6 +82,16 @@ FIDIRQVec_r10b::operator=(const FIDIRQVec_r10b &other)
 }
 
 
+void
+FIDIRQVec_r10b::Reset()
+{
+    // The cmds are test lifetime objs, release them for the next run
+    getFeaturesCmd.reset();
+    setFeaturesCmd.reset();
+    Test::Reset();
+}
+
+
 Test::RunType
 FIDIRQVec_r10b::RunnableCoreTest(bool preserve)
 {
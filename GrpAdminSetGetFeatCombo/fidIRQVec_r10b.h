@@ -46,6 +46,7 @@ public:
         { return new FIDIRQVec_r10b(*this); }
     FIDIRQVec_r10b &operator=(const FIDIRQVec_r10b &other);
     FIDIRQVec_r10b(const FIDIRQVec_r10b &other);
+    virtual void Reset();
 
 
 protected:
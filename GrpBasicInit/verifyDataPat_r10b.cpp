@@ -22,6 +22,7 @@
 #include "writeDataPat_r10b.h"
 #include "../Utils/kernelAPI.h"
 #include "../Utils/io.h"
+#include "../Queues/writeShadow.h"
 
 namespace GrpBasicInit {
 
@@ -38,9 +39,9 @@ VerifyDataPat_r10b::VerifyDataPat_r10b(
         "Search for 1 of the following namspcs to run test. Find 1st bare "
         "namspc, or find 1st meta namspc, or find 1st E2E namspc. Issue an "
         "NVM cmd set read command with approp meta/E2E requirements if "
-        "necessary and compare the data payload with a previously written "
-        "and well known data pattern to the same namespace id. The "
-        "read command shall be completely generic.");
+        "necessary and verify the data payload against the LBA tagged "
+        "data pattern the write shadow recorded for the same namespace "
+        "id. The read command shall be completely generic.");
 }
 
 
@@ -119,8 +120,17 @@ VerifyDataPat_r10b::VerifyDataPattern()
     uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
     LBAFormat lbaFormat = namspcData.idCmdNamspc->GetLBAFormat();
 
-    LOG_NRM("Create data pattern to compare against");
-    SharedMemBufferPtr dataPat = SharedMemBufferPtr(new MemBuffer());
+    LOG_NRM("Lookup the data pattern last written to LBA's 0 thru %d",
+        (WRITE_DATA_PAT_NUM_BLKS - 1));
+    LbaPatKey key;
+    uint64_t runLen;
+    key.nsid = namspcData.id;
+    if ((WriteShadow::Lookup(namspcData.id, 0, key.seed, key.generation,
+        runLen) == false) || (runLen < WRITE_DATA_PAT_NUM_BLKS)) {
+        throw FrmwkEx(HERE, "Write shadow of namspc #%d doesn't know the "
+            "content of LBA's 0 thru %d", namspcData.id,
+            (WRITE_DATA_PAT_NUM_BLKS - 1));
+    }
 
     LOG_NRM("Create memory to contain read payload");
     SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
@@ -130,16 +140,13 @@ VerifyDataPat_r10b::VerifyDataPattern()
 
     switch (namspcData.type) {
     case Informative::NS_BARE:
-        dataPat->Init(WRITE_DATA_PAT_NUM_BLKS * lbaDataSize);
         readMem->Init(WRITE_DATA_PAT_NUM_BLKS * lbaDataSize);
         break;
     case Informative::NS_METAS:
-        dataPat->Init(WRITE_DATA_PAT_NUM_BLKS * lbaDataSize);
         readMem->Init(WRITE_DATA_PAT_NUM_BLKS * lbaDataSize);
         readCmd->AllocMetaBuffer();
         break;
     case Informative::NS_METAI:
-        dataPat->Init(WRITE_DATA_PAT_NUM_BLKS * (lbaDataSize + lbaFormat.MS));
         readMem->Init(WRITE_DATA_PAT_NUM_BLKS * (lbaDataSize + lbaFormat.MS));
         break;
     case Informative::NS_E2ES:
@@ -148,9 +155,8 @@ VerifyDataPat_r10b::VerifyDataPattern()
         break;
     }
 
-    dataPat->SetDataPattern(DATAPAT_INC_16BIT);
-    dataPat->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName, "DataPat"),
-        "Verify buffer's data pattern");
+    uint32_t stride = (namspcData.type == Informative::NS_METAI) ?
+        (lbaDataSize + lbaFormat.MS) : lbaDataSize;
 
     send_64b_bitmask prpBitmask = (send_64b_bitmask)
         (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
@@ -169,7 +175,8 @@ VerifyDataPat_r10b::VerifyDataPattern()
         gRsrcMngr->GetObj(IOCQ_DISCONTIG_GROUP_ID))
 
     LOG_NRM("Send the cmd to hdw via the contiguous IOQ's");
-    SendToIOSQ(iosqContig, iocqContig, readCmd, "contig", dataPat, readMem);
+    SendToIOSQ(iosqContig, iocqContig, readCmd, "contig", key, lbaDataSize,
+        stride, readMem);
 
     // To run the discontig part of this test, the hdw must support that feature
     if (gRegisters->Read(CTLSPC_CAP, regVal) == false) {
@@ -180,27 +187,25 @@ VerifyDataPat_r10b::VerifyDataPattern()
     }
 
     LOG_NRM("Send the cmd to hdw via the discontiguous IOQ's");
-    SendToIOSQ(iosqDiscontig, iocqDiscontig, readCmd, "discontig", dataPat,
-        readMem);
+    SendToIOSQ(iosqDiscontig, iocqDiscontig, readCmd, "discontig", key,
+        lbaDataSize, stride, readMem);
 }
 
 
 void
 VerifyDataPat_r10b::SendToIOSQ(SharedIOSQPtr iosq, SharedIOCQPtr iocq,
-    SharedReadPtr readCmd, string qualifier, SharedMemBufferPtr writtenPayload,
-    SharedMemBufferPtr readPayload)
+    SharedReadPtr readCmd, string qualifier, const LbaPatKey &key,
+    uint32_t lbaDataSize, uint32_t stride, SharedMemBufferPtr readPayload)
 {
     IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq, iocq,
         readCmd, qualifier, true);
 
-    LOG_NRM("Compare read vs written data to verify");
-    if (readPayload->Compare(writtenPayload) == false) {
+    LOG_NRM("Verify read data against the write shadow");
+    if (LbaPattern::Verify(readPayload, key, 0, WRITE_DATA_PAT_NUM_BLKS,
+        lbaDataSize, stride) == false) {
         readPayload->Dump(
             FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadPayload"),
             "Data read from media miscompared from written");
-        writtenPayload->Dump(
-            FileSystem::PrepDumpFile(mGrpName, mTestName, "WrittenPayload"),
-            "Data read from media miscompared from written");
         throw FrmwkEx(HERE, "Data miscompare");
     }
 }
@@ -21,6 +21,7 @@
 #include "../Queues/iocq.h"
 #include "../Queues/iosq.h"
 #include "../Cmds/read.h"
+#include "../Utils/lbaPattern.h"
 
 namespace GrpBasicInit {
 
@@ -60,8 +61,8 @@ private:
     ///////////////////////////////////////////////////////////////////////////
     void VerifyDataPattern();
     void SendToIOSQ(SharedIOSQPtr iosq, SharedIOCQPtr iocq,
-        SharedReadPtr readCmd, string qualifier,
-        SharedMemBufferPtr writtenPayload, SharedMemBufferPtr readPayload);
+        SharedReadPtr readCmd, string qualifier, const LbaPatKey &key,
+        uint32_t lbaDataSize, uint32_t stride, SharedMemBufferPtr readPayload);
 };
 
 }   // namespace
@@ -20,6 +20,8 @@
 #include "createIOQDiscontigPoll_r10b.h"
 #include "grpDefs.h"
 #include "../Utils/kernelAPI.h"
+#include "../Utils/lbaPattern.h"
+#include "../Utils/io.h"
 #include "../Queues/ce.h"
 
 namespace GrpBasicInit {
@@ -38,9 +40,9 @@ WriteDataPat_r10b::WriteDataPat_r10b(
         "namspc, or find 1st meta namspc, or find 1st E2E namspc. Issue "
         "identical write cmd to the selected namspc starting at LBA 0, "
         "sending a single block with approp meta/E2E requirements if "
-        "necessary. Issue an NVM cmd set write command with a well known "
-        "data pattern to namespace found. The write command shall be "
-        "completely generic.");
+        "necessary. Issue an NVM cmd set write command with an LBA tagged "
+        "data pattern to namespace found, recording it in the write "
+        "shadow. The write command shall be completely generic.");
 }
 
 
@@ -153,7 +155,11 @@ WriteDataPat_r10b::WriteDataPattern()
         break;
     }
 
-    dataPat->SetDataPattern(DATAPAT_INC_16BIT);
+    LbaPatKey key = LbaPattern::NewKey(namspcData.id);
+    uint32_t stride = (namspcData.type == Informative::NS_METAI) ?
+        (lbaDataSize + lbaFormat.MS) : lbaDataSize;
+    LbaPattern::Fill(dataPat, key, 0, WRITE_DATA_PAT_NUM_BLKS, lbaDataSize,
+        stride);
     dataPat->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName, "DataPat"),
         "Write buffer's data pattern");
 
@@ -241,6 +247,9 @@ WriteDataPat_r10b::SendToIOSQ(SharedIOSQPtr iosq, SharedIOCQPtr iocq,
 
     union CE ce = iocq->PeekCE(iocqMetrics.head_ptr);
     ProcessCE::Validate(ce);  // throws upon error
+
+    // Remember the LbaPattern just written for VerifyDataPat_r10b
+    IO::ShadowCompleted(mGrpName, mTestName, iosq, writeCmd, qualifier);
 }
 
 }   // namespace
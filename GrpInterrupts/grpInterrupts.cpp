@@ -21,6 +21,7 @@
 #include "partialReapMSIX_r10b.h"
 #include "maxIOQMSIX1To1_r10b.h"
 #include "maxIOQMSIXManyTo1_r10b.h"
+#include "intCoalescingSweep_r10b.h"
 
 namespace GrpInterrupts {
 
@@ -42,6 +43,7 @@ GrpInterrupts::GrpInterrupts(size_t grpNum) :
         APPEND_TEST_AT_YLEVEL(PartialReapMSIX_r10b, GrpInterrupts)
         APPEND_TEST_AT_YLEVEL(MaxIOQMSIX1To1_r10b, GrpInterrupts)
         APPEND_TEST_AT_YLEVEL(MaxIOQMSIXManyTo1_r10b, GrpInterrupts)
+        APPEND_TEST_AT_YLEVEL(IntCoalescingSweep_r10b, GrpInterrupts)
         break;
 
     default:
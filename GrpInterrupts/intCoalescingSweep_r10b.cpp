@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <boost/format.hpp>
+#include "intCoalescingSweep_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Utils/io.h"
+#include "../Cmds/featureDefs.h"
+#include "../Cmds/getFeatures.h"
+#include "../Cmds/setFeatures.h"
+
+#define MAX_SWEEP_IOQS              4
+#define MAX_QUEUE_DEPTH             32
+#define NUM_CMDS_PER_POINT          512
+
+// Aggregation thresholds are 0-based CE counts, aggregation times are in
+// 100us units; thresholds the queue depth could never reach are skipped.
+static const uint8_t SWEEP_THR[]  = { 0, 3, 7, 15 };
+static const uint8_t SWEEP_TIME[] = { 0, 1, 4, 10 };
+#define NUM_SWEEP_THR               (sizeof(SWEEP_THR) / sizeof(uint8_t))
+#define NUM_SWEEP_TIME              (sizeof(SWEEP_TIME) / sizeof(uint8_t))
+
+
+namespace GrpInterrupts {
+
+
+IntCoalescingSweep_r10b::IntCoalescingSweep_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 5.12.1.8, 5.12.1.9");
+    mTestDesc.SetShort(     "Characterize IRQ coalescing THR/TIME across MSI-X vectors");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "Only allowed to execute test if the DUT supports MSI-X IRQ's by "
+        "reporting the MSIXCAP PCI structures. Search for 1 of the following "
+        "namspcs to run test. Find 1st bare namspc, or find 1st meta namspc, "
+        "or find 1st E2E namspc. Determine X, where X is the lesser of "
+        "MSIXCAP.MXC.TS, the max number of IOQ's the DUT supports, or 4. "
+        "Create X IOSQ:IOCQ pairs, each IOCQ using its own IRQ vector "
+        "starting at vector 1 so the ACQ's vector 0 is never coalesced. Save "
+        "the Interrupt Coalescing and Interrupt Vector Configuration "
+        "features. For each aggregation threshold in {0, 3, 7, 15} and each "
+        "aggregation time in {0, 1, 4, 10} (100us units) issue Set Features "
+        "to program the setting and clear CD for each vector in use, then "
+        "keep QD read cmds of 1 block at LBA 0 outstanding on every IOQ "
+        "pair until 512 cmds complete per pair. Report the IRQ's per cmd "
+        "reported by the ISR count, the completion latency and the "
+        "throughput for every setting and vector. The original feature "
+        "values are restored at completion. This test only characterizes "
+        "the DUT, other than failing cmds it has no pass/fail criteria.");
+}
+
+
+IntCoalescingSweep_r10b::~IntCoalescingSweep_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+IntCoalescingSweep_r10b::
+IntCoalescingSweep_r10b(const IntCoalescingSweep_r10b &other) : Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+IntCoalescingSweep_r10b &
+IntCoalescingSweep_r10b::operator=(const IntCoalescingSweep_r10b &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+IntCoalescingSweep_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    preserve = preserve;    // Suppress compiler error/warning
+    return RUN_TRUE;        // This test is never destructive
+}
+
+
+void
+IntCoalescingSweep_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * 1) Test CreateResources_r10b has run prior.
+     * \endverbatim
+     */
+    bool capable;
+    uint64_t reg;
+    uint16_t numIrqSupport;
+
+    LOG_NRM("Only allowed to execute if DUT supports MSI-X IRQ's");
+    if (gCtrlrConfig->IsMSIXCapable(capable, numIrqSupport) == false)
+        throw FrmwkEx(HERE);
+    else if (capable == false) {
+        LOG_NRM("DUT does not support MSI-X IRQ's; unable to execute test");
+        return;
+    }
+
+    // Vector 0 is reserved for the ACQ, thus at least 2 vectors are needed
+    uint16_t X = MIN(numIrqSupport, MIN((gInformative->GetFeaturesNumOfIOSQs()
+        + 1), (gInformative->GetFeaturesNumOfIOCQs() + 1)));
+    X = MIN(X, (MAX_SWEEP_IOQS + 1));
+    if (X < 2) {
+        LOG_WARN("Need >= 2 MSI-X vectors and 1 IOQ pair; unable to execute");
+        return;
+    }
+
+    if (gRegisters->Read(CTLSPC_CAP, reg) == false)
+        throw FrmwkEx(HERE, "Unable to determine CAP.MQES");
+    uint32_t qDepth = MIN((uint32_t)(reg & CAP_MQES), MAX_QUEUE_DEPTH);
+    if (qDepth == 0)
+        throw FrmwkEx(HERE, "CAP.MQES reports illegal value of 0");
+
+    LOG_NRM("Setting MSI-X with #%d irq vectors", X);
+    if (gCtrlrConfig->SetState(ST_DISABLE) == false)
+        throw FrmwkEx(HERE);
+    if (gCtrlrConfig->SetIrqScheme(INT_MSIX, X) == false)
+        throw FrmwkEx(HERE, "Unable to set MSI-X scheme with num irqs #%d", X);
+    gCtrlrConfig->SetCSS(CtrlrConfig::CSS_NVM_CMDSET);
+    if (gCtrlrConfig->SetState(ST_ENABLE) == false)
+        throw FrmwkEx(HERE);
+
+    LOG_NRM("Lookup objs which were created in a prior test within group");
+    SharedASQPtr asq = CAST_TO_ASQ(gRsrcMngr->GetObj(ASQ_GROUP_ID))
+    SharedACQPtr acq = CAST_TO_ACQ(gRsrcMngr->GetObj(ACQ_GROUP_ID))
+
+    gCtrlrConfig->SetIOCQES((gInformative->GetIdentifyCmdCtrlr()->
+        GetValue(IDCTRLRCAP_CQES) & 0xf));
+    gCtrlrConfig->SetIOSQES((gInformative->GetIdentifyCmdCtrlr()->
+        GetValue(IDCTRLRCAP_SQES) & 0xf));
+
+    LOG_NRM("Create %d IOQ pairs, IOCQ #n uses IRQ vector #n", (X - 1));
+    vector<SharedIOSQPtr> iosqs;
+    vector<SharedIOCQPtr> iocqs;
+    vector<vector<SharedCmdPtr> > cmds;
+    for (uint16_t ioqId = 1; ioqId < X; ioqId++) {
+        iocqs.push_back(Queues::CreateIOCQContigToHdw(mGrpName, mTestName,
+            CALC_TIMEOUT_ms(1), asq, acq, ioqId, (qDepth + 1), false, "",
+            true, ioqId));
+        iosqs.push_back(Queues::CreateIOSQContigToHdw(mGrpName, mTestName,
+            CALC_TIMEOUT_ms(1), asq, acq, ioqId, (qDepth + 1), false, "",
+            ioqId, 0));
+        cmds.push_back(Workload::CreateReadCmds(qDepth));
+    }
+
+    LOG_NRM("Save the features which are about to be modified");
+    uint32_t origCoalescing = GetFeature(asq, acq, FID[FID_IRQ_COALESCING]);
+    vector<uint32_t> origIvConfig;
+    for (uint16_t iv = 1; iv < X; iv++) {
+        origIvConfig.push_back(
+            GetFeature(asq, acq, FID[FID_IRQ_VEC_CONFIG], iv));
+    }
+
+    FILE *fp = fopen(FileSystem::PrepDumpFile(mGrpName, mTestName,
+        "sweep", "csv").c_str(), "w");
+    if (fp == NULL)
+        throw FrmwkEx(HERE, "Unable to open file for the sweep results");
+    fprintf(fp, "thr,time_100us,vector,qdepth,cmds,irqs,irqs_per_cmd,"
+        "lat_min_us,lat_avg_us,lat_max_us,iops\n");
+
+    try {
+        for (size_t t = 0; t < NUM_SWEEP_THR; t++) {
+            if (SWEEP_THR[t] >= qDepth)
+                continue;   // the threshold could never be reached
+
+            for (size_t m = 0; m < NUM_SWEEP_TIME; m++) {
+                LOG_NRM("Program aggregation THR=%d, TIME=%d (100us)",
+                    SWEEP_THR[t], SWEEP_TIME[m]);
+                SetFeature(asq, acq, FID[FID_IRQ_COALESCING],
+                    ((uint32_t)SWEEP_TIME[m] << 8) | SWEEP_THR[t],
+                    str(boost::format("thr%d.time%d") % (int)SWEEP_THR[t] %
+                    (int)SWEEP_TIME[m]));
+                for (uint16_t iv = 1; iv < X; iv++) {
+                    // CD (bit 16) cleared enables coalescing for the vector
+                    SetFeature(asq, acq, FID[FID_IRQ_VEC_CONFIG], iv,
+                        str(boost::format("iv%d") % iv));
+                }
+
+                for (size_t i = 0; i < iosqs.size(); i++) {
+                    WorkloadStats stats;
+                    Workload::SustainQD(mGrpName, mTestName, iosqs[i],
+                        iocqs[i], cmds[i], NUM_CMDS_PER_POINT, stats);
+                    Workload::LogStats(str(boost::format(
+                        "THR=%d, TIME=%d, IV=%d") % (int)SWEEP_THR[t] %
+                        (int)SWEEP_TIME[m] % iocqs[i]->GetIrqVector()), stats);
+
+                    uint64_t numCmds = MAX(stats.numCmds, (uint64_t)1);
+                    fprintf(fp, "%d,%d,%d,%d,%llu,%d,%.3f,%llu,%llu,%llu,"
+                        "%llu\n", SWEEP_THR[t], SWEEP_TIME[m],
+                        iocqs[i]->GetIrqVector(), qDepth,
+                        (unsigned long long)stats.numCmds, stats.isrCount,
+                        (double)stats.isrCount / numCmds,
+                        (unsigned long long)stats.latMin_us,
+                        (unsigned long long)(stats.latSum_us / numCmds),
+                        (unsigned long long)stats.latMax_us,
+                        (unsigned long long)((stats.numCmds * 1000000) /
+                        MAX(stats.elapsed_us, (uint64_t)1)));
+                }
+            }
+        }
+    } catch (...) {
+        fclose(fp);
+        // Best effort, the failure of the sweep is what must be reported
+        try {
+            RestoreFeatures(asq, acq, origCoalescing, origIvConfig);
+        } catch (...) {
+            LOG_ERR("Unable to restore the modified features");
+        }
+        throw;
+    }
+    fclose(fp);
+    RestoreFeatures(asq, acq, origCoalescing, origIvConfig);
+}
+
+
+void
+IntCoalescingSweep_r10b::RestoreFeatures(SharedASQPtr asq, SharedACQPtr acq,
+    uint32_t coalescing, const vector<uint32_t> &ivConfig)
+{
+    LOG_NRM("Restore the features which were modified");
+    SetFeature(asq, acq, FID[FID_IRQ_COALESCING], coalescing, "restore");
+    for (uint16_t iv = 1; iv <= ivConfig.size(); iv++) {
+        SetFeature(asq, acq, FID[FID_IRQ_VEC_CONFIG], ivConfig[iv - 1],
+            str(boost::format("restore.iv%d") % iv));
+    }
+}
+
+
+uint32_t
+IntCoalescingSweep_r10b::GetFeature(SharedASQPtr asq, SharedACQPtr acq,
+    uint8_t fid, uint16_t iv)
+{
+    SharedGetFeaturesPtr getFeaturesCmd =
+        SharedGetFeaturesPtr(new GetFeatures());
+    getFeaturesCmd->SetFID(fid);
+    if (fid == FID[FID_IRQ_VEC_CONFIG])
+        getFeaturesCmd->SetIntVecConfigIV(iv);
+
+    struct nvme_gen_cq acqMetrics = acq->GetQMetrics();
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), asq, acq,
+        getFeaturesCmd, str(boost::format("get.fid%d.iv%d") % (int)fid % iv),
+        false);
+    union CE ce = acq->PeekCE(acqMetrics.head_ptr);
+    LOG_NRM("Get Features FID 0x%02X, IV %d = 0x%08X", fid, iv, ce.t.dw0);
+    return ce.t.dw0;
+}
+
+
+void
+IntCoalescingSweep_r10b::SetFeature(SharedASQPtr asq, SharedACQPtr acq,
+    uint8_t fid, uint32_t dw11, string qualify)
+{
+    SharedSetFeaturesPtr setFeaturesCmd =
+        SharedSetFeaturesPtr(new SetFeatures());
+    setFeaturesCmd->SetFID(fid);
+    setFeaturesCmd->SetDword(dw11, 11);
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), asq, acq,
+        setFeaturesCmd, qualify, false);
+}
+
+}   // namespace
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _INTCOALESCINGSWEEP_r10b_H_
+#define _INTCOALESCINGSWEEP_r10b_H_
+
+#include "test.h"
+#include "../Utils/queues.h"
+#include "../Utils/workload.h"
+
+namespace GrpInterrupts {
+
+
+/** \verbatim
+ * -----------------------------------------------------------------------------
+ * ----------------Mandatory rules for children to follow-----------------------
+ * -----------------------------------------------------------------------------
+ * 1) See notes in the header file of the Test base class
+ * \endverbatim
+ */
+class IntCoalescingSweep_r10b : public Test
+{
+public:
+    IntCoalescingSweep_r10b(string grpName, string testName);
+    virtual ~IntCoalescingSweep_r10b();
+
+    /**
+     * IMPORTANT: Read Test::Clone() header comment.
+     */
+    virtual IntCoalescingSweep_r10b *Clone() const
+        { return new IntCoalescingSweep_r10b(*this); }
+    IntCoalescingSweep_r10b &operator=(const IntCoalescingSweep_r10b &other);
+    IntCoalescingSweep_r10b(const IntCoalescingSweep_r10b &other);
+
+
+protected:
+    virtual void RunCoreTest();
+    virtual RunType RunnableCoreTest(bool preserve);
+
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Adding a member variable? Then edit the copy constructor and operator=().
+    ///////////////////////////////////////////////////////////////////////////
+    uint32_t GetFeature(SharedASQPtr asq, SharedACQPtr acq, uint8_t fid,
+        uint16_t iv = 0);
+    void SetFeature(SharedASQPtr asq, SharedACQPtr acq, uint8_t fid,
+        uint32_t dw11, string qualify);
+    void RestoreFeatures(SharedASQPtr asq, SharedACQPtr acq,
+        uint32_t coalescing, const vector<uint32_t> &ivConfig);
+};
+
+}   // namespace
+
+#endif
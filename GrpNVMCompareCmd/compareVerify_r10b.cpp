@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "compareVerify_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Queues/iocq.h"
+#include "../Queues/iosq.h"
+#include "../Utils/io.h"
+#include "../Utils/lbaPattern.h"
+#include "../Utils/verifyEngine.h"
+
+
+namespace GrpNVMCompareCmd {
+
+#define NUM_BLKS                8
+#define BLKS_PER_CMD            4
+
+
+CompareVerify_r10b::CompareVerify_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 6.6");
+    mTestDesc.SetShort(     "Verify written data with the compare cmd");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "Find 1st bare namspc. Issue a write cmd of an LBA tagged data "
+        "pattern to LBA's 0 thru 7. Verify the LBA's by issuing compare "
+        "cmds of 4 blocks each containing the regenerated data pattern, "
+        "expect success. Issue a compare cmd for all 8 LBA's whose "
+        "payload differs from media by 1 byte in the last block, expect "
+        "status Compare Failure.");
+}
+
+
+CompareVerify_r10b::~CompareVerify_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+CompareVerify_r10b::
+CompareVerify_r10b(const CompareVerify_r10b &other) : Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+CompareVerify_r10b &
+CompareVerify_r10b::operator=(const CompareVerify_r10b &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+CompareVerify_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (VerifyEngine::CompareSupported() == false)
+        return RUN_FALSE;
+
+    return ((preserve == true) ? RUN_FALSE : RUN_TRUE);   // Test is destructive
+}
+
+
+void
+CompareVerify_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * 1) Test CreateResources_r10b has run prior.
+     * \endverbatim
+     */
+
+    // Lookup objs which were created in a prior test within group
+    SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
+    SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
+
+    vector<uint32_t> bare = gInformative->GetBareNamespaces();
+    if (bare.size() == 0) {
+        LOG_NRM("No bare namspc exists, compare of meta data is untested");
+        return;
+    }
+    uint32_t nsid = bare[0];
+    uint64_t lbaDataSize =
+        gInformative->GetIdentifyCmdNamspc(nsid)->GetLBADataSize();
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)(MASK_PRP1_PAGE
+        | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+
+    LOG_NRM("Write an LBA tagged data pattern to namspc #%d", nsid);
+    LbaPatKey key = LbaPattern::NewKey(nsid);
+    SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
+    writeMem->Init(NUM_BLKS * lbaDataSize);
+    LbaPattern::Fill(writeMem, key, 0, NUM_BLKS, lbaDataSize);
+
+    SharedWritePtr writeCmd = SharedWritePtr(new Write());
+    writeCmd->SetPrpBuffer(prpBitmask, writeMem);
+    writeCmd->SetNSID(nsid);
+    writeCmd->SetNLB(NUM_BLKS - 1);
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq, iocq,
+        writeCmd, "write", true);
+
+    LOG_NRM("Verify the written LBA's using compare cmds");
+    uint64_t numVerified = VerifyEngine::VerifyRange(mGrpName, mTestName,
+        iosq, iocq, nsid, 0, NUM_BLKS, BLKS_PER_CMD);
+    if (numVerified != NUM_BLKS) {
+        throw FrmwkEx(HERE, "Verified %lld of %d LBA's written",
+            (long long)numVerified, NUM_BLKS);
+    }
+
+    LOG_NRM("Compare a payload differing by 1 byte, expect a failure");
+    writeMem->GetBuffer()[(NUM_BLKS * lbaDataSize) - 1] ^= 0xff;
+    SharedComparePtr cmpCmd = SharedComparePtr(new Compare());
+    cmpCmd->SetPrpBuffer(prpBitmask, writeMem);
+    cmpCmd->SetNSID(nsid);
+    cmpCmd->SetNLB(NUM_BLKS - 1);
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq, iocq,
+        cmpCmd, "miscompare", true, CESTAT_COMPARE_FAIL);
+}
+
+}   // namespace
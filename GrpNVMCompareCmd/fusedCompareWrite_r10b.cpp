@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "fusedCompareWrite_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Queues/iocq.h"
+#include "../Queues/iosq.h"
+#include "../Utils/io.h"
+#include "../Utils/lbaPattern.h"
+#include "../Utils/verifyEngine.h"
+
+
+namespace GrpNVMCompareCmd {
+
+#define NUM_BLKS                2
+
+
+FusedCompareWrite_r10b::FusedCompareWrite_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 4.2, 6.6");
+    mTestDesc.SetShort(     "Issue fused compare and write cmds");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "Find 1st bare namspc. Issue a write cmd of an LBA tagged data "
+        "pattern, generation A, to LBA's 0 and 1. Issue a fused compare of "
+        "generation A and write of generation B to the same LBA's, expect "
+        "both to succeed and verify generation B is on media. Issue a fused "
+        "compare of generation A and write of generation C, expect status "
+        "Compare Failure for the compare and Cmd Aborted due to Failed "
+        "Fused Cmd for the write; verify generation B remains on media.");
+}
+
+
+FusedCompareWrite_r10b::~FusedCompareWrite_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+FusedCompareWrite_r10b::
+FusedCompareWrite_r10b(const FusedCompareWrite_r10b &other) : Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+FusedCompareWrite_r10b &
+FusedCompareWrite_r10b::operator=(const FusedCompareWrite_r10b &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+FusedCompareWrite_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (VerifyEngine::FusedCompareWriteSupported() == false)
+        return RUN_FALSE;
+
+    return ((preserve == true) ? RUN_FALSE : RUN_TRUE);   // Test is destructive
+}
+
+
+void
+FusedCompareWrite_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * 1) Test CreateResources_r10b has run prior.
+     * \endverbatim
+     */
+
+    // Lookup objs which were created in a prior test within group
+    SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
+    SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
+
+    vector<uint32_t> bare = gInformative->GetBareNamespaces();
+    if (bare.size() == 0) {
+        LOG_NRM("No bare namspc exists, compare of meta data is untested");
+        return;
+    }
+    uint32_t nsid = bare[0];
+    uint64_t lbaDataSize =
+        gInformative->GetIdentifyCmdNamspc(nsid)->GetLBADataSize();
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)(MASK_PRP1_PAGE
+        | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+
+    LbaPatKey key[3];
+    SharedMemBufferPtr payload[3];
+    for (int i = 0; i < 3; i++) {
+        key[i] = LbaPattern::NewKey(nsid);
+        payload[i] = SharedMemBufferPtr(new MemBuffer());
+        payload[i]->Init(NUM_BLKS * lbaDataSize);
+        LbaPattern::Fill(payload[i], key[i], 0, NUM_BLKS, lbaDataSize);
+    }
+
+    LOG_NRM("Write generation A to namspc #%d", nsid);
+    SharedWritePtr writeCmd = SharedWritePtr(new Write());
+    writeCmd->SetPrpBuffer(prpBitmask, payload[0]);
+    writeCmd->SetNSID(nsid);
+    writeCmd->SetNLB(NUM_BLKS - 1);
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq, iocq,
+        writeCmd, "genA", true);
+
+    LOG_NRM("Fused compare generation A and write generation B");
+    SharedComparePtr cmpCmd = SharedComparePtr(new Compare());
+    cmpCmd->SetPrpBuffer(prpBitmask, payload[0]);
+    cmpCmd->SetNSID(nsid);
+    cmpCmd->SetNLB(NUM_BLKS - 1);
+    writeCmd = SharedWritePtr(new Write());
+    writeCmd->SetPrpBuffer(prpBitmask, payload[1]);
+    writeCmd->SetNSID(nsid);
+    writeCmd->SetNLB(NUM_BLKS - 1);
+    if (VerifyEngine::CompareAndWrite(mGrpName, mTestName, CALC_TIMEOUT_ms(2),
+        iosq, iocq, cmpCmd, writeCmd, "genB") != CESTAT_SUCCESS) {
+        throw FrmwkEx(HERE, "Compare of the media's content failed");
+    }
+    VerifyNumLBA(VerifyEngine::VerifyRange(mGrpName, mTestName, iosq, iocq,
+        nsid, 0, NUM_BLKS, NUM_BLKS));
+
+    LOG_NRM("Fused compare stale generation A and write generation C");
+    writeCmd = SharedWritePtr(new Write());
+    writeCmd->SetPrpBuffer(prpBitmask, payload[2]);
+    writeCmd->SetNSID(nsid);
+    writeCmd->SetNLB(NUM_BLKS - 1);
+    if (VerifyEngine::CompareAndWrite(mGrpName, mTestName, CALC_TIMEOUT_ms(2),
+        iosq, iocq, cmpCmd, writeCmd, "genC") != CESTAT_COMPARE_FAIL) {
+        throw FrmwkEx(HERE, "Compare of stale content succeeded");
+    }
+    VerifyNumLBA(VerifyEngine::VerifyRange(mGrpName, mTestName, iosq, iocq,
+        nsid, 0, NUM_BLKS, NUM_BLKS));
+}
+
+
+void
+FusedCompareWrite_r10b::VerifyNumLBA(uint64_t numVerified)
+{
+    if (numVerified != NUM_BLKS) {
+        throw FrmwkEx(HERE, "Verified %lld of %d LBA's written",
+            (long long)numVerified, NUM_BLKS);
+    }
+}
+
+}   // namespace
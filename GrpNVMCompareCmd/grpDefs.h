@@ -23,6 +23,9 @@ namespace GrpNVMCompareCmd {
 
 #define ACQ_GROUP_ID                "ACQ"
 #define ASQ_GROUP_ID                "ASQ"
+#define IOCQ_GROUP_ID               "IOCQ"
+#define IOSQ_GROUP_ID               "IOSQ"
+#define IOQ_ID                      1
 
 
 }   // namespace
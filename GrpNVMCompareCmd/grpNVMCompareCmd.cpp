@@ -17,6 +17,9 @@
 #include "tnvme.h"
 #include "../Exception/frmwkEx.h"
 #include "grpNVMCompareCmd.h"
+#include "createResources_r10b.h"
+#include "compareVerify_r10b.h"
+#include "fusedCompareWrite_r10b.h"
 
 namespace GrpNVMCompareCmd {
 
@@ -33,6 +36,9 @@ GrpNVMCompareCmd::GrpNVMCompareCmd(size_t grpNum) :
     case SPECREV_12:
     case SPECREV_121:
     case SPECREV_13:
+        APPEND_TEST_AT_XLEVEL(CreateResources_r10b, GrpNVMCompareCmd)
+        APPEND_TEST_AT_YLEVEL(CompareVerify_r10b, GrpNVMCompareCmd)
+        APPEND_TEST_AT_YLEVEL(FusedCompareWrite_r10b, GrpNVMCompareCmd)
         break;
 
     default:
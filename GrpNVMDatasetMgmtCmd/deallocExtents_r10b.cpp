@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <boost/format.hpp>
+#include "deallocExtents_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Queues/iocq.h"
+#include "../Queues/iosq.h"
+#include "../Utils/dsmEngine.h"
+#include "../Utils/queues.h"
+#include "../Utils/io.h"
+
+#define NUM_EXTENTS                 1024
+#define MAX_EXTENT_NLB              256
+#define EXTENT_SEED                 0x5eed
+#define MAX_DSM_IOSQS               4
+#define MAX_DSM_IOQ_ENTRIES         64
+
+
+namespace GrpNVMDatasetMgmtCmd {
+
+
+DeallocExtents_r10b::DeallocExtents_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 6.6");
+    mTestDesc.SetShort(     "Deallocate random extents then the entire namspc");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "Search for 1 of the following namspcs to run test. Find 1st bare "
+        "namspc, or find 1st meta namspc, or find 1st E2E namspc. "
+        "1) Generate a repeatable set of 1024 random extents, each at most "
+        "256 LBA's, coalesce them and pack them into the fewest dataset "
+        "mgmt cmds with the AD attribute set, issuing them pipelined across "
+        "up to 4 IOSQ's sharing 1 IOCQ, or across the group's IOQ's when the "
+        "DUT doesn't support that many. "
+        "2) Report the cmds, ranges and LBA's deallocated per second. "
+        "3) When Identify.DLFEAT defines the value read from deallocated "
+        "LBA's, read up to 16 LBA's spread across every extent, logging any "
+        "mismatch since the AD attribute is advisory. "
+        "4) Repeat 2) and 3) after deallocating every LBA in the namspc, "
+        "then a mismatch is an error when Identify.NSFEAT reports thin "
+        "provisioning and Identify.NUSE reports 0 LBA's allocated.");
+}
+
+
+DeallocExtents_r10b::~DeallocExtents_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+DeallocExtents_r10b::
+DeallocExtents_r10b(const DeallocExtents_r10b &other) : Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+DeallocExtents_r10b &
+DeallocExtents_r10b::operator=(const DeallocExtents_r10b &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+DeallocExtents_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    ConstSharedIdentifyPtr idCtrlrCap = gInformative->GetIdentifyCmdCtrlr();
+    uint64_t oncs = idCtrlrCap->GetValue(IDCTRLRCAP_ONCS);
+    if ((oncs & ONCS_SUP_DSM_CMD) == 0)
+        return RUN_FALSE;
+
+    return ((preserve == true) ? RUN_FALSE : RUN_TRUE);   // Test is destructive
+}
+
+
+void
+DeallocExtents_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * 1) Test CreateResources_r10b has run prior.
+     * \endverbatim
+     */
+    DsmStats stats;
+
+    LOG_NRM("Lookup Q'S which were created in a prior test within group");
+    SharedASQPtr asq = CAST_TO_ASQ(gRsrcMngr->GetObj(ASQ_GROUP_ID))
+    SharedACQPtr acq = CAST_TO_ACQ(gRsrcMngr->GetObj(ACQ_GROUP_ID))
+    SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
+    SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
+
+    // The group's IOQ's hold a single outstanding cmd, pipelining requires
+    // a deeper IOCQ with several IOSQ's completing into it.
+    std::vector<SharedIOSQPtr> dsmSQs;
+    SharedIOCQPtr dsmCQ = iocq;
+    CreateIOQs(asq, acq, dsmCQ, dsmSQs);
+    std::vector<SharedSQPtr> sqs;
+    if (dsmSQs.empty()) {
+        sqs.push_back(iosq);
+    } else {
+        for (size_t i = 0; i < dsmSQs.size(); i++)
+            sqs.push_back(dsmSQs[i]);
+    }
+
+    LOG_NRM("Search for 1st bare/meta or e2e namespace.");
+    Informative::Namspc namspcData = gInformative->Get1stBareMetaE2E();
+    uint64_t nsze = namspcData.idCmdNamspc->GetValue(IDNAMESPC_NSZE);
+
+    LOG_NRM("Deallocate %d random extents within namespace ID #%d",
+        NUM_EXTENTS, namspcData.id);
+    std::vector<DsmExtent> extents = DsmEngine::RandomExtents(nsze,
+        NUM_EXTENTS, MAX_EXTENT_NLB, EXTENT_SEED);
+    std::vector<SharedDatasetMgmtPtr> cmds =
+        DsmEngine::BuildCmds(namspcData.id, extents, true);
+    DsmEngine::Issue(mGrpName, mTestName, sqs, dsmCQ, cmds, stats);
+    DsmEngine::LogDsmStats(stats);
+    LOG_NRM("Verified %lld deallocated LBA's of the random extents",
+        (long long)DsmEngine::VerifyDeallocated(mGrpName, mTestName, iosq,
+        iocq, namspcData.id, extents, false));
+
+    LOG_NRM("Deallocate every LBA in namespace ID #%d", namspcData.id);
+    DsmEngine::DeallocateNamspc(mGrpName, mTestName, sqs, dsmCQ,
+        namspcData.id, stats);
+    DsmEngine::LogDsmStats(stats);
+    bool claimed = ClaimsDeallocated(asq, acq, namspcData.id);
+    std::vector<DsmExtent> all(1);
+    all[0].slba = 0;
+    all[0].nlb = nsze;
+    LOG_NRM("Verified %lld deallocated LBA's of the entire namspc",
+        (long long)DsmEngine::VerifyDeallocated(mGrpName, mTestName, iosq,
+        iocq, namspcData.id, all, claimed));
+
+    for (size_t i = 0; i < dsmSQs.size(); i++) {
+        Queues::DeleteIOSQToHdw(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
+            dsmSQs[i], asq, acq);
+    }
+    if (dsmSQs.empty() == false) {
+        Queues::DeleteIOCQToHdw(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
+            dsmCQ, asq, acq);
+    }
+}
+
+
+void
+DeallocExtents_r10b::CreateIOQs(SharedASQPtr asq, SharedACQPtr acq,
+    SharedIOCQPtr &iocq, std::vector<SharedIOSQPtr> &iosqs)
+{
+    uint32_t numSQs = gInformative->GetFeaturesNumOfIOSQs();
+    uint32_t numCQs = gInformative->GetFeaturesNumOfIOCQs();
+    if ((numSQs < 2) || (numCQs < 2)) {
+        LOG_NRM("DUT supports %d IOSQ's & %d IOCQ's; using the group's IOQ's",
+            numSQs, numCQs);
+        return;
+    }
+    numSQs = MIN(numSQs - 1, MAX_DSM_IOSQS);
+
+    uint64_t ctrlCapReg;
+    if (gRegisters->Read(CTLSPC_CAP, ctrlCapReg) == false)
+        throw FrmwkEx(HERE, "Unable to determine MQES");
+    uint32_t numEntries = (uint32_t)(ctrlCapReg & CAP_MQES) + 1;
+    numEntries = MIN(numEntries, MAX_DSM_IOQ_ENTRIES);
+
+    uint16_t qId = IOQ_ID + 1;
+    LOG_NRM("Create IOCQ with QID = %d and %d IOSQ's completing into it",
+        qId, numSQs);
+    iocq = Queues::CreateIOCQContigToHdw(mGrpName, mTestName,
+        CALC_TIMEOUT_ms(1), asq, acq, qId, numEntries, false, "", true, 0);
+    for (uint32_t i = 0; i < numSQs; i++) {
+        string qualify = str(boost::format("sq%d") % (qId + i));
+        iosqs.push_back(Queues::CreateIOSQContigToHdw(mGrpName, mTestName,
+            CALC_TIMEOUT_ms(1), asq, acq, qId + i, numEntries, false, "",
+            qId, 0, qualify));
+    }
+}
+
+
+bool
+DeallocExtents_r10b::ClaimsDeallocated(SharedASQPtr asq, SharedACQPtr acq,
+    uint32_t nsid)
+{
+    SharedIdentifyPtr idCmdNamSpc = SharedIdentifyPtr(new Identify());
+    idCmdNamSpc->SetCNS(CNS_Namespace);
+    idCmdNamSpc->SetNSID(nsid);
+    SharedMemBufferPtr idMemNamSpc = SharedMemBufferPtr(new MemBuffer());
+    idMemNamSpc->InitAlignment(Identify::IDEAL_DATA_SIZE, PRP_BUFFER_ALIGNMENT,
+        true, 0);
+    send_64b_bitmask idPrpNamSpc =
+        (send_64b_bitmask)(MASK_PRP1_PAGE | MASK_PRP2_PAGE);
+    idCmdNamSpc->SetPrpBuffer(idPrpNamSpc, idMemNamSpc);
+
+    string work = str(boost::format("IdentifyNamspc.nsid.%d.dealloc") % nsid);
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), asq, acq,
+        idCmdNamSpc, work, true);
+
+    uint64_t nuse = idCmdNamSpc->GetValue(IDNAMESPC_NUSE);
+    uint64_t nsfeat = idCmdNamSpc->GetValue(IDNAMESPC_NSFEAT);
+    if ((nsfeat & 0x1) && (nuse == 0)) {
+        LOG_NRM("Thin provisioned namspc reports NUSE = 0 after deallocation");
+        return true;
+    }
+    LOG_NRM("Namspc doesn't claim deallocation; NSFEAT = 0x%02llX, NUSE = "
+        "0x%016llX", (unsigned long long)nsfeat, (unsigned long long)nuse);
+    return false;
+}
+
+
+}   // namespace
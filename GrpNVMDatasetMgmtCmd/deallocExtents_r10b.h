@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _DEALLOCEXTENTS_r10b_H_
+#define _DEALLOCEXTENTS_r10b_H_
+
+#include "test.h"
+#include "../Queues/asq.h"
+#include "../Queues/acq.h"
+#include "../Queues/iocq.h"
+#include "../Queues/iosq.h"
+
+namespace GrpNVMDatasetMgmtCmd {
+
+
+/** \verbatim
+ * -----------------------------------------------------------------------------
+ * ----------------Mandatory rules for children to follow-----------------------
+ * -----------------------------------------------------------------------------
+ * 1) See notes in the header file of the Test base class
+ * \endverbatim
+ */
+class DeallocExtents_r10b : public Test
+{
+public:
+    DeallocExtents_r10b(string grpName, string testName);
+    virtual ~DeallocExtents_r10b();
+
+    /**
+     * IMPORTANT: Read Test::Clone() header comment.
+     */
+    virtual DeallocExtents_r10b *Clone() const
+        { return new DeallocExtents_r10b(*this); }
+    DeallocExtents_r10b &operator=(const DeallocExtents_r10b &other);
+    DeallocExtents_r10b(const DeallocExtents_r10b &other);
+
+
+protected:
+    virtual void RunCoreTest();
+    virtual RunType RunnableCoreTest(bool preserve);
+
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Adding a member variable? Then edit the copy constructor and operator=().
+    ///////////////////////////////////////////////////////////////////////////
+    /**
+     * Create a test lifetime IOCQ and up to MAX_DSM_IOSQS IOSQ's completing
+     * into it, all deep enough to keep DSM cmds pipelined.
+     * @param iocq Returns the IOCQ created, untouched when none are created
+     * @param iosqs Returns the IOSQ's created, empty when the DUT doesn't
+     *      support more than the group's IOQ's
+     */
+    void CreateIOQs(SharedASQPtr asq, SharedACQPtr acq, SharedIOCQPtr &iocq,
+        std::vector<SharedIOSQPtr> &iosqs);
+
+    /**
+     * Determine whether a namspc claims all its LBA's are deallocated, i.e.
+     * it is thin provisioned and Identify.NUSE reports 0.
+     */
+    bool ClaimsDeallocated(SharedASQPtr asq, SharedACQPtr acq, uint32_t nsid);
+};
+
+}   // namespace
+
+#endif
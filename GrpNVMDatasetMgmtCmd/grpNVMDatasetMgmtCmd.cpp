@@ -24,6 +24,7 @@
 #include "prp1PRP2NR_r10b.h"
 #include "attributes_r10b.h"
 #include "verifyNUSE_r10b.h"
+#include "deallocExtents_r10b.h"
 
 namespace GrpNVMDatasetMgmtCmd {
 
@@ -42,6 +43,7 @@ GrpNVMDatasetMgmtCmd::GrpNVMDatasetMgmtCmd(size_t grpNum) :
         APPEND_TEST_AT_YLEVEL(PRP1PRP2NR_r10b, GrpNVMDatasetMgmtCmd)
         APPEND_TEST_AT_YLEVEL(Attributes_r10b, GrpNVMDatasetMgmtCmd)
         APPEND_TEST_AT_YLEVEL(VerifyNUSE_r10b, GrpNVMDatasetMgmtCmd)
+        APPEND_TEST_AT_YLEVEL(DeallocExtents_r10b, GrpNVMDatasetMgmtCmd)
         break;
     case SPECREV_11:
         APPEND_TEST_AT_XLEVEL(CreateResources_r10b, GrpNVMDatasetMgmtCmd)
@@ -50,6 +52,7 @@ GrpNVMDatasetMgmtCmd::GrpNVMDatasetMgmtCmd(size_t grpNum) :
         APPEND_TEST_AT_YLEVEL(PRP1PRP2NR_r10b, GrpNVMDatasetMgmtCmd)
         APPEND_TEST_AT_YLEVEL(Attributes_r10b, GrpNVMDatasetMgmtCmd)
         APPEND_TEST_AT_YLEVEL(VerifyNUSE_r10b, GrpNVMDatasetMgmtCmd)
+        APPEND_TEST_AT_YLEVEL(DeallocExtents_r10b, GrpNVMDatasetMgmtCmd)
         break;
     case SPECREV_12:
     case SPECREV_121:
@@ -60,6 +63,7 @@ GrpNVMDatasetMgmtCmd::GrpNVMDatasetMgmtCmd(size_t grpNum) :
         APPEND_TEST_AT_YLEVEL(PRP1PRP2NR_r10b, GrpNVMDatasetMgmtCmd)
         APPEND_TEST_AT_YLEVEL(Attributes_r10b, GrpNVMDatasetMgmtCmd)
         APPEND_TEST_AT_YLEVEL(VerifyNUSE_r10b, GrpNVMDatasetMgmtCmd)
+        APPEND_TEST_AT_YLEVEL(DeallocExtents_r10b, GrpNVMDatasetMgmtCmd)
         break;
 
     default:
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include <boost/format.hpp>
+#include "e2eReadBack_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Utils/io.h"
+#include "../Utils/irq.h"
+
+// Num of LBA's written and read back per namspc, MDTS may reduce it
+#define E2E_NUM_LBA                 8
+#define E2E_APP_TAG                 0x5a3c
+
+
+namespace GrpNVMWriteReadCombo {
+
+
+E2EReadBack_r10b::E2EReadBack_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 8.2");
+    mTestDesc.SetShort(     "Read back and verify the protection info of E2E namspcs");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "For all E2E namspcs from Identify.NN; Write 8 LBA's ending at the "
+        "last LBA of NCAP, or fewer if Identify.MDTS requires, with data "
+        "pattern dword++. The host generates the protection info of each "
+        "LBA, guard CRC16-T10DIF, app tag and ref tag, and the write sets "
+        "DW12.PRINFO.PRCHK to all 1's with the tags in DW14/DW15. Read the "
+        "LBA's back twice, once with DW12.PRINFO.PRCHK = 0 and once with it "
+        "all 1's. Each time verify the guard, app tag and ref tag of every "
+        "LBA as read, and verify the data and meta data match what was "
+        "written.");
+}
+
+
+E2EReadBack_r10b::~E2EReadBack_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+E2EReadBack_r10b::
+E2EReadBack_r10b(const E2EReadBack_r10b &other) : Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+E2EReadBack_r10b &
+E2EReadBack_r10b::operator=(const E2EReadBack_r10b &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+E2EReadBack_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (gInformative->GetE2eNamespaces().size() == 0)
+        return RUN_FALSE;
+
+    return ((preserve == true) ? RUN_FALSE : RUN_TRUE);   // Test is destructive
+}
+
+
+void
+E2EReadBack_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * None.
+     * \endverbatim
+     */
+    string work;
+    SharedIOSQPtr iosq;
+    SharedIOCQPtr iocq;
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+
+    if (gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY) == false)
+        throw FrmwkEx(HERE);
+
+    LOG_NRM("Create admin queues ACQ and ASQ");
+    SharedACQPtr acq = SharedACQPtr(new ACQ(gDutFd));
+    acq->Init(5);
+
+    SharedASQPtr asq = SharedASQPtr(new ASQ(gDutFd));
+    asq->Init(5);
+
+    ConstSharedIdentifyPtr idCmdCtrlr = gInformative->GetIdentifyCmdCtrlr();
+    uint32_t maxDtXferSz = idCmdCtrlr->GetMaxDataXferSize();
+
+    vector<uint32_t> e2e = gInformative->GetE2eNamespaces();
+    for (size_t i = 0; i < e2e.size(); i++) {
+        LOG_NRM("Processing E2E namspc id #%d of %ld", e2e[i], e2e.size());
+
+        // The meta data alloc size may only be set again once disabled
+        if (gCtrlrConfig->SetState(ST_DISABLE) == false)
+            throw FrmwkEx(HERE);
+
+        IRQ::SetAnySchemeSpecifyNum(1);
+
+        gCtrlrConfig->SetCSS(CtrlrConfig::CSS_NVM_CMDSET);
+        if (gCtrlrConfig->SetState(ST_ENABLE) == false)
+            throw FrmwkEx(HERE);
+
+        LOG_NRM("Create IOSQ and IOCQ with ID #%d", IOQ_ID);
+        CreateIOQs(asq, acq, iosq, iocq);
+
+        ConstSharedIdentifyPtr namSpcPtr =
+            gInformative->GetIdentifyCmdNamspc(e2e[i]);
+        PILayout layout = ProtInfo::GetLayout(namSpcPtr);
+        uint64_t stride = layout.lbaDataSize +
+            (layout.interleaved ? layout.metaSize : 0);
+        uint64_t ncap = namSpcPtr->GetValue(IDNAMESPC_NCAP);
+        uint64_t numLBA = MIN((uint64_t)E2E_NUM_LBA, ncap);
+        if (maxDtXferSz != 0)
+            numLBA = MIN(numLBA, (maxDtXferSz / stride));
+        if (numLBA == 0) {
+            LOG_WARN("MDTS < 1 logical block; skipping namspc #%d", e2e[i]);
+            continue;
+        }
+        uint64_t slba = (ncap - numLBA);
+
+        SharedWritePtr writeCmd = SharedWritePtr(new Write());
+        SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
+        SharedReadPtr readCmd = SharedReadPtr(new Read());
+        SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
+
+        writeMem->Init(numLBA * stride);
+        writeMem->SetDataPattern(DATAPAT_INC_32BIT);
+        readMem->Init(numLBA * stride);
+        if (layout.interleaved == false) {
+            if (gRsrcMngr->SetMetaAllocSize(numLBA * layout.metaSize)
+                == false) {
+                throw FrmwkEx(HERE);
+            }
+            writeCmd->AllocMetaBuffer();
+            writeCmd->SetMetaDataPattern(DATAPAT_INC_32BIT);
+            readCmd->AllocMetaBuffer();
+        }
+
+        LOG_NRM("Generate PI for %lld LBA's starting at LBA 0x%016llX",
+            (long long)numLBA, (unsigned long long)slba);
+        ProtInfo::Generate(layout, writeMem->GetBuffer(),
+            writeCmd->GetMetaBuffer(), numLBA, slba, E2E_APP_TAG);
+
+        writeCmd->SetPrpBuffer(prpBitmask, writeMem);
+        writeCmd->SetNSID(e2e[i]);
+        writeCmd->SetSLBA(slba);
+        writeCmd->SetNLB(numLBA - 1);   // convert to 0-based value
+        writeCmd->SetPRINFO(PRINFO_PRCHK_ALL);
+        ProtInfo::SetCmdTags(writeCmd, slba, E2E_APP_TAG);
+
+        readCmd->SetPrpBuffer(prpBitmask, readMem);
+        readCmd->SetNSID(e2e[i]);
+        readCmd->SetSLBA(slba);
+        readCmd->SetNLB(numLBA - 1);    // convert to 0-based value
+        ProtInfo::SetCmdTags(readCmd, slba, E2E_APP_TAG);
+
+        work = str(boost::format("NSID.%d") % e2e[i]);
+        IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
+            iocq, writeCmd, work, true);
+
+        // Unchecked by the DUT the host is the only one verifying the PI
+        uint8_t prchk[] = { 0, PRINFO_PRCHK_ALL };
+        for (size_t p = 0; p < (sizeof(prchk) / sizeof(prchk[0])); p++) {
+            work = str(boost::format("NSID.%d.PRCHK.%d") % e2e[i] %
+                (int)prchk[p]);
+            readMem->Zero();
+            if (layout.interleaved == false) {
+                memset(readCmd->GetMetaBuffer(), 0,
+                    readCmd->GetMetaBufferSize());
+            }
+            readCmd->SetPRINFO(prchk[p]);
+            IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
+                iocq, readCmd, work, true);
+            VerifyReadBack(layout, readCmd, writeCmd, numLBA, slba, work);
+        }
+
+        LOG_NRM("Delete IOSQ before the IOCQ to comply with spec.");
+        Queues::DeleteIOSQToHdw(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
+            iosq, asq, acq);
+        Queues::DeleteIOCQToHdw(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
+            iocq, asq, acq);
+    }
+}
+
+
+void
+E2EReadBack_r10b::VerifyReadBack(const PILayout &layout,
+    SharedReadPtr readCmd, SharedWritePtr writeCmd, uint32_t numLBA,
+    uint64_t slba, string work)
+{
+    SharedMemBufferPtr rdPayload = readCmd->GetRWPrpBuffer();
+    SharedMemBufferPtr wrPayload = writeCmd->GetRWPrpBuffer();
+
+    LOG_NRM("Verify the guard, app tag and ref tag of every LBA read");
+    bool piOk = ProtInfo::Verify(layout, rdPayload->GetBuffer(),
+        readCmd->GetMetaBuffer(), numLBA, slba, E2E_APP_TAG,
+        PRINFO_PRCHK_ALL);
+
+    LOG_NRM("Compare read vs written data and meta data");
+    bool dataOk = rdPayload->Compare(wrPayload);
+    bool metaOk = ((layout.interleaved == true) ||
+        (memcmp(readCmd->GetMetaBuffer(), writeCmd->GetMetaBuffer(),
+        writeCmd->GetMetaBufferSize()) == 0));
+
+    if (piOk && dataOk && metaOk)
+        return;
+
+    readCmd->Dump(
+        FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadCmd", work),
+        "Read command");
+    rdPayload->Dump(
+        FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadPayload", work),
+        "Data read from media");
+    wrPayload->Dump(
+        FileSystem::PrepDumpFile(mGrpName, mTestName, "WrittenPayload", work),
+        "Data written to media");
+    if (piOk == false)
+        throw FrmwkEx(HERE, "Protection info read back failed verification");
+    else if (dataOk == false)
+        throw FrmwkEx(HERE, "Data miscompare");
+    throw FrmwkEx(HERE, "Meta data miscompare");
+}
+
+
+void
+E2EReadBack_r10b::CreateIOQs(SharedASQPtr asq, SharedACQPtr acq,
+    SharedIOSQPtr &iosq, SharedIOCQPtr &iocq)
+{
+    uint32_t numEntries = 2;
+    uint8_t iocqes = (gInformative->GetIdentifyCmdCtrlr()->
+        GetValue(IDCTRLRCAP_CQES) & 0xf);
+    uint8_t iosqes = (gInformative->GetIdentifyCmdCtrlr()->
+        GetValue(IDCTRLRCAP_SQES) & 0xf);
+
+    gCtrlrConfig->SetIOCQES(iocqes);
+    gCtrlrConfig->SetIOSQES(iosqes);
+
+    iocq = Queues::CreateIOCQContigToHdw(mGrpName, mTestName,
+        CALC_TIMEOUT_ms(1), asq, acq, IOQ_ID, numEntries, false,
+        IOCQ_GROUP_ID, true, 0);
+    iosq = Queues::CreateIOSQContigToHdw(mGrpName, mTestName,
+        CALC_TIMEOUT_ms(1), asq, acq, IOQ_ID, numEntries, false,
+        IOSQ_GROUP_ID, IOQ_ID, 0);
+}
+
+}   // namespace
@@ -23,9 +23,12 @@
 #include "startingLBABare_r10b.h"
 #include "nlbaBare_r10b.h"
 #include "datasetMgmt_r10b.h"
+#include "seqFillBare_r10b.h"
 #include "startingLBAMeta_r10b.h"
 #include "nlbaMeta_r10b.h"
 #include "prp2Rsvd_r10b.h"
+#include "prpOffsetBandwidth_r10b.h"
+#include "e2eReadBack_r10b.h"
 
 namespace GrpNVMWriteReadCombo {
 
@@ -50,9 +53,12 @@ GrpNVMWriteReadCombo::GrpNVMWriteReadCombo(size_t grpNum) :
         APPEND_TEST_AT_YLEVEL(StartingLBABare_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_YLEVEL(NLBABare_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_YLEVEL(DatasetMgmt_r10b, GrpNVMWriteReadCombo)
+        APPEND_TEST_AT_YLEVEL(SeqFillBare_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_XLEVEL(StartingLBAMeta_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_XLEVEL(NLBAMeta_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_XLEVEL(PRP2Rsvd_r10b, GrpNVMWriteReadCombo)
+        APPEND_TEST_AT_XLEVEL(PRPOffsetBandwidth_r10b, GrpNVMWriteReadCombo)
+        APPEND_TEST_AT_XLEVEL(E2EReadBack_r10b, GrpNVMWriteReadCombo)
 
         break;
 
@@ -148,6 +148,13 @@ NLBABare_r10b::RunCoreTest()
         writeCmd->SetNSID(bare[i]);
         readCmd->SetNSID(bare[i]);
 
+        // Allocate and pin the largest payloads once, every smaller size
+        // below then reuses the registered allocations
+        writeMem->Init(maxWrBlks * lbaDataSize);
+        writeMem->Register();
+        readMem->Init(maxWrBlks * lbaDataSize);
+        readMem->Register();
+
         // If we execute for every possible LBA, then it will take hrs to
         // complete. So incrementing LBA in powers of 2 is a best effort
         // solution to minimize the execution time.
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <boost/format.hpp>
+#include "prpOffsetBandwidth_r10b.h"
+#include "grpDefs.h"
+#include "../Utils/irq.h"
+
+#define BW_QUEUE_DEPTH              8
+#define NUM_CMDS_PER_POINT          256
+
+// Offsets into the 1st memory page, those >= CC.MPS are skipped; they mimic
+// the DWORD aligned, but otherwise arbitrary, buffers applications hand over.
+static const uint32_t SWEEP_PGOFF[] =
+    { 0, 4, 8, 64, 512, 1024, 2048, 3072, 4092, 8188, 16380 };
+#define NUM_SWEEP_PGOFF             (sizeof(SWEEP_PGOFF) / sizeof(uint32_t))
+
+
+namespace GrpNVMWriteReadCombo {
+
+
+PRPOffsetBandwidth_r10b::PRPOffsetBandwidth_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 4.3, 6");
+    mTestDesc.SetShort(     "Characterize bandwidth vs xfer size, buff offset and PRP shape");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "Search for 1 of the following namspcs to run test. Find 1st bare "
+        "namspc, or find 1st meta namspc. Create 1 IOSQ:IOCQ pair large "
+        "enough for a queue depth of QD, where QD is the lesser of 8 or "
+        "CAP.MQES. In an outer loop vary the offset into the 1st memory page "
+        "through {0, 4, 8, 64, 512, 1024, 2048, 3072, 4092, 8188, 16380} "
+        "while the offset is less than CC.MPS, in an inner loop vary the "
+        "number of blocks read from 1 to Y in powers of 2, where Y * "
+        "Identify.LBAF[Identify.FLBAS].LBADS is the lesser of Identify.MDTS "
+        "or 256 KB if MDTS is unlimited. At every point keep QD read cmds "
+        "starting at LBA 0 outstanding until 256 cmds complete, each cmd "
+        "using its own discontig buffer at that offset, thus every PRP "
+        "layout results of PRP1 only, PRP1/PRP2 and PRP1/PRP list. Report "
+        "the throughput and completion latency of every point as a CSV and "
+        "as heat maps of offset vs xfer size. This test only characterizes "
+        "the DUT, other than failing cmds it has no pass/fail criteria, "
+        "thus it only runs when cmd line option --bench is specified.");
+}
+
+
+PRPOffsetBandwidth_r10b::~PRPOffsetBandwidth_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+PRPOffsetBandwidth_r10b::
+PRPOffsetBandwidth_r10b(const PRPOffsetBandwidth_r10b &other) : Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+PRPOffsetBandwidth_r10b &
+PRPOffsetBandwidth_r10b::operator=(const PRPOffsetBandwidth_r10b &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+PRPOffsetBandwidth_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (gCmdLine.bench == false)
+        return RUN_FALSE;   // Optional benchmark test skipped.
+
+    preserve = preserve;    // Suppress compiler error/warning
+    return RUN_TRUE;        // This test is never destructive
+}
+
+
+void
+PRPOffsetBandwidth_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * None.
+     * \endverbatim
+     */
+    uint64_t reg;
+
+    if (gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY) == false)
+        throw FrmwkEx(HERE);
+
+    // Create ACQ and ASQ objects which have test life time
+    SharedACQPtr acq = CAST_TO_ACQ(SharedACQPtr(new ACQ(gDutFd)))
+    acq->Init(5);
+    SharedASQPtr asq = CAST_TO_ASQ(SharedASQPtr(new ASQ(gDutFd)))
+    asq->Init(5);
+
+    IRQ::SetAnySchemeSpecifyNum(2);     // throws upon error
+
+    gCtrlrConfig->SetCSS(CtrlrConfig::CSS_NVM_CMDSET);
+    if (gCtrlrConfig->SetState(ST_ENABLE) == false)
+        throw FrmwkEx(HERE);
+
+    if (gRegisters->Read(CTLSPC_CAP, reg) == false)
+        throw FrmwkEx(HERE, "Unable to determine CAP.MQES");
+    uint32_t qDepth = MIN((uint32_t)(reg & CAP_MQES), BW_QUEUE_DEPTH);
+    if (qDepth == 0)
+        throw FrmwkEx(HERE, "CAP.MQES reports illegal value of 0");
+
+    SharedIOCQPtr iocq;
+    SharedIOSQPtr iosq;
+    InitTstRsrcs(asq, acq, qDepth, iosq, iocq);
+
+    LOG_NRM("Compute memory page size from CC.MPS");
+    uint8_t mpsRegVal;
+    if (gCtrlrConfig->GetMPS(mpsRegVal) == false)
+        throw FrmwkEx(HERE, "Unable to get MPS value from CC.");
+    uint64_t ccMPS = (uint64_t)(1 << (mpsRegVal + 12));
+
+    LOG_NRM("Get namspc and determine LBA size");
+    Informative::Namspc namspcData = gInformative->Get1stBareMetaE2E();
+    send_64b_bitmask prpBitmask =
+        (send_64b_bitmask)(MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+    LBAFormat lbaFormat = namspcData.idCmdNamspc->GetLBAFormat();
+    uint64_t lbaDataSize = (1 << lbaFormat.LBADS);
+    uint64_t lbaXferSize = lbaDataSize;
+
+    LOG_NRM("Seeking max data xfer size for chosen namspc");
+    ConstSharedIdentifyPtr idCmdCtrlr = gInformative->GetIdentifyCmdCtrlr();
+    uint32_t maxDtXferSz = idCmdCtrlr->GetMaxDataXferSize();
+    if (maxDtXferSz == 0)
+        maxDtXferSz = MAX_DATA_TX_SIZE;
+
+    switch (namspcData.type) {
+    case Informative::NS_BARE:
+        break;
+    case Informative::NS_METAS:
+        LOG_NRM("Allocating meta data size %ld",
+            (lbaFormat.MS * (maxDtXferSz / lbaDataSize)));
+        if ((gRsrcMngr->SetMetaAllocSize(
+            lbaFormat.MS * (maxDtXferSz / lbaDataSize)) == false) ||
+            (gRsrcMngr->PreallocMetaBuf(qDepth) == false)) {
+            throw FrmwkEx(HERE, "Unable to allocate Meta buffers.");
+        }
+        break;
+    case Informative::NS_METAI:
+        lbaXferSize += lbaFormat.MS;
+        break;
+    case Informative::NS_E2ES:
+    case Informative::NS_E2EI:
+        LOG_WARN("PI of never written LBA's may not be read; can't run test");
+        return;
+    }
+    uint64_t maxNLBA = (maxDtXferSz / lbaXferSize);
+    if (maxNLBA == 0) {
+        LOG_WARN("MDTS < 1 logical block; Can't run test.");
+        return;
+    }
+
+    LOG_NRM("Prepare QD=%d cmds to utilize, each owning its buffer", qDepth);
+    std::vector<SharedCmdPtr> cmds;
+    std::vector<SharedMemBufferPtr> readMems;
+    for (uint32_t i = 0; i < qDepth; i++) {
+        SharedReadPtr readCmd = SharedReadPtr(new Read());
+        readCmd->SetNSID(namspcData.id);
+        if (namspcData.type == Informative::NS_METAS)
+            readCmd->AllocMetaBuffer();
+        cmds.push_back(readCmd);
+        readMems.push_back(SharedMemBufferPtr(new MemBuffer()));
+    }
+
+    std::vector<uint64_t> nlbas;
+    for (uint64_t nLBA = 1; nLBA <= maxNLBA; nLBA <<= 1)
+        nlbas.push_back(nLBA);
+    std::vector<uint32_t> offsets;
+    for (size_t o = 0; o < NUM_SWEEP_PGOFF; o++) {
+        if (SWEEP_PGOFF[o] < ccMPS)
+            offsets.push_back(SWEEP_PGOFF[o]);
+    }
+    // Indexed [offset][xfer size]
+    std::vector<std::vector<WorkloadStats> > results(offsets.size(),
+        std::vector<WorkloadStats>(nlbas.size()));
+
+    FILE *fp = fopen(FileSystem::PrepDumpFile(mGrpName, mTestName,
+        "sweep", "csv").c_str(), "w");
+    if (fp == NULL)
+        throw FrmwkEx(HERE, "Unable to open file for the sweep results");
+    fprintf(fp, "pg_off,nlba,xfer_bytes,prp_shape,qdepth,cmds,lat_min_us,"
+        "lat_avg_us,lat_max_us,iops,mb_per_sec\n");
+
+    try {
+        for (size_t o = 0; o < offsets.size(); o++) {
+            for (size_t n = 0; n < nlbas.size(); n++) {
+                uint64_t xferSz = (nlbas[n] * lbaXferSize);
+                for (uint32_t i = 0; i < qDepth; i++) {
+                    SharedReadPtr readCmd = CAST_TO_READ(cmds[i])
+                    readMems[i]->InitOffset1stPage(xferSz, offsets[o], false);
+                    readCmd->SetPrpBuffer(prpBitmask, readMems[i]);
+                    readCmd->SetNLB(nlbas[n] - 1);  // convert to 0 based.
+                }
+
+                WorkloadStats &stats = results[o][n];
+                Workload::SustainQD(mGrpName, mTestName, iosq, iocq, cmds,
+                    NUM_CMDS_PER_POINT, stats);
+                string shape = PrpShape(offsets[o], xferSz, ccMPS);
+                Workload::LogStats(str(boost::format(
+                    "pgOff=%d, xfer=%lld, %s") % offsets[o] %
+                    (long long)xferSz % shape), stats);
+
+                uint64_t numCmds = MAX(stats.numCmds, (uint64_t)1);
+                uint64_t elapsed = MAX(stats.elapsed_us, (uint64_t)1);
+                fprintf(fp, "%d,%llu,%llu,%s,%d,%llu,%llu,%llu,%llu,%llu,"
+                    "%.2f\n", offsets[o], (unsigned long long)nlbas[n],
+                    (unsigned long long)xferSz, shape.c_str(), qDepth,
+                    (unsigned long long)stats.numCmds,
+                    (unsigned long long)stats.latMin_us,
+                    (unsigned long long)(stats.latSum_us / numCmds),
+                    (unsigned long long)stats.latMax_us,
+                    (unsigned long long)((stats.numCmds * 1000000) / elapsed),
+                    ((double)stats.numBytes / elapsed));
+            }
+        }
+    } catch (...) {
+        fclose(fp);
+        throw;
+    }
+    fclose(fp);
+
+    LOG_NRM("Write heat maps of MB/s and avg latency, offset vs xfer size");
+    fp = fopen(FileSystem::PrepDumpFile(mGrpName, mTestName,
+        "heatmap").c_str(), "w");
+    if (fp == NULL)
+        throw FrmwkEx(HERE, "Unable to open file for the heat maps");
+    for (int map = 0; map < 2; map++) {
+        fprintf(fp, "%s, QD=%d, rows=1st page offset, cols=xfer bytes\n",
+            (map == 0) ? "MB/s" : "avg latency (us)", qDepth);
+        fprintf(fp, "%8s", "");
+        for (size_t n = 0; n < nlbas.size(); n++)
+            fprintf(fp, " %9llu", (unsigned long long)(nlbas[n] * lbaXferSize));
+        fprintf(fp, "\n");
+        for (size_t o = 0; o < offsets.size(); o++) {
+            fprintf(fp, "%8d", offsets[o]);
+            for (size_t n = 0; n < nlbas.size(); n++) {
+                WorkloadStats &stats = results[o][n];
+                if (map == 0) {
+                    fprintf(fp, " %9.1f", ((double)stats.numBytes /
+                        MAX(stats.elapsed_us, (uint64_t)1)));
+                } else {
+                    fprintf(fp, " %9llu", (unsigned long long)
+                        (stats.latSum_us / MAX(stats.numCmds, (uint64_t)1)));
+                }
+            }
+            fprintf(fp, "\n");
+        }
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+}
+
+
+string
+PRPOffsetBandwidth_r10b::PrpShape(uint64_t pgOff, uint64_t xferSz,
+    uint64_t ccMPS)
+{
+    uint64_t numPages = (pgOff + xferSz + ccMPS - 1) / ccMPS;
+
+    if (numPages <= 1)
+        return "PRP1";
+    else if (numPages == 2)
+        return "PRP1+PRP2";
+    return "PRP1+list";
+}
+
+
+void
+PRPOffsetBandwidth_r10b::InitTstRsrcs(SharedASQPtr asq, SharedACQPtr acq,
+    uint32_t qDepth, SharedIOSQPtr &iosq, SharedIOCQPtr &iocq)
+{
+    uint8_t iocqes = (gInformative->GetIdentifyCmdCtrlr()->
+        GetValue(IDCTRLRCAP_CQES) & 0xf);
+    uint8_t iosqes = (gInformative->GetIdentifyCmdCtrlr()->
+        GetValue(IDCTRLRCAP_SQES) & 0xf);
+
+    gCtrlrConfig->SetIOCQES(iocqes);
+    gCtrlrConfig->SetIOSQES(iosqes);
+
+    // 1 extra entry, a full Q can only ever hold (entries - 1) elements
+    iocq = Queues::CreateIOCQContigToHdw(mGrpName, mTestName,
+        CALC_TIMEOUT_ms(1), asq, acq, IOQ_ID, (qDepth + 1), false,
+        IOCQ_GROUP_ID, true, 1);
+    iosq = Queues::CreateIOSQContigToHdw(mGrpName, mTestName,
+        CALC_TIMEOUT_ms(1), asq, acq, IOQ_ID, (qDepth + 1), false,
+        IOSQ_GROUP_ID, IOQ_ID, 0);
+}
+
+}   // namespace
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <boost/format.hpp>
+#include "seqFillBare_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Queues/iocq.h"
+#include "../Queues/iosq.h"
+#include "../Utils/logicalIO.h"
+
+// Upper limit of each namspc's fill, NCAP may reduce it further
+#define SEQFILL_BYTES               (8 * 1024 * 1024)
+
+
+namespace GrpNVMWriteReadCombo {
+
+
+SeqFillBare_r10b::SeqFillBare_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 6");
+    mTestDesc.SetShort(     "Sequentially fill bare namspcs with multi-cmd writes/reads");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "For all bare namspcs from Identify.NN; Write a single buffer of "
+        "{8MB | NCAP} which ever is less, starting at LBA 0. The buffer is "
+        "split into as many cmds as required to honor both Identify.MDTS and "
+        "DW12.NLB, each cmd referencing its own sub-range of the buffer, and "
+        "the cmds are kept outstanding up to the depth of the IOQ's. Then "
+        "read the same LBA range back into a 2nd buffer in the same manner "
+        "and verify it matches the data written. Report MB/s of both "
+        "directions.");
+}
+
+
+SeqFillBare_r10b::~SeqFillBare_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+SeqFillBare_r10b::
+SeqFillBare_r10b(const SeqFillBare_r10b &other) :
+    Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+SeqFillBare_r10b &
+SeqFillBare_r10b::operator=(const SeqFillBare_r10b
+    &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+SeqFillBare_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    return ((preserve == true) ? RUN_FALSE : RUN_TRUE);   // Test is destructive
+}
+
+
+void
+SeqFillBare_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * 1) Test CreateResources_r10b has run prior.
+     * \endverbatim
+     */
+    struct timeval start;
+    ConstSharedIdentifyPtr namSpcPtr;
+
+    LOG_NRM("Lookup objs which were created in a prior test within group");
+    SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
+    SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
+
+    SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
+    SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
+
+    vector<uint32_t> bare = gInformative->GetBareNamespaces();
+    if (bare.size() == 0) {
+        LOG_NRM("No bare namspcs exist; nothing to fill");
+        return;
+    }
+
+    for (size_t i = 0; i < bare.size(); i++) {
+        namSpcPtr = gInformative->GetIdentifyCmdNamspc(bare[i]);
+        uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
+        uint64_t ncap = namSpcPtr->GetValue(IDNAMESPC_NCAP);
+        uint64_t nlb = MIN((SEQFILL_BYTES / lbaDataSize), ncap);
+        if (nlb == 0) {
+            LOG_WARN("Namspc #%d can't hold 1 LBA of the fill; skipping",
+                bare[i]);
+            continue;
+        }
+        uint64_t fillSz = (nlb * lbaDataSize);
+        uint32_t maxBlks = LogicalIO::MaxBlksPerCmd(bare[i]);
+        LOG_NRM("Fill namspc #%d with %lld LBA's, %lld cmds of <= %d LBA's",
+            bare[i], (long long)nlb, (long long)((nlb + maxBlks - 1) / maxBlks),
+            maxBlks);
+
+        writeMem->Init(fillSz);
+        writeMem->SetDataPattern(DATAPAT_INC_32BIT, bare[i]);
+        readMem->Init(fillSz, true);
+
+        if (gettimeofday(&start, NULL) != 0)
+            throw FrmwkEx(HERE, "Unable to get the time of day");
+        LogicalIO::Write(mGrpName, mTestName, iosq, iocq, bare[i], 0,
+            writeMem);
+        uint64_t wrUs = ElapsedUs(start);
+
+        if (gettimeofday(&start, NULL) != 0)
+            throw FrmwkEx(HERE, "Unable to get the time of day");
+        LogicalIO::Read(mGrpName, mTestName, iosq, iocq, bare[i], 0,
+            readMem);
+        uint64_t rdUs = ElapsedUs(start);
+
+        // Bytes per usec is equivalent to MB/s
+        LOG_NRM("NSID.%d: %lld bytes, write %.2f MB/s, read %.2f MB/s",
+            bare[i], (long long)fillSz, ((double)fillSz / wrUs),
+            ((double)fillSz / rdUs));
+
+        LOG_NRM("Compare read vs written data to verify");
+        if (readMem->Compare(writeMem) == false) {
+            string work = str(boost::format("NSID.%d") % bare[i]);
+            readMem->Dump(
+                FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadPayload",
+                work), "Data read from media miscompared from written");
+            writeMem->Dump(
+                FileSystem::PrepDumpFile(mGrpName, mTestName,
+                "WrittenPayload", work),
+                "Data read from media miscompared from written");
+            throw FrmwkEx(HERE, "Data miscompare");
+        }
+    }
+}
+
+
+uint64_t
+SeqFillBare_r10b::ElapsedUs(const struct timeval &start)
+{
+    struct timeval now;
+
+    if (gettimeofday(&now, NULL) != 0)
+        throw FrmwkEx(HERE, "Unable to get the time of day");
+    uint64_t elapsed = ((uint64_t)(now.tv_sec - start.tv_sec) * 1000000) +
+        (now.tv_usec - start.tv_usec);
+    return MAX(elapsed, (uint64_t)1);
+}
+
+}   // namespace
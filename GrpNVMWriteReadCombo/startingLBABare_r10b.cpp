@@ -141,12 +141,15 @@ StartingLBABare_r10b::RunCoreTest()
         uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
         uint64_t maxWrBlks = maxDtXferSz / lbaDataSize;
 
+        // Same payloads are sent for every LBA range, pin them once
         writeMem->Init(maxWrBlks * lbaDataSize);
+        writeMem->Register();
         writeCmd->SetPrpBuffer(prpBitmask, writeMem);
         writeCmd->SetNSID(bare[i]);
         writeCmd->SetNLB(maxWrBlks - 1);  // 0 based value.
 
         readMem->Init(maxWrBlks * lbaDataSize);
+        readMem->Register();
         readCmd->SetPrpBuffer(prpBitmask, readMem);
         readCmd->SetNSID(bare[i]);
         readCmd->SetNLB(maxWrBlks - 1);  // 0 based value.
@@ -31,6 +31,7 @@
 #include "sqcqSizeMismatch_r10b.h"
 #include "qIdVariations_r10b.h"
 #include "illegalCreateQs_r10b.h"
+#include "wrrArbitration_r10b.h"
 
 namespace GrpQueues {
 
@@ -63,6 +64,7 @@ GrpQueues::GrpQueues(size_t grpNum) :
         APPEND_TEST_AT_YLEVEL(SQCQSizeMismatch_r10b, GrpQueues)
         APPEND_TEST_AT_YLEVEL(QIDVariations_r10b, GrpQueues)
         APPEND_TEST_AT_YLEVEL(IllegalCreateQs_r10b, GrpQueues)
+        APPEND_TEST_AT_XLEVEL(WRRArbitration_r10b, GrpQueues)
 
         break;
 
@@ -18,6 +18,8 @@
 #include "grpDefs.h"
 #include "../Utils/io.h"
 #include "../Utils/kernelAPI.h"
+#include "../Utils/workload.h"
+#include "../Utils/protInfo.h"
 
 namespace GrpQueues {
 
@@ -40,7 +42,10 @@ IOQRollChkDiff_r10b::IOQRollChkDiff_r10b(
         "LBA 0, to fill and rollover the Q's, reaping each cmd as one is "
         "submitted, verify each CE.SQID and  CE.SQHD is correct while "
         "filling. Verify IOSQ tail_ptr = <calc_based_on_IOSQ_size>, IOCQ "
-        "head_ptr = <calc_based_on_IOCQ_size>");
+        "head_ptr = <calc_based_on_IOCQ_size>. When --soak is "
+        "spec'd, keep the pair full thereafter until the requested number "
+        "of wraps or seconds elapse, verifying every CE.SQID, CE.CID, CE.SQHD "
+        "and phase tag across each wrap.");
 }
 
 
@@ -147,6 +152,12 @@ IOQRollChkDiff_r10b::IOQRollChkDiff(uint32_t numEntriesIOSQ,
     }
     VerifyQPointers(iosq, iocq);
 
+    if (gCmdLine.soak.req) {
+        SoakStats stats;
+        Workload::SoakWrap(mGrpName, mTestName, iosq, iocq, writeCmd,
+            gCmdLine.soak.wraps, gCmdLine.soak.seconds, stats);
+    }
+
     LOG_NRM("Delete IOSQ before the IOCQ to comply with spec.");
     Queues::DeleteIOSQToHdw(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
         iosq, asq, acq);
@@ -184,8 +195,13 @@ IOQRollChkDiff_r10b::SetWriteCmd()
         dataPat->Init(lbaDataSize + lbaFormat.MS);
         break;
     case Informative::NS_E2ES:
+        dataPat->Init(lbaDataSize);
+        if (gRsrcMngr->SetMetaAllocSize(lbaFormat.MS) == false)
+            throw FrmwkEx(HERE);
+        writeCmd->AllocMetaBuffer();
+        break;
     case Informative::NS_E2EI:
-        throw FrmwkEx(HERE, "Deferring work to handle this case in future");
+        dataPat->Init(lbaDataSize + lbaFormat.MS);
         break;
     }
 
@@ -193,6 +209,15 @@ IOQRollChkDiff_r10b::SetWriteCmd()
     writeCmd->SetNSID(namspcData.id);
     writeCmd->SetNLB(0);
 
+    if ((namspcData.type == Informative::NS_E2ES) ||
+        (namspcData.type == Informative::NS_E2EI)) {
+        PILayout layout = ProtInfo::GetLayout(namspcData.idCmdNamspc);
+        ProtInfo::Generate(layout, dataPat->GetBuffer(),
+            writeCmd->GetMetaBuffer(), 1, 0, 0);
+        writeCmd->SetPRINFO(PRINFO_PRCHK_ALL);
+        ProtInfo::SetCmdTags(writeCmd, 0, 0);
+    }
+
     return writeCmd;
 }
 
@@ -18,6 +18,8 @@
 #include "grpDefs.h"
 #include "../Utils/io.h"
 #include "../Utils/kernelAPI.h"
+#include "../Utils/workload.h"
+#include "../Utils/protInfo.h"
 
 namespace GrpQueues {
 
@@ -39,7 +41,10 @@ IOQRollChkSame_r10b::IOQRollChkSame_r10b(
         "namspc at LBA 0, to fill and rollover the Q's, reaping each cmd as "
         "one is submitted, verify each CE.SQID is correct while filling. "
         "At the end of reaping all CE's verify IOSQ tail_ptr = 2, "
-        "IOCQ head_ptr = 2, and CE.SQHD = 2.");
+        "IOCQ head_ptr = 2, and CE.SQHD = 2. When --soak is "
+        "spec'd, keep the pair full thereafter until the requested number "
+        "of wraps or seconds elapse, verifying every CE.SQID, CE.CID, CE.SQHD "
+        "and phase tag across each wrap.");
 }
 
 
@@ -143,6 +148,12 @@ IOQRollChkSame_r10b::IOQRollChkSame(uint32_t numEntriesIOQ)
     }
     VerifyQPointers(iosq, iocq);
 
+    if (gCmdLine.soak.req) {
+        SoakStats stats;
+        Workload::SoakWrap(mGrpName, mTestName, iosq, iocq, writeCmd,
+            gCmdLine.soak.wraps, gCmdLine.soak.seconds, stats);
+    }
+
     LOG_NRM("Delete IOSQ before the IOCQ to comply with spec.");
     Queues::DeleteIOSQToHdw(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
         iosq, asq, acq);
@@ -180,8 +191,13 @@ IOQRollChkSame_r10b::SetWriteCmd()
         dataPat->Init(lbaDataSize + lbaFormat.MS);
         break;
     case Informative::NS_E2ES:
+        dataPat->Init(lbaDataSize);
+        if (gRsrcMngr->SetMetaAllocSize(lbaFormat.MS) == false)
+            throw FrmwkEx(HERE);
+        writeCmd->AllocMetaBuffer();
+        break;
     case Informative::NS_E2EI:
-        throw FrmwkEx(HERE, "Deferring work to handle this case in future");
+        dataPat->Init(lbaDataSize + lbaFormat.MS);
         break;
     }
 
@@ -189,6 +205,15 @@ IOQRollChkSame_r10b::SetWriteCmd()
     writeCmd->SetNSID(namspcData.id);
     writeCmd->SetNLB(0);
 
+    if ((namspcData.type == Informative::NS_E2ES) ||
+        (namspcData.type == Informative::NS_E2EI)) {
+        PILayout layout = ProtInfo::GetLayout(namspcData.idCmdNamspc);
+        ProtInfo::Generate(layout, dataPat->GetBuffer(),
+            writeCmd->GetMetaBuffer(), 1, 0, 0);
+        writeCmd->SetPRINFO(PRINFO_PRCHK_ALL);
+        ProtInfo::SetCmdTags(writeCmd, 0, 0);
+    }
+
     return writeCmd;
 }
 
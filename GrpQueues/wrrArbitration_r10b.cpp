@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <boost/format.hpp>
+#include "wrrArbitration_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Queues/acq.h"
+#include "../Queues/asq.h"
+#include "../Utils/queues.h"
+#include "../Utils/io.h"
+#include "../Utils/irq.h"
+#include "../Cmds/setFeatures.h"
+#include "../Cmds/featureDefs.h"
+
+#define PRIORITY_URGENT             0
+#define PRIORITY_HIGH               1
+#define PRIORITY_MEDIUM             2
+#define PRIORITY_LOW                3
+#define NUM_PRIORITY_CLASSES        4
+#define MAX_QD_PER_SQ               16
+#define NUM_CMDS_PER_PHASE          4096
+
+// Weights and burst are programmed 0-based, i.e. weights of 8:4:2 and an
+// arbitration burst of 2^0 = 1 cmd so the weights alone dictate the share.
+#define WRR_HPW                     7
+#define WRR_MPW                     3
+#define WRR_LPW                     1
+#define WRR_AB                      0
+
+static const char *PRIORITY_NAME[NUM_PRIORITY_CLASSES] = {
+    "urgent", "high", "medium", "low"
+};
+
+
+namespace GrpQueues {
+
+
+WRRArbitration_r10b::WRRArbitration_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 4.7, 5.12.1.1");
+    mTestDesc.SetShort(     "Measure WRR cmd share across IOSQ priority classes");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "Only allowed to execute test if CAP.AMS reports support for weighted "
+        "round robin with urgent priority class and the DUT supports >= 4 "
+        "IOSQ's. Create ACQ/ASQ, set CC.AMS = 001b and enable the DUT, verify "
+        "CC.AMS reads back 001b. Issue Set Features (Arbitration) with HPW=7, "
+        "MPW=3, LPW=1, AB=0. Create a single IOCQ and 4 IOSQ's completing "
+        "into it, 1 per priority class urgent, high, medium and low. Phase 1: "
+        "saturate the high, medium and low IOSQ's concurrently with read "
+        "cmds of 1 block at LBA 0 until 4096 cmds complete and report the "
+        "achieved cmd share of each class against the share expected from "
+        "the configured weights, i.e. 8:4:2. Phase 2: repeat with the urgent "
+        "IOSQ also saturated and report the share achieved by the urgent "
+        "class, which is expected to dominate. Warn when the achieved shares "
+        "are not ordered by priority. Restore CC.AMS = 000b at completion.");
+}
+
+
+WRRArbitration_r10b::~WRRArbitration_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+WRRArbitration_r10b::
+WRRArbitration_r10b(const WRRArbitration_r10b &other) : Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+WRRArbitration_r10b &
+WRRArbitration_r10b::operator=(const WRRArbitration_r10b &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+WRRArbitration_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    preserve = preserve;    // Suppress compiler error/warning
+    return RUN_TRUE;        // This test is never destructive
+}
+
+
+void
+WRRArbitration_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * None.
+     * \endverbatim
+     */
+    uint64_t reg;
+
+    LOG_NRM("Only allowed to execute if DUT supports WRR w/ urgent class");
+    if (gRegisters->Read(CTLSPC_CAP, reg) == false)
+        throw FrmwkEx(HERE, "Unable to determine CAP.AMS");
+    if ((((reg & CAP_AMS) >> CAP_SH_AMS) & CAP_AMS_WRRwUPC) == 0) {
+        LOG_NRM("DUT does not support WRR arbitration; unable to execute");
+        return;
+    } else if (gInformative->GetFeaturesNumOfIOSQs() < NUM_PRIORITY_CLASSES) {
+        LOG_WARN("DUT supports < %d IOSQ's; unable to execute test",
+            NUM_PRIORITY_CLASSES);
+        return;
+    }
+
+    // 1 IOCQ must be able to hold the CE's of every outstanding cmd
+    uint32_t mqes = (uint32_t)(reg & CAP_MQES);
+    uint32_t qDepth = MIN(MAX_QD_PER_SQ, (mqes / NUM_PRIORITY_CLASSES));
+    if (qDepth == 0) {
+        LOG_WARN("CAP.MQES too small to saturate %d IOSQ's",
+            NUM_PRIORITY_CLASSES);
+        return;
+    }
+
+    try {
+        SaturateQueues(qDepth);
+    } catch (...) {
+        // Best effort, the failure of the test is what must be reported
+        try {
+            RestoreAMS();
+        } catch (...) {
+            LOG_ERR("Unable to restore round robin arbitration");
+        }
+        throw;
+    }
+    RestoreAMS();
+}
+
+
+void
+WRRArbitration_r10b::SaturateQueues(uint32_t qDepth)
+{
+    uint8_t ams;
+
+    if (gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY) == false)
+        throw FrmwkEx(HERE);
+
+    LOG_NRM("Create admin queues ACQ and ASQ");
+    SharedACQPtr acq = SharedACQPtr(new ACQ(gDutFd));
+    acq->Init(5);
+
+    SharedASQPtr asq = SharedASQPtr(new ASQ(gDutFd));
+    asq->Init(5);
+
+    // All queues will use identical IRQ vector
+    IRQ::SetAnySchemeSpecifyNum(1);
+
+    LOG_NRM("Select weighted round robin w/ urgent priority class");
+    gCtrlrConfig->SetCSS(CtrlrConfig::CSS_NVM_CMDSET);
+    if (gCtrlrConfig->SetAMS(CC_AMS_WRRwUPC) == false)
+        throw FrmwkEx(HERE);
+    if (gCtrlrConfig->SetState(ST_ENABLE) == false)
+        throw FrmwkEx(HERE);
+    if (gCtrlrConfig->GetAMS(ams) == false)
+        throw FrmwkEx(HERE);
+    else if (ams != CC_AMS_WRRwUPC) {
+        throw FrmwkEx(HERE, "CC.AMS = 0x%02X, CAP.AMS reports WRR support",
+            ams);
+    }
+
+    LOG_NRM("Configure WRR weights via Set Features (Arbitration)");
+    SharedSetFeaturesPtr setFeaturesCmd =
+        SharedSetFeaturesPtr(new SetFeatures());
+    setFeaturesCmd->SetFID(FID[FID_ARBITRATION]);
+    setFeaturesCmd->SetArbitration(WRR_HPW, WRR_MPW, WRR_LPW, WRR_AB);
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), asq, acq,
+        setFeaturesCmd, "arbitration", true);
+
+    LOG_NRM("Setup element sizes for the IOQ's");
+    gCtrlrConfig->SetIOCQES(gInformative->GetIdentifyCmdCtrlr()->
+        GetValue(IDCTRLRCAP_CQES) & 0xf);
+    gCtrlrConfig->SetIOSQES(gInformative->GetIdentifyCmdCtrlr()->
+        GetValue(IDCTRLRCAP_SQES) & 0xf);
+
+    LOG_NRM("Create 1 IOCQ and 1 IOSQ per priority class, QD %d", qDepth);
+    SharedIOCQPtr iocq = Queues::CreateIOCQContigToHdw(mGrpName, mTestName,
+        CALC_TIMEOUT_ms(1), asq, acq, IOQ_ID,
+        ((qDepth * NUM_PRIORITY_CLASSES) + 1), false, "", false, 0);
+
+    vector<SharedIOSQPtr> iosqs;
+    for (uint8_t priority = 0; priority < NUM_PRIORITY_CLASSES; priority++) {
+        iosqs.push_back(Queues::CreateIOSQContigToHdw(mGrpName, mTestName,
+            CALC_TIMEOUT_ms(1), asq, acq, (IOQ_ID + priority), (qDepth + 1),
+            false, "", IOQ_ID, priority));
+    }
+
+    vector<SharedSQPtr> sqs;
+    vector<vector<SharedCmdPtr> > cmds;
+    vector<uint8_t> priorities;
+    vector<WorkloadStats> stats;
+
+    LOG_NRM("Phase 1: saturate the high, medium and low priority IOSQ's");
+    for (uint8_t priority = PRIORITY_HIGH; priority <= PRIORITY_LOW;
+        priority++) {
+        sqs.push_back(iosqs[priority]);
+        cmds.push_back(Workload::CreateReadCmds(qDepth));
+        priorities.push_back(priority);
+    }
+    Workload::SustainQD(mGrpName, mTestName, sqs, iocq, cmds,
+        NUM_CMDS_PER_PHASE, stats);
+    ReportShare("weighted", priorities, stats);
+
+    LOG_NRM("Phase 2: also saturate the urgent priority IOSQ");
+    sqs.insert(sqs.begin(), iosqs[PRIORITY_URGENT]);
+    cmds.insert(cmds.begin(), Workload::CreateReadCmds(qDepth));
+    priorities.insert(priorities.begin(), PRIORITY_URGENT);
+    Workload::SustainQD(mGrpName, mTestName, sqs, iocq, cmds,
+        NUM_CMDS_PER_PHASE, stats);
+    ReportShare("urgent", priorities, stats);
+}
+
+
+void
+WRRArbitration_r10b::RestoreAMS()
+{
+    LOG_NRM("Restore round robin arbitration for subsequent tests");
+    if (gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY) == false)
+        throw FrmwkEx(HERE);
+    if (gCtrlrConfig->SetAMS(CC_AMS_RoundRobin) == false)
+        throw FrmwkEx(HERE);
+}
+
+
+void
+WRRArbitration_r10b::ReportShare(string phase, vector<uint8_t> &priorities,
+    vector<WorkloadStats> &stats)
+{
+    const uint32_t weight[NUM_PRIORITY_CLASSES] = {
+        0, (WRR_HPW + 1), (WRR_MPW + 1), (WRR_LPW + 1)
+    };
+    uint64_t total = 0;
+    uint32_t totalWeight = 0;
+    bool urgent = false;
+
+    for (size_t i = 0; i < stats.size(); i++) {
+        total += stats[i].numCmds;
+        totalWeight += weight[priorities[i]];
+        if (priorities[i] == PRIORITY_URGENT)
+            urgent = true;
+    }
+    total = MAX(total, (uint64_t)1);
+
+    LOG_NRM("Arbitration share (%s), %llu cmds:", phase.c_str(),
+        (unsigned long long)total);
+    double prevShare = 1.0;
+    for (size_t i = 0; i < stats.size(); i++) {
+        double share = (double)stats[i].numCmds / total;
+        double expect;
+        if (urgent)
+            expect = (priorities[i] == PRIORITY_URGENT) ? 1.0 : 0.0;
+        else
+            expect = (double)weight[priorities[i]] / totalWeight;
+
+        Workload::LogStats(str(boost::format("  IOSQ %d (%s)") %
+            (IOQ_ID + priorities[i]) % PRIORITY_NAME[priorities[i]]),
+            stats[i]);
+        LOG_NRM("  %-6s: weight %d, expected %5.1f%%, achieved %5.1f%%",
+            PRIORITY_NAME[priorities[i]], weight[priorities[i]],
+            (expect * 100), (share * 100));
+
+        if (share > prevShare) {
+            LOG_WARN("Class %s achieved a larger share than the class above",
+                PRIORITY_NAME[priorities[i]]);
+        }
+        prevShare = share;
+    }
+}
+
+}   // namespace
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _WRRARBITRATION_r10b_H_
+#define _WRRARBITRATION_r10b_H_
+
+#include "test.h"
+#include "../Utils/workload.h"
+
+namespace GrpQueues {
+
+
+/** \verbatim
+ * -----------------------------------------------------------------------------
+ * ----------------Mandatory rules for children to follow-----------------------
+ * -----------------------------------------------------------------------------
+ * 1) See notes in the header file of the Test base class
+ * \endverbatim
+ */
+class WRRArbitration_r10b : public Test
+{
+public:
+    WRRArbitration_r10b(string grpName, string testName);
+    virtual ~WRRArbitration_r10b();
+
+    /**
+     * IMPORTANT: Read Test::Clone() header comment.
+     */
+    virtual WRRArbitration_r10b *Clone() const
+        { return new WRRArbitration_r10b(*this); }
+    WRRArbitration_r10b &operator=(const WRRArbitration_r10b &other);
+    WRRArbitration_r10b(const WRRArbitration_r10b &other);
+
+
+protected:
+    virtual void RunCoreTest();
+    virtual RunType RunnableCoreTest(bool preserve);
+
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Adding a member variable? Then edit the copy constructor and operator=().
+    ///////////////////////////////////////////////////////////////////////////
+    /**
+     * Select WRR arbitration and saturate 1 IOSQ per priority class.
+     * @note Leaves CC.AMS selecting WRR, see RestoreAMS()
+     * @param qDepth Pass the num of cmds to keep outstanding per IOSQ
+     */
+    void SaturateQueues(uint32_t qDepth);
+
+    /**
+     * Disable the DUT and select round robin arbitration, which subsequent
+     * tests expect.
+     */
+    void RestoreAMS();
+
+    void ReportShare(string phase, std::vector<uint8_t> &priorities,
+        std::vector<WorkloadStats> &stats);
+};
+
+}   // namespace
+
+#endif
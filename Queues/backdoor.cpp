@@ -16,6 +16,7 @@
 
 #include "backdoor.h"
 #include "../Exception/frmwkEx.h"
+#include "../Utils/ioStats.h"
 
 
 Backdoor::Backdoor()
@@ -43,6 +44,6 @@ Backdoor::SetToxicCmdValue(struct backdoor_inject &injectReq)
     int ret;
 
     // This is volatile, see class level header comment.
-    if ((ret = ioctl(mFD, NVME_IOCTL_TOXIC_64B_DWORD, &injectReq)) < 0)
+    if ((ret = IoStats::Ioctl(mFD, NVME_IOCTL_TOXIC_64B_DWORD, &injectReq)) < 0)
         throw FrmwkEx(HERE, "Backdoor toxic injection failed: 0x%02X", ret);
 }
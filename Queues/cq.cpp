@@ -17,8 +17,12 @@
 #include <sys/time.h>
 #include "cq.h"
 #include "globals.h"
+#include "timeouts.h"
 #include "../Utils/kernelAPI.h"
 #include "../Utils/buffers.h"
+#include "../Utils/dumpArchive.h"
+#include "../Utils/ioStats.h"
+#include "../Utils/probes.h"
 
 SharedCQPtr CQ::NullCQPtr;
 
@@ -80,7 +84,7 @@ CQ::Init(uint16_t qId, uint16_t entrySize, uint32_t numEntries,
         LOG_NRM("Init contig ACQ: (id, entrySize, numEntries) = (%d, %d, %d)",
             GetQId(), GetEntrySize(), GetNumEntries());
 
-        if ((ret = ioctl(mFd, NVME_IOCTL_CREATE_ADMN_Q, &q)) < 0) {
+        if ((ret = IoStats::Ioctl(mFd, NVME_IOCTL_CREATE_ADMN_Q, &q)) < 0) {
             throw FrmwkEx(HERE, "Q Creation failed by dnvme with error: 0x%02X",
                 ret);
         }
@@ -158,7 +162,7 @@ CQ::CreateIOCQ(struct nvme_prep_cq &q)
         q.contig ? "contig" : "discontig", GetQId(), GetEntrySize(),
         GetNumEntries());
 
-    if ((ret = ioctl(mFd, NVME_IOCTL_PREPARE_CQ_CREATION, &q)) < 0) {
+    if ((ret = IoStats::Ioctl(mFd, NVME_IOCTL_PREPARE_CQ_CREATION, &q)) < 0) {
         throw FrmwkEx(HERE, "Q Creation failed by dnvme with error: 0x%02X",
             ret);
     }
@@ -177,7 +181,8 @@ CQ::GetQMetrics()
     getQMetrics.nBytes = sizeof(qMetrics);
     getQMetrics.buffer = (uint8_t *)&qMetrics;
 
-    if ((ret = ioctl(mFd, NVME_IOCTL_GET_Q_METRICS, &getQMetrics)) < 0) {
+    if ((ret = IoStats::Ioctl(mFd, NVME_IOCTL_GET_Q_METRICS,
+        &getQMetrics)) < 0) {
         throw FrmwkEx(HERE, 
             "Get Q metrics failed by dnvme with error: 0x%02X", ret);
     }
@@ -265,8 +270,9 @@ CQ::ReapInquiry(uint32_t &isrCount, bool reportOn0)
     struct nvme_reap_inquiry inq;
 
     inq.q_id = GetQId();
-    if ((rc = ioctl(mFd, NVME_IOCTL_REAP_INQUIRY, &inq)) < 0)
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_REAP_INQUIRY, &inq)) < 0)
         throw FrmwkEx(HERE, "Error during reap inquiry, rc = %d", rc);
+    TNVME_PROBE3(cq_reap_inquiry, inq.q_id, inq.num_remaining, inq.isr_count);
 
     isrCount = inq.isr_count;
     if (inq.num_remaining || reportOn0) {
@@ -278,10 +284,12 @@ CQ::ReapInquiry(uint32_t &isrCount, bool reportOn0)
 
 
 bool
-CQ::ReapInquiryWaitAny(uint32_t ms, uint32_t &numCE, uint32_t &isrCount)
+CQ::ReapInquiryWaitAny(uint32_t budget, uint32_t &numCE, uint32_t &isrCount)
 {
     uint32_t delta;
 
+    uint32_t ms = Timeouts::Adapt(GetQId(), budget);
+
     // Avoid a common mistake, waiting longer than a day?
     if (ms > 86400000)
         LOG_WARN("Waiting > 1 day, is this reasonable?");
@@ -309,6 +317,7 @@ CQ::ReapInquiryWaitAny(uint32_t ms, uint32_t &numCE, uint32_t &isrCount)
     LogCE((qMetrics.head_ptr + 1) % qMetrics.elements);
     LOG_NRM("qMetrics.tail_ptr+1 dump follows:");
     LogCE((qMetrics.tail_ptr + 1) % qMetrics.elements);
+    Timeouts::Expired(GetQId(), ms, budget);
     return false;
 }
 
@@ -342,9 +351,10 @@ CQ::DoReapInquiry(uint32_t ms, uint32_t numTil, uint32_t &numCE,
 
 
 bool
-CQ::ReapInquiryWaitSpecify(uint32_t ms, uint32_t numTil, uint32_t &numCE,
-    uint32_t &isrCount)
+CQ::ReapInquiryWaitSpecify(uint32_t budget, uint32_t numTil,
+    uint32_t &numCE, uint32_t &isrCount)
 {
+    uint32_t ms = Timeouts::Adapt(GetQId(), budget);
     bool result = DoReapInquiry(ms, numTil, numCE, isrCount);
 
     if (!result) {
@@ -359,6 +369,7 @@ CQ::ReapInquiryWaitSpecify(uint32_t ms, uint32_t numTil, uint32_t &numCE,
         LogCE((qMetrics.head_ptr + 1) % qMetrics.elements);
         LOG_NRM("qMetrics.tail_ptr+1 dump follows:");
         LogCE((qMetrics.tail_ptr + 1) % qMetrics.elements);
+        Timeouts::Expired(GetQId(), ms, budget);
     }
 
     return result;
@@ -369,6 +380,8 @@ bool
 CQ::ReapInquiryWaitSpecifyQ(uint32_t ms, uint32_t numTil, uint32_t &numCE,
     uint32_t &isrCount)
 {
+    // Callers poll quietly expecting timeouts, only ever extend their wait
+    ms = MAX(ms, Timeouts::Adapt(GetQId(), ms));
     return DoReapInquiry(ms, numTil, numCE, isrCount);
 }
 
@@ -426,13 +439,22 @@ CQ::Reap(uint32_t &ceRemain, SharedMemBufferPtr memBuffer, uint32_t &isrCount,
     reap.elements = ceDesire;
     reap.size = memBuffer->GetBufSize();
     reap.buffer = memBuffer->GetBuffer();
-    if ((rc = ioctl(mFd, NVME_IOCTL_REAP, &reap)) < 0) {
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_REAP, &reap)) < 0) {
         if (failOnIoctl)
             throw FrmwkEx(HERE, "Error during reaping CE's, rc = %d", rc);
         else
             LOG_ERR("Error during reaping CE's, rc = %d", rc);
     }
 
+    TNVME_PROBE3(cq_reap, reap.q_id, reap.num_reaped, reap.num_remaining);
+    for (uint32_t i = 0; i < reap.num_reaped; i++) {
+        union CE *ce = (union CE *)(memBuffer->GetBuffer() +
+            (i * GetEntrySize()));
+        TNVME_PROBE3(cq_reap_ce, ce->n.SQID, ce->n.CID,
+            (uint16_t)ce->n.SF.t.status);
+        Timeouts::Completed(ce->n.SQID, ce->n.CID);
+    }
+
     isrCount = reap.isr_count;
     ceRemain = reap.num_remaining;
     LOG_NRM("Reaped %d CE's, %d remain, from CQ %d, ISR count: %d",
@@ -451,7 +473,7 @@ CQ::Dump(DumpFilename filename, string fileHdr)
     Queue::Dump(filename, fileHdr);
 
     // Reopen the file and append the same data in a different format
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
+    if ((fp = DumpArchive::OpenDump(filename)) == NULL)
         throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
 
     fprintf(fp, "\nFurther decoding details of the above raw dump follow:\n");
@@ -469,7 +491,7 @@ CQ::Dump(DumpFilename filename, string fileHdr)
             fprintf(fp, "  %s\n", desc[j].c_str());
     }
 
-    fclose(fp);
+    DumpArchive::CloseDump(fp);
 }
 
 
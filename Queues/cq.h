@@ -131,6 +131,8 @@ public:
      * @param isrCount Returns the number of ISR's which fired and were counted
      *        that are assoc with this CQ. If this CQ does not use IRQ's, then
      *        this value will remain 0.
+     * @note Throws should an adaptive timeout shorter than ms expire, see
+     *       Timeouts::Expired()
      * @return true when CE's are awaiting to be reaped, otherwise a timeout
      */
     bool ReapInquiryWaitAny(uint32_t ms, uint32_t &numCE, uint32_t &isrCount);
@@ -144,6 +146,8 @@ public:
      * @param isrCount Returns the number of ISR's which fired and were counted
      *        that are assoc with this CQ. If this CQ does not use IRQ's, then
      *        this value will remain 0.
+     * @note Throws should an adaptive timeout shorter than ms expire, see
+     *       Timeouts::Expired()
      * @return true when CE's are awaiting to be reaped, otherwise a timeout
      */
     bool ReapInquiryWaitSpecify(uint32_t ms, uint32_t numTil, uint32_t &numCE,
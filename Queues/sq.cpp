@@ -16,7 +16,11 @@
 
 #include "sq.h"
 #include "globals.h"
+#include "timeouts.h"
+#include "writeShadow.h"
 #include "../Utils/kernelAPI.h"
+#include "../Utils/ioStats.h"
+#include "../Utils/probes.h"
 
 SharedSQPtr SQ::NullSQPtr;
 
@@ -39,6 +43,7 @@ SQ::SQ(int fd, Trackable::ObjType objBeingCreated) :
 
 SQ::~SQ()
 {
+    Timeouts::Forget(GetQId());
     // Cleanup duties for this Q's buffer
     if (GetIsContig()) {
         // Contiguous memory is alloc'd and owned by the kernel
@@ -94,7 +99,7 @@ SQ::Init(uint16_t qId, uint16_t entrySize, uint32_t numEntries, uint16_t cqId)
             "(%d, %d, %d, %d)", GetQId(), GetCqId(), GetEntrySize(),
             GetNumEntries());
 
-        if ((ret = ioctl(mFd, NVME_IOCTL_CREATE_ADMN_Q, &q)) < 0) {
+        if ((ret = IoStats::Ioctl(mFd, NVME_IOCTL_CREATE_ADMN_Q, &q)) < 0) {
             throw FrmwkEx(HERE, 
                 "Q Creation failed by dnvme with error: 0x%02X", ret);
         }
@@ -183,7 +188,7 @@ SQ::CreateIOSQ(struct nvme_prep_sq &q)
 {
     int ret;
 
-    if ((ret = ioctl(mFd, NVME_IOCTL_PREPARE_SQ_CREATION, &q)) < 0) {
+    if ((ret = IoStats::Ioctl(mFd, NVME_IOCTL_PREPARE_SQ_CREATION, &q)) < 0) {
         throw FrmwkEx(HERE, 
             "Q Creation failed by dnvme with error: 0x%02X", ret);
     }
@@ -202,7 +207,8 @@ SQ::GetQMetrics()
     getQMetrics.nBytes = sizeof(qMetrics);
     getQMetrics.buffer = (uint8_t *)&qMetrics;
 
-    if ((ret = ioctl(mFd, NVME_IOCTL_GET_Q_METRICS, &getQMetrics)) < 0) {
+    if ((ret = IoStats::Ioctl(mFd, NVME_IOCTL_GET_Q_METRICS,
+        &getQMetrics)) < 0) {
         throw FrmwkEx(HERE, 
             "Get Q metrics failed by dnvme with error: 0x%02X", ret);
     }
@@ -275,13 +281,24 @@ SQ::Send(SharedCmdPtr cmd, uint16_t &uniqueId)
 
     LOG_NRM("Send cmd opcode 0x%02X, payload size 0x%04X, to SQ id 0x%02X",
         cmd->GetOpcode(), io.data_buf_size, io.q_id);
+    WriteShadow::Sending((io.q_id == 0), cmd);
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_SEND_64B_CMD, &io)) < 0)
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_SEND_64B_CMD, &io)) < 0)
         throw FrmwkEx(HERE, "Error sending cmd, rc =%d", rc);
+    IoStats::CountCmd(io.data_buf_size,
+        ((cmd->GetDataDir() == DATADIR_TO_DEVICE) ||
+        (cmd->GetDataDir() == DATADIR_BIDIRECTIONAL)),
+        ((cmd->GetDataDir() == DATADIR_FROM_DEVICE) ||
+        (cmd->GetDataDir() == DATADIR_BIDIRECTIONAL)));
+
+    TNVME_PROBE4(sq_send, io.q_id, io.unique_id, cmd->GetOpcode(),
+        io.data_buf_size);
 
     // Allow tnvme to learn of the unique cmd ID which was assigned by dnvme
     uniqueId = io.unique_id;
     cmd->SetCID(io.unique_id);
+    Timeouts::Issued(io.q_id, GetCqId(), io.unique_id, cmd->GetOpcode(),
+        io.data_buf_size);
 }
 
 
@@ -292,6 +309,8 @@ SQ::Ring()
     uint16_t sqId = GetQId();
 
     LOG_NRM("Ring doorbell for SQ %d", sqId);
-    if ((rc = ioctl(mFd, NVME_IOCTL_RING_SQ_DOORBELL, sqId)) < 0)
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_RING_SQ_DOORBELL, sqId)) < 0)
         throw FrmwkEx(HERE, "Error ringing doorbell, rc =%d", rc);
+    TNVME_PROBE1(sq_ring, sqId);
+    Timeouts::Rung(sqId);
 }
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "timeouts.h"
+#include "../Exception/frmwkEx.h"
+
+bool Timeouts::mAdaptive = false;
+uint32_t Timeouts::mSeed_ms = DFLT_TIMEOUT_ms;
+std::map<uint32_t, Timeouts::Bucket> Timeouts::mBuckets;
+std::map<uint32_t, Timeouts::Pending> Timeouts::mPending;
+std::map<uint16_t, std::vector<uint32_t> > Timeouts::mUnrung;
+std::map<uint16_t, std::map<uint32_t, uint32_t> > Timeouts::mOutstanding;
+
+
+Timeouts::Timeouts()
+{
+}
+
+
+Timeouts::~Timeouts()
+{
+}
+
+
+void
+Timeouts::Init(bool adaptive, uint8_t capTO)
+{
+    mAdaptive = adaptive;
+    mSeed_ms = MAX((uint32_t)DFLT_TIMEOUT_ms, (capTO * TO_CAP_UNIT_ms));
+    LOG_NRM("Cmd timeouts: %s, seed for unlearned cmds = %d ms",
+        mAdaptive ? "adaptive" : "legacy", mSeed_ms);
+}
+
+
+uint32_t
+Timeouts::BucketKey(bool admin, uint8_t opcode, uint64_t dataSize)
+{
+    uint32_t sizeClass = 0;
+
+    while ((sizeClass < 63) && (((uint64_t)1 << sizeClass) < dataSize))
+        sizeClass++;
+    return (((uint32_t)admin << 16) | ((uint32_t)opcode << 8) | sizeClass);
+}
+
+
+void
+Timeouts::Drop(std::map<uint32_t, Pending>::iterator it)
+{
+    if (it->second.rung) {
+        std::map<uint32_t, uint32_t> &cq = mOutstanding[it->second.cqId];
+        std::map<uint32_t, uint32_t>::iterator bk = cq.find(it->second.bucket);
+        if ((bk != cq.end()) && (--bk->second == 0))
+            cq.erase(bk);
+    }
+    mPending.erase(it);
+}
+
+
+void
+Timeouts::Issued(uint16_t sqId, uint16_t cqId, uint16_t cid, uint8_t opcode,
+    uint64_t dataSize)
+{
+    Pending pend;
+    uint32_t key = (((uint32_t)sqId << 16) | cid);
+
+    // A CID reused before its CE was reaped replaces the lost cmd
+    std::map<uint32_t, Pending>::iterator it = mPending.find(key);
+    if (it != mPending.end())
+        Drop(it);
+
+    pend.bucket = BucketKey((sqId == 0), opcode, dataSize);
+    pend.cqId = cqId;
+    pend.rung = false;
+    mPending[key] = pend;
+    mUnrung[sqId].push_back(key);
+}
+
+
+void
+Timeouts::Rung(uint16_t sqId)
+{
+    struct timeval now;
+
+    std::vector<uint32_t> &unrung = mUnrung[sqId];
+    if (unrung.empty() || (gettimeofday(&now, NULL) != 0))
+        return;
+
+    for (size_t i = 0; i < unrung.size(); i++) {
+        std::map<uint32_t, Pending>::iterator it = mPending.find(unrung[i]);
+        if ((it == mPending.end()) || it->second.rung)
+            continue;
+        it->second.rung = true;
+        it->second.start = now;
+        mOutstanding[it->second.cqId][it->second.bucket]++;
+    }
+    unrung.clear();
+}
+
+
+void
+Timeouts::Completed(uint16_t sqId, uint16_t cid)
+{
+    struct timeval now;
+
+    std::map<uint32_t, Pending>::iterator it =
+        mPending.find(((uint32_t)sqId << 16) | cid);
+    if ((it == mPending.end()) || (gettimeofday(&now, NULL) != 0))
+        return;
+
+    if (it->second.rung) {
+        uint64_t lat_us =
+            ((uint64_t)(now.tv_sec - it->second.start.tv_sec) * 1000000) +
+            (now.tv_usec - it->second.start.tv_usec);
+        uint32_t bin = 0;
+        while (((bin + 1) < TO_HIST_BINS) && (((uint64_t)2 << bin) <= lat_us))
+            bin++;
+
+        Bucket &bucket = mBuckets[it->second.bucket];
+        bucket.numSamples++;
+        bucket.hist[bin]++;
+        bucket.max_us = MAX(bucket.max_us, lat_us);
+        bucket.p50_us = Percentile(bucket, 500);
+        bucket.p999_us = Percentile(bucket, 999);
+    }
+    Drop(it);
+}
+
+
+void
+Timeouts::Forget(uint16_t sqId)
+{
+    std::map<uint32_t, Pending>::iterator it =
+        mPending.lower_bound((uint32_t)sqId << 16);
+    while ((it != mPending.end()) && ((it->first >> 16) == sqId))
+        Drop(it++);
+    mUnrung.erase(sqId);
+}
+
+
+uint64_t
+Timeouts::Percentile(const Bucket &bucket, uint32_t perMille)
+{
+    uint64_t seen = 0;
+    uint64_t target = ((bucket.numSamples * perMille) + 999) / 1000;
+
+    for (uint32_t bin = 0; bin < TO_HIST_BINS; bin++) {
+        seen += bucket.hist[bin];
+        if (seen >= target)     // Report upper bound of the bin
+            return ((uint64_t)2 << bin);
+    }
+    return bucket.max_us;
+}
+
+
+uint32_t
+Timeouts::Adapt(uint16_t cqId, uint32_t budget_ms)
+{
+    uint32_t numCmds = 0;
+    uint64_t worst_us = 0;
+    uint64_t median_us = 0;
+
+    if (mAdaptive == false)
+        return budget_ms;
+
+    std::map<uint16_t, std::map<uint32_t, uint32_t> >::iterator cq =
+        mOutstanding.find(cqId);
+    if (cq == mOutstanding.end())
+        return budget_ms;
+
+    std::map<uint32_t, uint32_t>::iterator bk;
+    for (bk = cq->second.begin(); bk != cq->second.end(); bk++) {
+        const Bucket &bucket = mBuckets[bk->first];
+        if (bucket.numSamples < TO_MIN_SAMPLES)
+            return MAX(budget_ms, mSeed_ms);
+        numCmds += bk->second;
+        worst_us = MAX(worst_us, bucket.p999_us);
+        median_us = MAX(median_us, bucket.p50_us);
+    }
+    if (numCmds == 0)
+        return budget_ms;
+
+    // Allow the slowest bucket its tail latency plus queuing behind the rest
+    uint64_t chosen = TO_FLOOR_ms +
+        (((worst_us * TO_MARGIN) + (numCmds * median_us)) / 1000);
+    chosen = MIN(chosen, ((uint64_t)MAX(budget_ms, mSeed_ms) * TO_CEIL_MULT));
+
+    for (bk = cq->second.begin(); bk != cq->second.end(); bk++) {
+        Bucket &bucket = mBuckets[bk->first];
+        if ((bucket.minChosen_ms == 0) || (chosen < bucket.minChosen_ms))
+            bucket.minChosen_ms = chosen;
+        bucket.maxChosen_ms = MAX(bucket.maxChosen_ms, (uint32_t)chosen);
+    }
+    if (chosen != budget_ms) {
+        LOG_NRM("Adaptive timeout %d ms replaces %d ms for %d cmd(s) in CQ %d",
+            (uint32_t)chosen, budget_ms, numCmds, cqId);
+    }
+    return (uint32_t)chosen;
+}
+
+
+void
+Timeouts::Expired(uint16_t cqId, uint32_t waited_ms, uint32_t budget_ms)
+{
+    if (waited_ms >= budget_ms)
+        return;     // The caller's own expectations were honored
+
+    std::map<uint16_t, std::map<uint32_t, uint32_t> >::iterator cq =
+        mOutstanding.find(cqId);
+    if (cq != mOutstanding.end()) {
+        std::map<uint32_t, uint32_t>::iterator bk;
+        for (bk = cq->second.begin(); bk != cq->second.end(); bk++)
+            mBuckets[bk->first].numExpired++;
+    }
+    throw FrmwkEx(HERE, "Adaptive timeout of %d ms expired in CQ %d before "
+        "the %d ms budget; cmds exceeded %dx their learned p99.9 latency",
+        waited_ms, cqId, budget_ms, TO_MARGIN);
+}
+
+
+void
+Timeouts::Report()
+{
+    if (mAdaptive == false)
+        return;
+
+    LOG_NRM("Adaptive timeout SUMMARY, seed = %d ms:", mSeed_ms);
+    LOG_NRM("  %-5s %-6s %-10s %-10s %-10s %-10s %-10s %-12s %s", "Queue",
+        "Opcode", "Size(<=B)", "Samples", "p50(us)", "p99.9(us)", "Max(us)",
+        "Chosen(ms)", "Expired");
+
+    std::map<uint32_t, Bucket>::iterator it;
+    for (it = mBuckets.begin(); it != mBuckets.end(); it++) {
+        Bucket &bucket = it->second;
+        if (bucket.numSamples == 0)
+            continue;
+
+        char chosen[32] = "-";
+        if (bucket.maxChosen_ms) {
+            snprintf(chosen, sizeof(chosen), "%u..%u", bucket.minChosen_ms,
+                bucket.maxChosen_ms);
+        }
+        LOG_NRM("  %-5s 0x%02X   %-10llu %-10llu %-10llu %-10llu %-10llu %-12s "
+            "%u",
+            (it->first >> 16) ? "admin" : "nvm", (it->first >> 8) & 0xff,
+            (unsigned long long)((it->first & 0xff) ?
+            ((uint64_t)1 << (it->first & 0xff)) : 0),
+            (unsigned long long)bucket.numSamples,
+            (unsigned long long)bucket.p50_us,
+            (unsigned long long)bucket.p999_us,
+            (unsigned long long)bucket.max_us, chosen, bucket.numExpired);
+    }
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _TIMEOUTS_H_
+#define _TIMEOUTS_H_
+
+#include <map>
+#include <vector>
+#include <sys/time.h>
+#include "tnvme.h"
+
+/// Number of log2(usec) bins within each latency histogram
+#define TO_HIST_BINS                32
+/// Num of samples required before a bucket's latencies are trusted
+#define TO_MIN_SAMPLES              32
+/// Multiplier applied to the observed high percentile
+#define TO_MARGIN                   4
+/// Smallest adaptive timeout ever chosen
+#define TO_FLOOR_ms                 100
+/// Largest multiple of max(budget, seed) an adaptive timeout may extend to
+#define TO_CEIL_MULT                4
+/// Num of CAP.TO units per ms
+#define TO_CAP_UNIT_ms              500
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It learns the latency distribution of every (queue type,
+* opcode, data size) combination from cmds completing throughout the run and,
+* when cmd line option --adaptiveto is spec'd, uses it to choose how long a CQ
+* waits for its outstanding cmds. Callers continue to pass CALC_TIMEOUT_ms()
+* as their budget; CQ::ReapInquiryWait*() replaces that budget with a value
+* derived from the observed p99.9 latency once every outstanding cmd's bucket
+* has been sufficiently sampled. Until then the larger of the budget and the
+* CAP.TO seed is used. Thus hung cmds abort quickly while slow but healthy
+* cmds are not timed out prematurely. Without --adaptiveto the caller's
+* budget is always honored.
+*
+* The percentiles of every bucket and the rung cmds outstanding per CQ are
+* maintained as cmds are rung and completed, so choosing a timeout only
+* visits the few buckets of the CQ being waited upon.
+*
+* @note This class may throw exceptions, see Expired().
+*/
+class Timeouts
+{
+public:
+    Timeouts();
+    virtual ~Timeouts();
+
+    /**
+     * Establish the operating mode and the seed for unlearned cmds.
+     * @param adaptive Pass false to always honor the caller's budget as was
+     *      the legacy behavior, otherwise true to learn and adapt
+     * @param capTO Pass the CAP.TO field value, in 500ms units
+     */
+    static void Init(bool adaptive, uint8_t capTO);
+
+    /**
+     * Record a cmd which has just been sent into a SQ, but not yet rung.
+     * @param sqId Pass the SQ ID the cmd was sent into
+     * @param cqId Pass the CQ ID the cmd will be completed into
+     * @param cid Pass the unique cmd ID assigned by dnvme
+     * @param opcode Pass the cmd's opcode
+     * @param dataSize Pass the number of bytes of the cmd's data payload
+     */
+    static void Issued(uint16_t sqId, uint16_t cqId, uint16_t cid,
+        uint8_t opcode, uint64_t dataSize);
+
+    /**
+     * Stamp the start time of all cmds sent into the SQ since its last ring.
+     * @param sqId Pass the SQ ID whose doorbell was just rung
+     */
+    static void Rung(uint16_t sqId);
+
+    /**
+     * Account for a reaped CE, adding its latency to the histogram of its
+     * bucket; CE's for which no cmd was recorded are ignored.
+     * @param sqId Pass CE.SQID
+     * @param cid Pass CE.CID
+     */
+    static void Completed(uint16_t sqId, uint16_t cid);
+
+    /**
+     * Forget all outstanding cmds of the SQ, i.e. it is being deleted.
+     * @param sqId Pass the SQ ID being deleted
+     */
+    static void Forget(uint16_t sqId);
+
+    /**
+     * Choose the timeout to wait for the cmds outstanding in a CQ.
+     * @param cqId Pass the CQ ID about to be waited upon
+     * @param budget_ms Pass the timeout the caller requested
+     * @return the number of ms to wait
+     */
+    static uint32_t Adapt(uint16_t cqId, uint32_t budget_ms);
+
+    /**
+     * A wait upon a CQ has timed out. Should the adaptive timeout have been
+     * shorter than the caller's budget, the cmds did not fail within the
+     * caller's expectations, thus this is reported as a failure of its own.
+     * @note Throws when the wait was shortened by adaptation
+     * @param cqId Pass the CQ ID which was waited upon
+     * @param waited_ms Pass the timeout returned by Adapt()
+     * @param budget_ms Pass the timeout the caller requested
+     */
+    static void Expired(uint16_t cqId, uint32_t waited_ms, uint32_t budget_ms);
+
+    /**
+     * Log the learned latencies and chosen timeouts of every bucket.
+     */
+    static void Report();
+
+
+private:
+    struct Bucket {
+        uint64_t numSamples;
+        uint64_t hist[TO_HIST_BINS];    // Bin b counts [2^b, 2^(b+1)) usec
+        uint64_t max_us;
+        uint64_t p50_us;                // Updated with every sample
+        uint64_t p999_us;
+        uint32_t minChosen_ms;          // 0 indicates never chosen
+        uint32_t maxChosen_ms;
+        uint32_t numExpired;            // Shortened waits which timed out
+    };
+
+    struct Pending {
+        uint32_t bucket;                // Key into mBuckets
+        uint16_t cqId;
+        bool rung;
+        struct timeval start;
+    };
+
+    static bool mAdaptive;
+    static uint32_t mSeed_ms;
+    /// Key is (admin << 16) | (opcode << 8) | log2(data size)
+    static std::map<uint32_t, Bucket> mBuckets;
+    /// Key is (SQ ID << 16) | CID
+    static std::map<uint32_t, Pending> mPending;
+    /// Key is SQ ID, value is the mPending keys sent since the last ring
+    static std::map<uint16_t, std::vector<uint32_t> > mUnrung;
+    /// Key is CQ ID, value counts its rung cmds outstanding per bucket key
+    static std::map<uint16_t, std::map<uint32_t, uint32_t> > mOutstanding;
+
+    static uint32_t BucketKey(bool admin, uint8_t opcode, uint64_t dataSize);
+    static uint64_t Percentile(const Bucket &bucket, uint32_t perMille);
+    static void Drop(std::map<uint32_t, Pending>::iterator it);
+};
+
+
+#endif
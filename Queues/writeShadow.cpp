@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "writeShadow.h"
+#include "../Cmds/datasetMgmt.h"
+
+#define NVM_OPC_WRITE               0x01
+#define NVM_OPC_WRITE_UNCORRECT     0x04
+#define NVM_OPC_WRITE_ZEROES        0x08
+#define NVM_OPC_DATASET_MGMT        0x09
+#define ADMIN_OPC_NAMSPC_MGMT       0x0d
+#define ADMIN_OPC_FORMAT_NVM        0x80
+
+std::map<uint32_t, WriteShadow::RunMap> WriteShadow::mShadow;
+
+
+WriteShadow::WriteShadow()
+{
+}
+
+
+WriteShadow::~WriteShadow()
+{
+}
+
+
+void
+WriteShadow::Sending(bool admin, SharedCmdPtr cmd)
+{
+    uint32_t nsid = cmd->GetNSID();
+
+    if (admin) {
+        switch (cmd->GetOpcode()) {
+        case ADMIN_OPC_FORMAT_NVM:
+        case ADMIN_OPC_NAMSPC_MGMT:
+            Clear(nsid);
+            break;
+        }
+        return;
+    }
+
+    uint64_t slba = (((uint64_t)cmd->GetDword(11) << 32) | cmd->GetDword(10));
+    switch (cmd->GetOpcode()) {
+    case NVM_OPC_WRITE:
+    case NVM_OPC_WRITE_UNCORRECT:
+    case NVM_OPC_WRITE_ZEROES:
+        Forget(nsid, slba, (cmd->GetWord(12, 0) + 1));
+        break;
+
+    case NVM_OPC_DATASET_MGMT:
+        if (cmd->GetBit(11, 2)) {       // Attribute-Deallocate
+            const RangeDef *range = (const RangeDef *)cmd->GetROPrpBuffer();
+            uint32_t nr = (cmd->GetByte(10, 0) + 1);
+            if (range == NULL)
+                break;
+            nr = MIN(nr, (cmd->GetPrpBufferSize() / sizeof(RangeDef)));
+            for (uint32_t i = 0; i < nr; i++)
+                Forget(nsid, range[i].slba, range[i].length);
+        }
+        break;
+    }
+}
+
+
+void
+WriteShadow::Record(uint32_t nsid, uint64_t slba, uint64_t nlb,
+    uint64_t seed, uint32_t generation)
+{
+    if (nlb == 0)
+        return;
+
+    Forget(nsid, slba, nlb);
+    RunMap &runs = mShadow[nsid];
+    Run run = { nlb, seed, generation };
+
+    // Coalesce with the neighboring runs when they share the key
+    RunMap::iterator next = runs.lower_bound(slba);
+    if (next != runs.begin()) {
+        RunMap::iterator prev = next;
+        --prev;
+        if (((prev->first + prev->second.nlb) == slba) &&
+            (prev->second.seed == seed) &&
+            (prev->second.generation == generation)) {
+
+            slba = prev->first;
+            run.nlb += prev->second.nlb;
+            runs.erase(prev);
+        }
+    }
+    if ((next != runs.end()) && (next->first == (slba + run.nlb)) &&
+        (next->second.seed == seed) &&
+        (next->second.generation == generation)) {
+
+        run.nlb += next->second.nlb;
+        runs.erase(next);
+    }
+    runs[slba] = run;
+}
+
+
+void
+WriteShadow::Forget(uint32_t nsid, uint64_t slba, uint64_t nlb)
+{
+    if (nsid == SHADOW_ALL_NAMSPC) {
+        for (std::map<uint32_t, RunMap>::iterator ns = mShadow.begin();
+            ns != mShadow.end(); ns++) {
+            Forget(ns->first, slba, nlb);
+        }
+        return;
+    }
+
+    std::map<uint32_t, RunMap>::iterator ns = mShadow.find(nsid);
+    if ((ns == mShadow.end()) || (nlb == 0))
+        return;
+
+    RunMap &runs = ns->second;
+    uint64_t elba = (slba + nlb);
+    RunMap::iterator it = runs.lower_bound(slba);
+
+    // The run preceding slba may extend into the range
+    if (it != runs.begin()) {
+        RunMap::iterator prev = it;
+        --prev;
+        uint64_t prevEnd = (prev->first + prev->second.nlb);
+        if (prevEnd > slba) {
+            prev->second.nlb = (slba - prev->first);
+            if (prevEnd > elba) {
+                Run tail = prev->second;
+                tail.nlb = (prevEnd - elba);
+                runs[elba] = tail;
+                return;
+            }
+        }
+    }
+
+    while ((it != runs.end()) && (it->first < elba)) {
+        uint64_t runEnd = (it->first + it->second.nlb);
+        if (runEnd > elba) {
+            Run tail = it->second;
+            tail.nlb = (runEnd - elba);
+            runs.erase(it);
+            runs[elba] = tail;
+            break;
+        }
+        runs.erase(it++);
+    }
+}
+
+
+void
+WriteShadow::Clear(uint32_t nsid)
+{
+    if (nsid == SHADOW_ALL_NAMSPC)
+        mShadow.clear();
+    else
+        mShadow.erase(nsid);
+}
+
+
+bool
+WriteShadow::Lookup(uint32_t nsid, uint64_t lba, uint64_t &seed,
+    uint32_t &generation, uint64_t &runLen)
+{
+    runLen = 0;
+    std::map<uint32_t, RunMap>::iterator ns = mShadow.find(nsid);
+    if (ns == mShadow.end())
+        return false;
+
+    RunMap &runs = ns->second;
+    RunMap::iterator it = runs.upper_bound(lba);
+    if (it != runs.end())
+        runLen = (it->first - lba);     // Unknown until the next run
+
+    if (it != runs.begin()) {
+        --it;
+        if ((it->first + it->second.nlb) > lba) {
+            seed = it->second.seed;
+            generation = it->second.generation;
+            runLen = ((it->first + it->second.nlb) - lba);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void
+WriteShadow::Report()
+{
+    for (std::map<uint32_t, RunMap>::iterator ns = mShadow.begin();
+        ns != mShadow.end(); ns++) {
+
+        uint64_t numLBA = 0;
+        for (RunMap::iterator it = ns->second.begin();
+            it != ns->second.end(); it++) {
+            numLBA += it->second.nlb;
+        }
+        LOG_NRM("Write shadow: NSID %d, %lld LBA's known in %ld runs",
+            ns->first, (long long)numLBA, (long)ns->second.size());
+    }
+}
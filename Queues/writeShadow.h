@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _WRITESHADOW_H_
+#define _WRITESHADOW_H_
+
+#include <map>
+#include "tnvme.h"
+#include "../Cmds/cmd.h"
+
+/// NSID which addresses every namspc
+#define SHADOW_ALL_NAMSPC           0xffffffff
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It remembers, per namspc, which (seed, generation) of the
+* LbaPattern data pattern each LBA was last successfully written with, so
+* that a read issued by any test, in any group or --loop iteration, can be
+* verified against what was last written. LBA's whose content is unknown,
+* i.e. written by other patterns, deallocated, formatted, or with a write
+* still in flight, are simply absent. Consecutive LBA's sharing a key are run
+* length encoded, thus a sequentially filled multi-TB namspc costs a handful
+* of map entries. The shadow only lives in memory for the duration of the
+* tnvme process; separate runs start knowing nothing about the media.
+*
+* @note This class will not throw exceptions.
+*/
+class WriteShadow
+{
+public:
+    WriteShadow();
+    virtual ~WriteShadow();
+
+    /**
+     * Forget the content of any LBA's a cmd is about to modify; called for
+     * every cmd sent into any SQ. Covers write, write uncorrectable, write
+     * zeroes, dataset mgmt w/ deallocate, format NVM and namspc mgmt.
+     * @param admin Pass true if the cmd is being sent into the ASQ
+     * @param cmd Pass the cmd being sent
+     */
+    static void Sending(bool admin, SharedCmdPtr cmd);
+
+    /**
+     * Remember a range of LBA's now holds the LbaPattern of a key.
+     * @param nsid Pass the namspc the LBA's reside within
+     * @param slba Pass the 1st LBA of the range
+     * @param nlb Pass the 1-based number of LBA's in the range
+     * @param seed Pass the key's seed
+     * @param generation Pass the key's generation
+     */
+    static void Record(uint32_t nsid, uint64_t slba, uint64_t nlb,
+        uint64_t seed, uint32_t generation);
+
+    /**
+     * Forget the content of a range of LBA's.
+     * @param nsid Pass the namspc the LBA's reside within
+     * @param slba Pass the 1st LBA of the range
+     * @param nlb Pass the 1-based number of LBA's in the range
+     */
+    static void Forget(uint32_t nsid, uint64_t slba, uint64_t nlb);
+
+    /**
+     * Forget the content of an entire namspc.
+     * @param nsid Pass the namspc, or SHADOW_ALL_NAMSPC
+     */
+    static void Clear(uint32_t nsid);
+
+    /**
+     * Lookup the key an LBA was last written with.
+     * @param nsid Pass the namspc the LBA resides within
+     * @param lba Pass the LBA to lookup
+     * @param seed Returns the key's seed, if known
+     * @param generation Returns the key's generation, if known
+     * @param runLen Returns the num of LBA's, starting at lba, which are
+     *      known to share this key if true is returned, otherwise the num
+     *      of LBA's, starting at lba, whose content is unknown; 0 implies
+     *      all remaining LBA's of the namspc are unknown.
+     * @return true if the content of the LBA is known, otherwise false
+     */
+    static bool Lookup(uint32_t nsid, uint64_t lba, uint64_t &seed,
+        uint32_t &generation, uint64_t &runLen);
+
+    /**
+     * Log the size of the map of every namspc.
+     */
+    static void Report();
+
+
+private:
+    struct Run {
+        uint64_t nlb;
+        uint64_t seed;
+        uint32_t generation;
+    };
+
+    /// Key is the 1st LBA of each run; runs never overlap
+    typedef std::map<uint64_t, Run> RunMap;
+
+    /// Key is NSID
+    static std::map<uint32_t, RunMap> mShadow;
+};
+
+
+#endif
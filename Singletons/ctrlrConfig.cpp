@@ -17,6 +17,8 @@
 #include "ctrlrConfig.h"
 #include "globals.h"
 #include "../Exception/frmwkEx.h"
+#include "../Utils/ioStats.h"
+#include "../Utils/probes.h"
 
 const uint16_t CtrlrConfig::MAX_MSI_SINGLE_IRQ_VEC = 0;
 const uint16_t CtrlrConfig::MAX_MSI_MULTI_IRQ_VEC = 31;
@@ -122,7 +124,7 @@ CtrlrConfig::GetIrqScheme(enum nvme_irq_type &irq, uint16_t &numIrqs)
 {
     public_metrics_dev state;
 
-    if (ioctl(mFd, NVME_IOCTL_GET_DEVICE_METRICS, &state) < 0) {
+    if (IoStats::Ioctl(mFd, NVME_IOCTL_GET_DEVICE_METRICS, &state) < 0) {
         LOG_ERR("Unable to get IRQ scheme");
         return false;
     }
@@ -158,7 +160,7 @@ CtrlrConfig::SetIrqScheme(enum nvme_irq_type newIrq, uint16_t numIrqs)
     struct interrupts state;
     state.irq_type = newIrq;
     state.num_irqs = numIrqs;
-    if (ioctl(mFd, NVME_IOCTL_SET_IRQ, &state) < 0) {
+    if (IoStats::Ioctl(mFd, NVME_IOCTL_SET_IRQ, &state) < 0) {
         LOG_ERR("%s", irqDesc.c_str());
         return false;
     }
@@ -233,12 +235,15 @@ CtrlrConfig::SetState(enum nvme_state state)
     }
 
     LOG_NRM("%s the NVME device", toState.c_str());
-    if (ioctl(mFd, NVME_IOCTL_DEVICE_STATE, state) < 0) {
+    TNVME_PROBE1(ctrlr_set_state, (int)state);
+    if (IoStats::Ioctl(mFd, NVME_IOCTL_DEVICE_STATE, state) < 0) {
+        TNVME_PROBE2(ctrlr_set_state_done, (int)state, 0);
         LOG_ERR("Could not set state, currently %s",
             IsStateEnabled() ? "enabled" : "disabled");
         LOG_NRM("dnvme waits a TO period for CC.RDY to indicate ready" );
         return false;
     }
+    TNVME_PROBE2(ctrlr_set_state_done, (int)state, 1);
 
     // The state of the ctrlr is important to many objects
     Notify(state);
@@ -17,11 +17,39 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/syscall.h>
 #include "memBuffer.h"
 #include "../Utils/buffers.h"
+#include "../Utils/ioStats.h"
+#include "../Utils/probes.h"
 #include "../Exception/frmwkEx.h"
 
+// Avoid a dependency upon libnuma, only mbind(2) is needed
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED              1
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE                (1 << 1)
+#endif
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT              26
+#endif
+
+#define HUGEPAGE_2MB                (2UL * 1024 * 1024)
+#define HUGEPAGE_1GB                (1024UL * 1024 * 1024)
+// A hugepage is only used when the buffer fills at least 1/32 of it
+#define HUGEPAGE_MIN_FILL_SHIFT     5
+#define MAX_NUMA_NODES              1024
+
 SharedMemBufferPtr MemBuffer::NullMemBufferPtr;
+MemPolicy MemBuffer::mPolicy = { false, false, false, false, false };
+int MemBuffer::mNumaNode = -1;
+bool MemBuffer::mHugeWarned = false;
 
 
 MemBuffer::MemBuffer() : Trackable(Trackable::OBJ_MEMBUFFER)
@@ -50,24 +78,36 @@ MemBuffer::~MemBuffer()
 void
 MemBuffer::InitMemberVariables()
 {
-    mAllocByNewOperator = true;
+    mAllocType = ALLOC_NEW;
+    mRealBufSize = 0;
     mRealBaseAddr = NULL;
     mVirBaseAddr = NULL;
     mVirBufSize = 0;
     mAlignment = 0;
+    mRegistered = false;
+    mLocked = false;
 }
 
 
 void
 MemBuffer::DeallocateResources()
 {
-    // Either new or posix_memalign() was used to allocate memory
-    if (mAllocByNewOperator) {
-        if (mRealBaseAddr)
+    if (mLocked)
+        munlock(mRealBaseAddr, mRealBufSize);
+
+    // Either new, posix_memalign() or mmap() was used to allocate memory
+    if (mRealBaseAddr) {
+        switch (mAllocType) {
+        case ALLOC_NEW:
             delete [] mRealBaseAddr;
-    } else {
-        if (mRealBaseAddr)
+            break;
+        case ALLOC_MEMALIGN:
             free(mRealBaseAddr);
+            break;
+        case ALLOC_MMAP:
+            ::munmap(mRealBaseAddr, mRealBufSize);
+            break;
+        }
     }
     InitMemberVariables();
 }
@@ -77,7 +117,6 @@ void
 MemBuffer::InitOffset1stPage(uint32_t bufSize, uint32_t offset1stPg,
     bool initMem, uint8_t initVal)
 {
-    int err;
     uint32_t realBufSize;
     uint32_t align = sysconf(_SC_PAGESIZE);
 
@@ -85,27 +124,24 @@ MemBuffer::InitOffset1stPage(uint32_t bufSize, uint32_t offset1stPg,
     LOG_NRM(
         "Init buffer; size: 0x%08X, offset: 0x%08X, init: %d, value: 0x%02X",
         bufSize, offset1stPg, initMem, initVal);
+    TNVME_PROBE2(membuffer_init, bufSize, align);
     if (offset1stPg % sizeof(uint32_t) != 0) {
         throw FrmwkEx(HERE, "Offset into page 1 not aligned to: 0x%02lX",
             sizeof(uint32_t));
     }
 
-    // Support resizing/reallocation
-    if (mRealBaseAddr != NULL)
-        DeallocateResources();
-    mAllocByNewOperator = false;  // using posix_memalign()
-
     // All memory is allocated page aligned, offsets into the 1st page requires
     // asking for more memory than the caller desires and then tracking the
     // virtual pointer into the real allocation as a side affect.
-    mVirBufSize = bufSize;
     realBufSize = (bufSize + offset1stPg);
-    err = posix_memalign((void **)&mRealBaseAddr, align, realBufSize);
-    if (err) {
-        InitMemberVariables();
-        throw FrmwkEx(HERE, "Memory allocation failed with error code: 0x%02X",
-            err);
+
+    // Support resizing/reallocation
+    if (ReuseOrRelease(realBufSize, align) == false) {
+        AllocatePolicy(realBufSize, align);
+        if (mRegistered)
+            Pin();
     }
+    mVirBufSize = bufSize;
     mVirBaseAddr = (mRealBaseAddr + offset1stPg);
     if (offset1stPg)
         mAlignment = offset1stPg;
@@ -121,27 +157,21 @@ void
 MemBuffer::InitAlignment(uint32_t bufSize, uint32_t align, bool initMem,
     uint8_t initVal, volatile uint8_t *srcBuffer)
 {
-    int err;
-
     LOG_NRM("Init buffer; size: 0x%08X, align: 0x%08X, init: %d, value: 0x%02X",
         bufSize, align, initMem, initVal);
+    TNVME_PROBE2(membuffer_init, bufSize, align);
     if (align % sizeof(void *) != 0) {
         throw FrmwkEx(HERE, "Req'd alignment 0x%08X, is not modulo 0x%02lX",
             align, sizeof(void *));
     }
 
     // Support resizing/reallocation
-    if (mRealBaseAddr != NULL)
-        DeallocateResources();
-    mAllocByNewOperator = false;  // using posix_memalign()
-
-    mVirBufSize = bufSize;
-    err = posix_memalign((void **)&mRealBaseAddr, align, mVirBufSize);
-    if (err) {
-        InitMemberVariables();
-        throw FrmwkEx(HERE, "Memory allocation failed with error code: 0x%02X",
-            err);
+    if (ReuseOrRelease(bufSize, align) == false) {
+        AllocatePolicy(bufSize, align);
+        if (mRegistered)
+            Pin();
     }
+    mVirBufSize = bufSize;
     mVirBaseAddr = mRealBaseAddr;
     mAlignment = align;
 
@@ -163,26 +193,203 @@ MemBuffer::Init(uint32_t bufSize, bool initMem, uint8_t initVal)
 {
     LOG_NRM("Init buffer; size: 0x%08X, init: %d, value: 0x%02X",
         bufSize, initMem, initVal);
+    TNVME_PROBE2(membuffer_init, bufSize, 0);
 
     // Support resizing/reallocation
-    if (mRealBaseAddr != NULL)
-        DeallocateResources();
-    mAllocByNewOperator = true;
-
-    mVirBufSize = bufSize;
-    mRealBaseAddr = new (nothrow) uint8_t[mVirBufSize];
-    if (mRealBaseAddr == NULL) {
-        InitMemberVariables();
-        throw FrmwkEx(HERE, "Memory allocation failed");
+    if (ReuseOrRelease(bufSize, 0)) {
+        mAlignment = (mPolicy.req ? sizeof(void *) : 0);
+    } else if (mPolicy.req) {
+        // No alignment is promised, so honoring the policy costs nothing
+        AllocatePolicy(bufSize, sizeof(void *));
+        mAlignment = sizeof(void *);
+    } else {
+        bool registered = mRegistered;
+        mRealBaseAddr = new (nothrow) uint8_t[bufSize];
+        if (mRealBaseAddr == NULL) {
+            InitMemberVariables();
+            throw FrmwkEx(HERE, "Memory allocation failed");
+        }
+        mAllocType = ALLOC_NEW;
+        mRealBufSize = bufSize;
+        mAlignment = 0;
+        mRegistered = registered;
+        IoStats::CountAlloc(mRealBufSize);
     }
+    if (mRegistered && (mLocked == false))
+        Pin();
+    mVirBufSize = bufSize;
     mVirBaseAddr = mRealBaseAddr;
-    mAlignment = 0;
 
     if (initMem)
         memset(mVirBaseAddr, initVal, mVirBufSize);
 }
 
 
+bool
+MemBuffer::ReuseOrRelease(size_t realSize, uint32_t align)
+{
+    bool registered = mRegistered;
+
+    if (mRealBaseAddr == NULL)
+        return false;
+
+    if (registered && (realSize <= mRealBufSize) &&
+        ((align == 0) || (((uintptr_t)mRealBaseAddr % align) == 0))) {
+        LOG_NRM("Reusing registered allocation of 0x%08lX bytes",
+            mRealBufSize);
+        return true;
+    }
+
+    DeallocateResources();
+    mRegistered = registered;
+    return false;
+}
+
+
+void
+MemBuffer::Pin()
+{
+    if (mLocked || (mRealBaseAddr == NULL))
+        return;
+
+    if (mlock(mRealBaseAddr, mRealBufSize) != 0) {
+        LOG_WARN("Unable to pin 0x%08lX bytes, see RLIMIT_MEMLOCK: %s",
+            mRealBufSize, strerror(errno));
+        return;
+    }
+    mLocked = true;
+}
+
+
+void
+MemBuffer::Register()
+{
+    if (mRealBaseAddr == NULL)
+        throw FrmwkEx(HERE, "Registering a buffer requires an allocation");
+
+    mRegistered = true;
+    Pin();
+}
+
+
+void
+MemBuffer::SetAllocPolicy(const MemPolicy &policy, string device)
+{
+    mPolicy = policy;
+    mNumaNode = -1;
+    mHugeWarned = false;
+    if (mPolicy.req == false)
+        return;
+
+    LOG_NRM("Memory policy: huge2MB=%d, huge1GB=%d, numa=%d, prefault=%d",
+        mPolicy.huge2MB, mPolicy.huge1GB, mPolicy.numa, mPolicy.prefault);
+    if (mPolicy.numa) {
+        if ((mNumaNode = GetDeviceNumaNode(device)) < 0) {
+            LOG_WARN("NUMA node of %s is unknown, not binding memory",
+                device.c_str());
+        } else {
+            LOG_NRM("Binding memory to NUMA node %d of %s", mNumaNode,
+                device.c_str());
+        }
+    }
+}
+
+
+int
+MemBuffer::GetDeviceNumaNode(string device)
+{
+    struct stat devStat;
+    char sysfs[128];
+    int node = -1;
+
+    // /sys/dev/char/<major>:<minor> links to the device regardless of which
+    // class the driver registered the char device under.
+    if ((stat(device.c_str(), &devStat) != 0) || !S_ISCHR(devStat.st_mode))
+        return -1;
+    snprintf(sysfs, sizeof(sysfs), "/sys/dev/char/%u:%u/device/numa_node",
+        major(devStat.st_rdev), minor(devStat.st_rdev));
+
+    FILE *fp = fopen(sysfs, "r");
+    if (fp == NULL)
+        return -1;
+    if ((fscanf(fp, "%d", &node) != 1) || (node >= MAX_NUMA_NODES))
+        node = -1;
+    fclose(fp);
+    return node;
+}
+
+
+void
+MemBuffer::AllocatePolicy(size_t size, uint32_t align)
+{
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t hugeSize = 0;
+    int hugeShift = 0;
+
+    mRealBaseAddr = NULL;
+    if (mPolicy.huge1GB &&
+        (size >= (HUGEPAGE_1GB >> HUGEPAGE_MIN_FILL_SHIFT))) {
+        hugeSize = HUGEPAGE_1GB;
+        hugeShift = 30;
+    } else if (mPolicy.huge2MB &&
+        (size >= (HUGEPAGE_2MB >> HUGEPAGE_MIN_FILL_SHIFT))) {
+        hugeSize = HUGEPAGE_2MB;
+        hugeShift = 21;
+    }
+
+    if (hugeSize) {
+        size_t len = (((size + hugeSize - 1) / hugeSize) * hugeSize);
+        void *addr = ::mmap(NULL, len, (PROT_READ | PROT_WRITE),
+            (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+            (hugeShift << MAP_HUGE_SHIFT)), -1, 0);
+        if (addr != MAP_FAILED) {
+            mRealBaseAddr = (uint8_t *)addr;
+            mRealBufSize = len;
+            mAllocType = ALLOC_MMAP;
+        } else if (mHugeWarned == false) {
+            LOG_WARN("Unable to map %ld byte hugepages, using regular pages",
+                hugeSize);
+            mHugeWarned = true;
+        }
+    }
+
+    if (mRealBaseAddr == NULL) {
+        // mbind(2) operates upon whole pages, never share them with others
+        if (mPolicy.numa && (mNumaNode >= 0)) {
+            align = MAX(align, pageSize);
+            size = (((size + pageSize - 1) / pageSize) * pageSize);
+        }
+        int err = posix_memalign((void **)&mRealBaseAddr, align, size);
+        if (err) {
+            InitMemberVariables();
+            throw FrmwkEx(HERE,
+                "Memory allocation failed with error code: 0x%02X", err);
+        }
+        mRealBufSize = size;
+        mAllocType = ALLOC_MEMALIGN;
+    }
+    IoStats::CountAlloc(mRealBufSize);
+
+    if (mPolicy.numa && (mNumaNode >= 0)) {
+        unsigned long nodeMask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))];
+        memset(nodeMask, 0, sizeof(nodeMask));
+        nodeMask[mNumaNode / (8 * sizeof(unsigned long))] |=
+            (1UL << (mNumaNode % (8 * sizeof(unsigned long))));
+        if (syscall(SYS_mbind, mRealBaseAddr, mRealBufSize, MPOL_PREFERRED,
+            nodeMask, MAX_NUMA_NODES, MPOL_MF_MOVE) != 0) {
+            LOG_WARN("Unable to bind memory to NUMA node %d", mNumaNode);
+        }
+    }
+
+    // Fault every page in now so the 1st DMA doesn't pay for it
+    if (mPolicy.prefault) {
+        size_t step = (mAllocType == ALLOC_MMAP) ? hugeSize : pageSize;
+        for (size_t i = 0; i < mRealBufSize; i += step)
+            ((volatile uint8_t *)mRealBaseAddr)[i] = 0;
+    }
+}
+
+
 uint8_t
 MemBuffer::GetAt(size_t offset)
 {
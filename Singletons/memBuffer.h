@@ -54,6 +54,19 @@ public:
     /// Used to compare for NULL pointers being returned by allocations
     static SharedMemBufferPtr NullMemBufferPtr;
 
+    /**
+     * Select how all subsequent page aligned allocations are backed. The
+     * policy applies to InitOffset1stPage(), InitAlignment() and also to
+     * Init() whenever any policy is requested, thus every PRP payload and
+     * discontiguous queue picks it up. Hugepages are only used for buffers
+     * large enough to warrant them and silently fall back to regular pages
+     * when the system has none reserved.
+     * @param policy Pass the policy as parsed from the cmd line
+     * @param device Pass the device node, i.e. /dev/nvme0, whose NUMA node
+     *        will be learned from sysfs when NUMA binding is requested
+     */
+    static void SetAllocPolicy(const MemPolicy &policy, string device);
+
     /**
      * Allocates memory allowing to specify an offset into the 1st page of
      * allocated memory, and thus also the alignment of that buffer. More memory
@@ -109,6 +122,18 @@ public:
     uint32_t GetBufSize() { return mVirBufSize; }
     uint32_t GetAlignment() { return mAlignment; }
 
+    /**
+     * Register this buffer for repetitive I/O. Every subsequent Init*()
+     * whose size and alignment fit within the current allocation reuses it
+     * rather than freeing and allocating anew. Loops which resize the same
+     * payload thousands of times should Init*() the largest size once, then
+     * register. The allocation is also kept resident with mlock(2), however
+     * dnvme still pins the user pages and builds the PRP list for every cmd.
+     * Should the allocation have to grow, the new one is locked as well.
+     * @note Locking failures, i.e. RLIMIT_MEMLOCK, only cause a warning
+     */
+    void Register();
+
     /**
      * Write a data pattern to a segment of the data buffer. This segment
      * is defined by the offset from the start of the data buffer and
@@ -154,14 +179,52 @@ public:
 
 
 private:
-    bool mAllocByNewOperator;
-    uint8_t *mRealBaseAddr;     // System address returned by posix_memalign()
+    typedef enum {
+        ALLOC_NEW,              // new operator
+        ALLOC_MEMALIGN,         // posix_memalign()
+        ALLOC_MMAP              // mmap() of hugepages
+    } AllocType;
+
+    static MemPolicy mPolicy;
+    static int mNumaNode;       // -1 indicates no NUMA affinity is known
+    static bool mHugeWarned;
+
+    AllocType mAllocType;
+    size_t mRealBufSize;        // Num bytes backing mRealBaseAddr
+    uint8_t *mRealBaseAddr;     // System address returned by allocator
     uint8_t *mVirBaseAddr;      // User buffer address to satisfy mOffset1stPg
     uint32_t mVirBufSize;       // User request buffer size
     uint32_t mAlignment;
+    bool mRegistered;           // Reuse allocations which fit, keep pinned
+    bool mLocked;               // mlock(2) succeeded upon mRealBaseAddr
 
     void InitMemberVariables();
     void DeallocateResources();
+
+    /**
+     * Allocate page aligned memory according to the policy established by
+     * SetAllocPolicy(), sets mRealBaseAddr, mRealBufSize and mAllocType.
+     * @param size Pass the number of bytes to allocate
+     * @param align Pass the alignment requirements of the allocation
+     */
+    void AllocatePolicy(size_t size, uint32_t align);
+
+    /**
+     * Decide whether a registered allocation satisfies a new request, else
+     * release it while remembering the registration.
+     * @param realSize Pass the number of bytes the request requires
+     * @param align Pass the alignment the request requires, 0 implies none
+     * @return true if the existing allocation is to be reused
+     */
+    bool ReuseOrRelease(size_t realSize, uint32_t align);
+    void Pin();
+
+    /**
+     * Read the NUMA node of the PCI device backing the spec'd char device.
+     * @param device Pass the device node, i.e. /dev/nvme0
+     * @return The NUMA node, -1 if unknown or the platform is not NUMA
+     */
+    static int GetDeviceNumaNode(string device);
 };
 
 
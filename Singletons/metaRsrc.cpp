@@ -17,6 +17,7 @@
 #include "metaRsrc.h"
 #include "../Utils/kernelAPI.h"
 #include "../Exception/frmwkEx.h"
+#include "../Utils/ioStats.h"
 
 
 MetaRsrc::MetaRsrc()
@@ -56,7 +57,8 @@ MetaRsrc::SetMetaAllocSize(uint32_t allocSize)
         LOG_ERR("Requested meta data alloc size is not modulo %ld",
             sizeof(uint32_t));
         return false;
-    } else if ((rc = ioctl(mFd, NVME_IOCTL_METABUF_CREATE, allocSize)) < 0) {
+    } else if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_METABUF_CREATE,
+        allocSize)) < 0) {
         LOG_ERR("Meta data size request denied with error: %d", rc);
         return false;
     }
@@ -70,88 +72,102 @@ MetaRsrc::SetMetaAllocSize(uint32_t allocSize)
 bool
 MetaRsrc::ReserveMetaBuf(MetaDataBuf &metaBuf)
 {
-    int rc;
-    metaBuf.ID = 0;
-    metaBuf.size = mMetaAllocSize;
-    deque<MetaDataBuf>::iterator resIter = mMetaReserved.begin();
-    deque<MetaDataBuf>::iterator relIter = mMetaReleased.begin();
-
-
-    // If meta buffers were previously alloc'd and then subsequently released,
-    // we can quickly turn them back into usability again; saves calls to dnvme
-    if (relIter != mMetaReleased.end()) {
-        // Search the ordered elements for a place to insert into Reserved
-        while (resIter != mMetaReserved.end()) {
-            if ((*resIter).ID > (*relIter).ID)
-                break;
-            resIter++;
+    if (mMetaFree.empty()) {
+        if (mMetaAllocSize == 0) {
+            LOG_ERR("Meta data alloc size has not been set");
+            return false;
+        } else if (GrowMetaBuf(METADATA_SLAB_BUFS) == 0) {
+            return false;
         }
+    }
+
+    uint32_t id = mMetaFree.back();
+    mMetaFree.pop_back();
+    mMetaInUse[id] = true;
+    metaBuf = mMetaAllocated[id];
+    LOG_NRM("Alloc meta data buf: size: 0x%08X, ID: 0x%06X",
+        metaBuf.size, metaBuf.ID);
+    return true;
+}
 
-        metaBuf = *relIter;
-        LOG_NRM("Alloc meta data buf: size: 0x%08X, ID: 0x%06X",
-            metaBuf.size, metaBuf.ID);
 
-        mMetaReserved.insert(resIter, metaBuf);
-        mMetaReleased.erase(relIter);
+bool
+MetaRsrc::PreallocMetaBuf(uint32_t numBufs)
+{
+    if (mMetaAllocSize == 0) {
+        LOG_ERR("Meta data alloc size has not been set");
+        return false;
+    } else if (numBufs <= mMetaFree.size()) {
         return true;
+    }
+
+    // Bufs already reserved by others aren't available to the caller
+    uint32_t needed = (numBufs - mMetaFree.size());
+    if (GrowMetaBuf(needed) != needed) {
+        LOG_ERR("Unable to preallocate %d meta data bufs", numBufs);
+        return false;
+    }
+    return true;
+}
+
 
-    } else {
-        // Search the ordered elements, need to find a unique ID
-        while (resIter != mMetaReserved.end()) {
-            if ((*resIter).ID == metaBuf.ID)
-                metaBuf.ID++;
-            else if ((*resIter).ID > metaBuf.ID)
-                break;
-            resIter++;
+uint32_t
+MetaRsrc::GrowMetaBuf(uint32_t numBufs)
+{
+    int rc;
+    uint32_t added;
+    MetaDataBuf metaBuf;
+
+    metaBuf.size = mMetaAllocSize;
+    for (added = 0; added < numBufs; added++) {
+        // Is the next ID within dnvme's max allowed range?
+        metaBuf.ID = mMetaAllocated.size();
+        if (metaBuf.ID >= (1 << METADATA_UNIQUE_ID_BITS))
+            break;
+
+        // Request dnvme to reserve us some contiguous memory
+        if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_METABUF_ALLOC,
+            metaBuf.ID)) < 0) {
+            throw FrmwkEx(HERE,
+                "Meta data alloc request denied with error: %d", rc);
         }
 
-        // Is the found ID within dnvme's max allowed range?
-        if (metaBuf.ID < (1 << METADATA_UNIQUE_ID_BITS)) {
-            LOG_NRM("Alloc meta data buf: size: 0x%08X, ID: 0x%06X",
-                metaBuf.size, metaBuf.ID);
-
-            // Request dnvme to reserve us some contiguous memory
-            if ((rc = ioctl(mFd, NVME_IOCTL_METABUF_ALLOC, metaBuf.ID)) < 0) {
-                throw FrmwkEx(HERE,
-                    "Meta data alloc request denied with error: %d", rc);
-            }
-
-            // Map that memory back to user space for RW access
-            metaBuf.buf = KernelAPI::mmap(metaBuf.size, metaBuf.ID,
-                KernelAPI::MMR_META);
-            if (metaBuf.buf == NULL) {
-                LOG_ERR("Unable to mmap contig memory to user space");
-                // Have to free the memory, not useful if we can't access it
-                if ((rc =ioctl(mFd, NVME_IOCTL_METABUF_DELETE, metaBuf.ID)) < 0)
-                    LOG_ERR("Meta data free request denied with error: %d", rc);
-                throw FrmwkEx(HERE);
-            }
-
-            mMetaReserved.insert(resIter, metaBuf);
-            return true;
+        // Map that memory back to user space for RW access
+        metaBuf.buf = KernelAPI::mmap(metaBuf.size, metaBuf.ID,
+            KernelAPI::MMR_META);
+        if (metaBuf.buf == NULL) {
+            LOG_ERR("Unable to mmap contig memory to user space");
+            // Have to free the memory, not useful if we can't access it
+            if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_METABUF_DELETE,
+                metaBuf.ID)) < 0)
+                LOG_ERR("Meta data free request denied with error: %d", rc);
+            throw FrmwkEx(HERE);
         }
+
+        mMetaAllocated.push_back(metaBuf);
+        mMetaInUse.push_back(false);
     }
-    return false;
+
+    // Lowest IDs are handed out 1st, they sit atop the stack
+    for (uint32_t i = 0; i < added; i++)
+        mMetaFree.push_back(mMetaAllocated.size() - 1 - i);
+    LOG_NRM("Allocated %d meta data bufs, %ld in total", added,
+        mMetaAllocated.size());
+    return added;
 }
 
 
 void
 MetaRsrc::ReleaseMetaBuf(MetaDataBuf metaBuf)
 {
-    deque<MetaDataBuf>::iterator resIter = mMetaReserved.begin();
-
     // Are we trying to release a default constructed MetaDataBuf, or illegal 1
     if (metaBuf == MetaDataBuf())
         return;
 
-    // Search the ordered elements
-    while (resIter != mMetaReserved.end()) {
-        if ((*resIter).ID == metaBuf.ID) {
-            mMetaReleased.push_back(*resIter);
-            mMetaReserved.erase(resIter);
-            break;
-        }
-        resIter++;
+    if ((metaBuf.ID < mMetaInUse.size()) && mMetaInUse[metaBuf.ID] &&
+        (mMetaAllocated[metaBuf.ID] == metaBuf)) {
+        mMetaInUse[metaBuf.ID] = false;
+        mMetaFree.push_back(metaBuf.ID);
     }
 }
 
@@ -159,18 +175,10 @@ MetaRsrc::ReleaseMetaBuf(MetaDataBuf metaBuf)
 void
 MetaRsrc::FreeAllMetaBuf()
 {
-    deque<MetaDataBuf>::iterator resIter = mMetaReserved.begin();
-
-    // Search the ordered elements, moves every reserved item into released
-    while (resIter != mMetaReserved.end()) {
-        ReleaseMetaBuf(*resIter);
-        resIter = mMetaReserved.begin();
-    }
-
-    // Now we have to free all the elements in the released list
-    while (mMetaReleased.size()) {
-        MetaDataBuf tmp = mMetaReleased.back();
-        mMetaReleased.pop_back();
+    // Free every allocation whether reserved or not
+    while (mMetaAllocated.size()) {
+        MetaDataBuf tmp = mMetaAllocated.back();
+        mMetaAllocated.pop_back();
 
         // Undo all which was done to create/reserve kernel meta data buffers
         KernelAPI::munmap(tmp.buf, tmp.size);
@@ -179,11 +187,10 @@ MetaRsrc::FreeAllMetaBuf()
         // been deleted by a prior NVME_IOCTL_DEVICE_STATE call to dnvme. The
         // act of not freeing causes memory leak, the act of freeing to many
         // times is of no harm.
-        ioctl(mFd, NVME_IOCTL_METABUF_DELETE, tmp.ID);
+        IoStats::Ioctl(mFd, NVME_IOCTL_METABUF_DELETE, tmp.ID);
     }
+    mMetaInUse.clear();
+    mMetaFree.clear();
 
     mMetaAllocSize = 0;
-
-    if ((mMetaReserved.empty() == false) || (mMetaReleased.empty() == false))
-        throw FrmwkEx(HERE, "Internal program error: meta list not empty");
 }
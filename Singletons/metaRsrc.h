@@ -17,10 +17,12 @@
 #ifndef _METARSRC_H_
 #define _METARSRC_H_
 
-#include <deque>
+#include <vector>
 #include "tnvme.h"
 
 #define METADATA_UNIQUE_ID_BITS         18      // 18 bits to rep a unique ID
+/// Num of meta data buffers allocated from dnvme whenever the pool runs dry
+#define METADATA_SLAB_BUFS              64
 
 struct MetaDataBuf {
     uint8_t *buf;
@@ -57,6 +59,13 @@ struct MetaDataBuf {
 * memory to it. Remember to release previously reserved ID's/buffers because
 * they are limited in number.
 *
+* IDs are handed out densely from 0. Released buffers remain allocated and
+* mapped on a free list, and whenever that list runs dry a whole slab of
+* METADATA_SLAB_BUFS buffers is allocated and mapped at once. Thus reserving
+* and releasing are constant time and free of syscalls in steady state; call
+* PreallocMetaBuf() with the max num of outstanding cmds to avoid even the
+* slab allocations while a workload is running.
+*
 * Allocations occur in the kernel and the kernel always enforces DWORD
 * alignment. There is nothing to be gained by testing non properly aligned meta
 * data buffers, but it will most certainly cause tnvme to eg fault or core dump.
@@ -99,6 +108,15 @@ public:
     bool ReserveMetaBuf(MetaDataBuf &metaBuf);
     void ReleaseMetaBuf(MetaDataBuf metaBuf);
 
+    /**
+     * Ensure at least the spec'd number of meta data buffers are free, i.e.
+     * allocated, mapped and not reserved, thus can be reserved without
+     * calling dnvme. The meta data alloc size must already have been set.
+     * @param numBufs Pass the max num of buffers to be reserved at once
+     * @return true upon success, otherwise false
+     */
+    bool PreallocMetaBuf(uint32_t numBufs);
+
 
 protected:
     /// Releases all kernel meta data memory back to the system
@@ -114,10 +132,19 @@ private:
     /// Stores the size of each meta data allocation
     uint32_t mMetaAllocSize;
 
-    /// Track all outstanding/reserved meta data unique IDs
-    deque<MetaDataBuf> mMetaReserved;
-    /// Previously reserved, but no longer in use, can be easily reserved again
-    deque<MetaDataBuf> mMetaReleased;
+    /// Every buffer allocated from dnvme, indexed by its unique ID
+    vector<MetaDataBuf> mMetaAllocated;
+    /// Indexed by unique ID, true when the buffer is reserved
+    vector<bool> mMetaInUse;
+    /// IDs of allocated buffers which are not reserved, used as a stack
+    vector<uint32_t> mMetaFree;
+
+    /**
+     * Allocate and map the next numBufs unique IDs, adding them to mMetaFree.
+     * @param numBufs Pass the number of buffers to add
+     * @return the number of buffers actually added, limited by dnvme's ID range
+     */
+    uint32_t GrowMetaBuf(uint32_t numBufs);
 };
 
 
@@ -194,7 +194,7 @@ ObjRsrc::FreeAllObj()
      * course, assumes that all other shared_ptr's to those objects have been
      * destroyed. This should be the case since the resource manager creates
      * objects on behalf of tests and all test objects within a group are
-     * deleted after they complete, thus removing localized share_ptr's.
+     * reset after they complete, thus removing localized share_ptr's.
      */
     LOG_NRM("Group level resources are being freed: %ld", mObjGrpLife.size());
     mObjGrpLife.clear();
@@ -57,6 +57,9 @@ public:
     SharedTrackablePtr
     GetObj(string lookupName);
 
+    /// @return The number of group lifetime objects presently allocated
+    size_t GetNumObj() { return mObjGrpLife.size(); }
+
 
 protected:
     /// Free all objects which were allocated.
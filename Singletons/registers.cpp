@@ -18,6 +18,8 @@
 #include "registers.h"
 #include "tnvme.h"
 #include "../Exception/frmwkEx.h"
+#include "../Utils/ioStats.h"
+#include "../Utils/probes.h"
 
 #include <boost/assign/list_of.hpp>
 using namespace boost::assign;
@@ -119,13 +121,14 @@ Registers::Read(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     } else if (rsize > MAX_SUPPORTED_REG_SIZE) {
         LOG_ERR("Size of %s is larger than supplied buffer", rdesc);
         return false;
-    } else if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+    } else if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
         LOG_ERR("Error reading %s: %d returned", rdesc, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
             io.type, io.offset, io.nBytes, io.type, io.buffer);
         return false;
     }
+    TNVME_PROBE3(reg_read, io.type, io.offset, io.nBytes);
 
     value = REGMASK(value, rsize);
     if (verbose)
@@ -150,13 +153,14 @@ Registers::Read(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     case 8: io.acc_type = QUAD_LEN;         break;
     }
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
         LOG_ERR("Error reading reg offset 0x%08X: %d returned", roffset, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
             io.type, io.offset, io.nBytes, io.type, io.buffer);
         return false;
     }
+    TNVME_PROBE3(reg_read, io.type, io.offset, io.nBytes);
 
     if (verbose) {
         LOG_NRM("Reading %s",
@@ -173,13 +177,14 @@ Registers::Read(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     int rc;
     struct rw_generic io = { regSpc, roffset, rsize, racc, value };
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
         LOG_ERR("Error reading reg offset 0x%08X: %d returned", roffset, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
             io.type, io.offset, io.nBytes, io.type, io.buffer);
         return false;
     }
+    TNVME_PROBE3(reg_read, io.type, io.offset, io.nBytes);
 
     if (verbose) {
         LOG_NRM("Reading %s",
@@ -239,13 +244,14 @@ Registers::Write(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     } else if (rsize > MAX_SUPPORTED_REG_SIZE) {
         LOG_ERR("Size of %s is larger than supplied buffer", rdesc);
         return false;
-    } else if ((rc = ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
+    } else if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
         LOG_ERR("Error writing %s: %d returned", rdesc, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
             io.type, io.offset, io.nBytes, io.type, io.buffer);
         return false;
     }
+    TNVME_PROBE3(reg_write, io.type, io.offset, io.nBytes);
 
     value = REGMASK(value, rsize);
     if (verbose)
@@ -270,13 +276,14 @@ Registers::Write(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     case 8: io.acc_type = QUAD_LEN;         break;
     }
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
         LOG_ERR("Error writing reg offset 0x%08X: %d returned", roffset, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
             io.type, io.offset, io.nBytes, io.type, io.buffer);
         return false;
     }
+    TNVME_PROBE3(reg_write, io.type, io.offset, io.nBytes);
 
     if (verbose) {
         LOG_NRM("Writing %s",
@@ -293,13 +300,14 @@ Registers::Write(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     int rc;
     struct rw_generic io = { regSpc, roffset, rsize, racc, value };
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
         LOG_ERR("Error writing reg offset 0x%08X: %d returned", roffset, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
             io.type, io.offset, io.nBytes, io.type, io.buffer);
         return false;
     }
+    TNVME_PROBE3(reg_write, io.type, io.offset, io.nBytes);
 
     if (verbose) {
         LOG_NRM("Writing %s",
@@ -421,7 +429,7 @@ Registers::DiscoverPciCapabilities()
     // becomes 0, then that is the capabilities among many.
     while (REGMASK((nextCap >> 8), 1)) {
         io.offset = (uint16_t)REGMASK((nextCap >> 8), 1);
-        if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+        if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
             LOG_ERR("Error reading offset 0x%08X from PCI space: %d returned",
                 io.offset, rc);
             return;
@@ -481,7 +489,7 @@ Registers::DiscoverPciCapabilities()
     // Only one of these is possible, i.e. the AERCAP capabilities.
     io.offset = 0x100;
     io.nBytes = 4;
-    if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+    if ((rc = IoStats::Ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
         LOG_ERR("Error reading offset 0x%08X from PCI space: %d returned",
             io.offset, rc);
         return;
@@ -16,6 +16,7 @@
 
 #include "buffers.h"
 #include "globals.h"
+#include "dumpArchive.h"
 
 
 Buffers::Buffers()
@@ -75,17 +76,28 @@ void
 Buffers::Dump(DumpFilename filename, const uint8_t *buf, uint32_t bufOffset,
     unsigned long length, uint32_t totalBufSize, string fileHdr)
 {
-    const uint8_t *data;
-    const int BUF_SIZE = 20;
-    char work[BUF_SIZE];
-    string output;
     FILE *fp;
     unsigned long dumpLen = length;
 
 
     LOG_NRM("Dumping to filename: %s", filename.c_str());
     LOG_NRM("%s", fileHdr.c_str());
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
+    if ((totalBufSize != 0) && (bufOffset < totalBufSize)) {
+        if (length == ULONG_MAX)
+            dumpLen = (totalBufSize - bufOffset);
+        else if ((length + bufOffset) >= totalBufSize)
+            dumpLen = (totalBufSize - bufOffset);
+        LOG_DBG("dumpLen = 0x%016lX", dumpLen);
+
+        // Archive the raw bytes, formatting them is deferred to extraction
+        if (DumpArchive::IsOpen()) {
+            DumpArchive::Append(filename, fileHdr, &(buf[bufOffset]),
+                dumpLen);
+            return;
+        }
+    }
+
+    if ((fp = DumpArchive::OpenDump(filename)) == NULL)
         throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
     fprintf(fp, "%s\n", fileHdr.c_str());
 
@@ -97,15 +109,26 @@ Buffers::Dump(DumpFilename filename, const uint8_t *buf, uint32_t bufOffset,
             bufOffset, totalBufSize);
         goto Dump_EXIT_ERROR;
     }
+    DumpHex(fp, &(buf[bufOffset]), dumpLen);
 
-    data = &(buf[bufOffset]);
-    if (length == ULONG_MAX)
-        dumpLen = (totalBufSize - bufOffset);
-    else if ((length + bufOffset) >= totalBufSize)
-        dumpLen = (totalBufSize - bufOffset);
-    LOG_DBG("dumpLen = 0x%016lX", dumpLen);
+Dump_EXIT_SUCCESS:
+    DumpArchive::CloseDump(fp);
+    return;
 
-    for (unsigned long i = 0; i < dumpLen; i++) {
+Dump_EXIT_ERROR:
+    DumpArchive::CloseDump(fp);
+    throw FrmwkEx(HERE);
+}
+
+
+void
+Buffers::DumpHex(FILE *fp, const uint8_t *data, unsigned long length)
+{
+    const int BUF_SIZE = 20;
+    char work[BUF_SIZE];
+    string output;
+
+    for (unsigned long i = 0; i < length; i++) {
         if ((i % 16) == 15) {
             snprintf(work, BUF_SIZE, " %02X\n", *data++);
             output += work;
@@ -121,12 +144,4 @@ Buffers::Dump(DumpFilename filename, const uint8_t *buf, uint32_t bufOffset,
     }
     if (output.length() != 0)
         fprintf(fp, "%s\n", output.c_str());
-
-Dump_EXIT_SUCCESS:
-    fclose(fp);
-    return;
-
-Dump_EXIT_ERROR:
-    fclose(fp);
-    throw FrmwkEx(HERE);
 }
@@ -53,7 +53,8 @@ public:
 
     /**
      * Send the entire contents of this buf starting a bufOffset and continue
-     * for length bytes to the file named by filename. The file is appended.
+     * for length bytes to the file named by filename. The file is appended,
+     * or while archiving the bytes are appended to the DumpArchive.
      * @note This method may throw
      * @param filename Pass the name of a file to open for dumping buffer
      * @param buf Pass a pointer to the buffer to dump
@@ -65,6 +66,14 @@ public:
     static void Dump(DumpFilename filename, const uint8_t *buf,
         uint32_t bufOffset, unsigned long length, uint32_t totalBufSize,
         string fileHdr);
+
+    /**
+     * Format length bytes of data to the stream in the same manner as Dump().
+     * @param fp Pass the stream to write
+     * @param data Pass a pointer to the bytes to format
+     * @param length Pass the number of bytes to format
+     */
+    static void DumpHex(FILE *fp, const uint8_t *data, unsigned long length);
 };
 
 
@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <map>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "dsmEngine.h"
+#include "globals.h"
+#include "io.h"
+#include "workload.h"
+#include "../Cmds/read.h"
+#include "../Queues/ce.h"
+
+
+static bool
+ExtentLess(const DsmExtent &a, const DsmExtent &b)
+{
+    return (a.slba < b.slba);
+}
+
+
+DsmEngine::DsmEngine()
+{
+}
+
+
+DsmEngine::~DsmEngine()
+{
+}
+
+
+void
+DsmEngine::Coalesce(std::vector<DsmExtent> &extents)
+{
+    std::vector<DsmExtent> merged;
+
+    std::sort(extents.begin(), extents.end(), ExtentLess);
+    for (size_t i = 0; i < extents.size(); i++) {
+        if (extents[i].nlb == 0)
+            continue;
+
+        if (merged.size() && ((merged.back().slba + merged.back().nlb) >=
+            extents[i].slba)) {
+            uint64_t end = MAX((merged.back().slba + merged.back().nlb),
+                (extents[i].slba + extents[i].nlb));
+            merged.back().nlb = (end - merged.back().slba);
+        } else {
+            merged.push_back(extents[i]);
+        }
+    }
+    extents.swap(merged);
+}
+
+
+std::vector<SharedDatasetMgmtPtr>
+DsmEngine::BuildCmds(uint32_t nsid, std::vector<DsmExtent> extents,
+    bool deallocate, uint32_t ctxAttrib)
+{
+    std::vector<RangeDef> ranges;
+    std::vector<SharedDatasetMgmtPtr> cmds;
+
+    Coalesce(extents);
+    for (size_t i = 0; i < extents.size(); i++) {
+        for (uint64_t done = 0; done < extents[i].nlb; ) {
+            RangeDef range;
+            memcpy(&range.ctxAttrib, &ctxAttrib, sizeof(range.ctxAttrib));
+            range.slba = (extents[i].slba + done);
+            range.length = (uint32_t)MIN(DSM_MAX_RANGE_NLB,
+                (extents[i].nlb - done));
+            done += range.length;
+            ranges.push_back(range);
+        }
+    }
+
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)MASK_PRP1_PAGE;
+    for (size_t first = 0; first < ranges.size(); first += DSM_MAX_RANGES) {
+        uint32_t nr = (uint32_t)MIN((size_t)DSM_MAX_RANGES,
+            (ranges.size() - first));
+
+        // 256 ranges of 16 bytes each fill exactly 1 page, thus PRP1 only
+        SharedMemBufferPtr rangeMem = SharedMemBufferPtr(new MemBuffer());
+        rangeMem->InitOffset1stPage((nr * sizeof(RangeDef)), 0, true);
+        memcpy(rangeMem->GetBuffer(), &ranges[first], (nr * sizeof(RangeDef)));
+
+        SharedDatasetMgmtPtr cmd = SharedDatasetMgmtPtr(new DatasetMgmt());
+        cmd->SetNSID(nsid);
+        cmd->SetNR(nr - 1);     // convert to 0-based
+        cmd->SetAD(deallocate);
+        cmd->SetPrpBuffer(prpBitmask, rangeMem);
+        cmds.push_back(cmd);
+    }
+
+    LOG_NRM("Built %ld DSM cmds of %ld ranges from %ld extents", cmds.size(),
+        ranges.size(), extents.size());
+    return cmds;
+}
+
+
+std::vector<DsmExtent>
+DsmEngine::RandomExtents(uint64_t nsze, uint32_t numExtents, uint32_t maxNLB,
+    uint32_t seed)
+{
+    std::vector<DsmExtent> extents;
+    unsigned int state = seed;
+
+    if ((nsze == 0) || (maxNLB == 0))
+        throw FrmwkEx(HERE, "Illegal NSZE=%lld or max NLB=%d", (long long)nsze,
+            maxNLB);
+
+    for (uint32_t i = 0; i < numExtents; i++) {
+        DsmExtent extent;
+        uint64_t rnd = (((uint64_t)rand_r(&state) << 31) | rand_r(&state));
+        extent.slba = (rnd % nsze);
+        extent.nlb = 1 + (rand_r(&state) % maxNLB);
+        extent.nlb = MIN(extent.nlb, (nsze - extent.slba));
+        extents.push_back(extent);
+    }
+    return extents;
+}
+
+
+void
+DsmEngine::Issue(string grpName, string testName,
+    std::vector<SharedSQPtr> &sqs, SharedCQPtr cq,
+    std::vector<SharedDatasetMgmtPtr> &cmds, DsmStats &stats)
+{
+    uint32_t numCE;
+    uint32_t ceRemain;
+    uint32_t isrCount;
+    uint16_t uniqueId;
+    size_t numSent = 0;
+    size_t numDone = 0;
+    uint32_t numOutstanding = 0;
+    struct timeval start;
+    struct timeval now;
+    // Key is (SQID << 16 | CID), value is (SQ index << 16 | cmd index)
+    std::map<uint32_t, std::pair<size_t, size_t> > outstanding;
+    std::vector<uint32_t> inflight(sqs.size(), 0);
+    SharedMemBufferPtr ceMem = SharedMemBufferPtr(new MemBuffer());
+
+    memset(&stats, 0, sizeof(stats));
+    if (sqs.empty())
+        throw FrmwkEx(HERE, "Need at least 1 SQ");
+    else if ((numCE = cq->ReapInquiry(isrCount, true)) != 0) {
+        cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq", "notEmpty"),
+            "Test assumption have not been met");
+        throw FrmwkEx(HERE, "Require 0 CE's within CQ %d, not upheld, found %d",
+            cq->GetQId(), numCE);
+    }
+    uint32_t cqDepth = (cq->GetNumEntries() - 1);
+
+    if (gettimeofday(&start, NULL) != 0)
+        throw FrmwkEx(HERE, "Cannot retrieve system time");
+    while (numDone < cmds.size()) {
+        // Fill every SQ round robin, never overfilling the shared CQ
+        std::vector<bool> ring(sqs.size(), false);
+        bool sent = true;
+        while (sent && (numSent < cmds.size()) &&
+            (numOutstanding < cqDepth)) {
+            sent = false;
+            for (size_t q = 0; (q < sqs.size()) && (numSent < cmds.size()) &&
+                (numOutstanding < cqDepth); q++) {
+                if (inflight[q] >= (sqs[q]->GetNumEntries() - 1))
+                    continue;
+                sqs[q]->Send(cmds[numSent], uniqueId);
+                outstanding[((uint32_t)sqs[q]->GetQId() << 16) | uniqueId] =
+                    std::make_pair(q, numSent);
+                inflight[q]++;
+                numOutstanding++;
+                numSent++;
+                ring[q] = sent = true;
+            }
+        }
+        for (size_t q = 0; q < sqs.size(); q++) {
+            if (ring[q])
+                sqs[q]->Ring();
+        }
+
+        if (cq->ReapInquiryWaitAny(CALC_TIMEOUT_ms(numOutstanding), numCE,
+            isrCount) == false) {
+            cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+                "timeout"), "Dump Entire CQ");
+            throw FrmwkEx(HERE, "Unable to see CEs for issued DSM cmds");
+        }
+
+        uint32_t numReaped = cq->Reap(ceRemain, ceMem, isrCount, numCE, true);
+        for (uint32_t i = 0; i < numReaped; i++) {
+            union CE *ce = (union CE *)(ceMem->GetBuffer() +
+                (i * cq->GetEntrySize()));
+            std::map<uint32_t, std::pair<size_t, size_t> >::iterator it =
+                outstanding.find(((uint32_t)ce->n.SQID << 16) | ce->n.CID);
+            if (it == outstanding.end()) {
+                cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+                    "unknownCID"), "Dump Entire CQ");
+                throw FrmwkEx(HERE, "CE reports unknown SQID %d, CID 0x%04X",
+                    (int)ce->n.SQID, (int)ce->n.CID);
+            }
+
+            SharedDatasetMgmtPtr cmd = cmds[it->second.second];
+            if (ProcessCE::ValidatePeek(*ce) == false) {
+                cmd->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                    cmd->GetName(), "failed"), "A cmd's contents dumped");
+                ProcessCE::Validate(*ce);   // throws
+            }
+
+            const RangeDef *range = (const RangeDef *)cmd->GetROPrpBuffer();
+            uint32_t nr = (cmd->GetNR() + 1);
+            for (uint32_t r = 0; r < nr; r++)
+                stats.numLBA += range[r].length;
+            stats.numRanges += nr;
+            stats.numCmds++;
+
+            inflight[it->second.first]--;
+            outstanding.erase(it);
+            numOutstanding--;
+            numDone++;
+        }
+    }
+
+    if (gettimeofday(&now, NULL) != 0)
+        throw FrmwkEx(HERE, "Cannot retrieve system time");
+    stats.elapsed_us = Workload::ElapsedUsec(start, now);
+}
+
+
+void
+DsmEngine::DeallocateNamspc(string grpName, string testName,
+    std::vector<SharedSQPtr> &sqs, SharedCQPtr cq, uint32_t nsid,
+    DsmStats &stats)
+{
+    ConstSharedIdentifyPtr idCmdNamspc =
+        gInformative->GetIdentifyCmdNamspc(nsid);
+    if (idCmdNamspc == Identify::NullIdentifyPtr)
+        throw FrmwkEx(HERE, "Namespace #%d must exist", nsid);
+
+    DsmExtent all;
+    all.slba = 0;
+    all.nlb = idCmdNamspc->GetValue(IDNAMESPC_NSZE);
+    std::vector<SharedDatasetMgmtPtr> cmds =
+        BuildCmds(nsid, std::vector<DsmExtent>(1, all), true);
+    Issue(grpName, testName, sqs, cq, cmds, stats);
+}
+
+
+uint64_t
+DsmEngine::VerifyDeallocated(string grpName, string testName, SharedSQPtr sq,
+    SharedCQPtr cq, uint32_t nsid, std::vector<DsmExtent> extents,
+    bool mustMatch)
+{
+    uint64_t numChecked = 0;
+    uint64_t numMismatch = 0;
+
+    ConstSharedIdentifyPtr idCmdNamspc =
+        gInformative->GetIdentifyCmdNamspc(nsid);
+    if (idCmdNamspc == Identify::NullIdentifyPtr)
+        throw FrmwkEx(HERE, "Namespace #%d must exist", nsid);
+    if (gCmdLine.rev < SPECREV_13) {
+        LOG_NRM("DLFEAT is defined by NVMe 1.3, deallocated reads unchecked");
+        return 0;
+    }
+
+    uint8_t dlfeat =
+        idCmdNamspc->GetROPrpBuffer()[IDNAMESPC_DLFEAT_OFFSET];
+    uint8_t expected;
+    switch (dlfeat & DLFEAT_READ_MASK) {
+    case DLFEAT_READ_ZEROES:    expected = 0x00;    break;
+    case DLFEAT_READ_ONES:      expected = 0xff;    break;
+    default:
+        LOG_NRM("DLFEAT=0x%02X doesn't define deallocated reads, unchecked",
+            dlfeat);
+        return 0;
+    }
+
+    uint64_t lbaDataSize = idCmdNamspc->GetLBADataSize();
+    LBAFormat lbaFormat = idCmdNamspc->GetLBAFormat();
+    Informative::NamspcType nsType =
+        gInformative->IdentifyNamespace(idCmdNamspc);
+    bool interleaved = ((nsType == Informative::NS_METAI) ||
+        (nsType == Informative::NS_E2EI));
+
+    SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
+    readMem->Init(lbaDataSize + (interleaved ? lbaFormat.MS : 0));
+    SharedReadPtr readCmd = SharedReadPtr(new Read());
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+    readCmd->SetPrpBuffer(prpBitmask, readMem);
+    readCmd->SetNSID(nsid);
+    readCmd->SetNLB(0);
+    if ((interleaved == false) && lbaFormat.MS) {
+        if (gRsrcMngr->SetMetaAllocSize(lbaFormat.MS) == false)
+            throw FrmwkEx(HERE);
+        readCmd->AllocMetaBuffer();
+    }
+
+    Coalesce(extents);
+    for (size_t i = 0; i < extents.size(); i++) {
+        // Spread the samples evenly, always including the 1st and last LBA
+        uint64_t numSamples = MIN(extents[i].nlb, (uint64_t)DSM_VERIFY_SAMPLES);
+        for (uint64_t s = 0; s < numSamples; s++) {
+            uint64_t lba = extents[i].slba;
+            if (numSamples > 1)
+                lba += (((extents[i].nlb - 1) * s) / (numSamples - 1));
+            readCmd->SetSLBA(lba);
+            memset(readMem->GetBuffer(), ~expected, readMem->GetBufSize());
+            IO::SendAndReapCmd(grpName, testName, CALC_TIMEOUT_ms(1), sq, cq,
+                readCmd, "dealloc", false);
+            numChecked++;
+
+            const uint8_t *data = readMem->GetBuffer();
+            uint64_t b = 0;
+            while ((b < lbaDataSize) && (data[b] == expected))
+                b++;
+            if (b == lbaDataSize)
+                continue;
+
+            numMismatch++;
+            if (mustMatch) {
+                readCmd->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                    "ReadDealloc"), "Deallocated LBA read back");
+                throw FrmwkEx(HERE, "Deallocated LBA 0x%016llX byte %lld "
+                    "= 0x%02X, DLFEAT advertises 0x%02X",
+                    (unsigned long long)lba, (long long)b, data[b], expected);
+            } else if (numMismatch == 1) {
+                LOG_WARN("LBA 0x%016llX byte %lld = 0x%02X, DLFEAT "
+                    "advertises 0x%02X; deallocate is advisory",
+                    (unsigned long long)lba, (long long)b, data[b], expected);
+            }
+        }
+    }
+    if (numMismatch) {
+        LOG_WARN("%lld of %lld sampled LBA's were not read back as "
+            "deallocated", (long long)numMismatch, (long long)numChecked);
+    }
+    return numChecked;
+}
+
+
+void
+DsmEngine::LogDsmStats(const DsmStats &stats)
+{
+    double sec = MAX(stats.elapsed_us, (uint64_t)1) / 1000000.0;
+
+    LOG_NRM("DSM: cmds=%llu (%.1f/s), ranges=%llu (%.1f/s), LBA's=%llu "
+        "(%.1f/s), %.3f sec", (unsigned long long)stats.numCmds,
+        (stats.numCmds / sec), (unsigned long long)stats.numRanges,
+        (stats.numRanges / sec), (unsigned long long)stats.numLBA,
+        (stats.numLBA / sec), sec);
+}
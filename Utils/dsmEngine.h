@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _DSMENGINE_H_
+#define _DSMENGINE_H_
+
+#include <vector>
+#include "tnvme.h"
+#include "../Queues/sq.h"
+#include "../Queues/cq.h"
+#include "../Cmds/datasetMgmt.h"
+
+/// Max num of ranges a single DSM cmd may carry
+#define DSM_MAX_RANGES              256
+/// Max num of LBA's a single range may describe, RangeDef.length is 32 bits
+#define DSM_MAX_RANGE_NLB           0xffffffffULL
+
+/// Identify namspc byte 33, NVMe 1.3 Deallocate Logical Block Features
+#define IDNAMESPC_DLFEAT_OFFSET     33
+#define DLFEAT_READ_MASK            0x07
+#define DLFEAT_READ_ZEROES          0x01
+#define DLFEAT_READ_ONES            0x02
+
+/// Max num of LBA's VerifyDeallocated() reads back per extent
+#define DSM_VERIFY_SAMPLES          16
+
+
+/// A contiguous set of LBA's
+struct DsmExtent {
+    uint64_t slba;
+    uint64_t nlb;           // 1-based
+};
+
+
+/**
+ * Statistics gathered while issuing DSM cmds with DsmEngine::Issue().
+ */
+struct DsmStats {
+    uint64_t numCmds;       // Number of cmds which were completed
+    uint64_t numRanges;     // Number of ranges within those cmds
+    uint64_t numLBA;        // Number of LBA's described by those ranges
+    uint64_t elapsed_us;    // From the 1st doorbell until the last CE reaped
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It turns arbitrary extent lists into dataset mgmt cmds and
+* issues them pipelined across any number of SQ's, measuring the throughput
+* achieved. It can also confirm deallocated LBA's read back as advertised.
+*
+* @note This class may throw exceptions, please see comment within specific
+*       methods.
+*/
+class DsmEngine
+{
+public:
+    DsmEngine();
+    virtual ~DsmEngine();
+
+    /**
+     * Sort extents and merge those which overlap or abut, zero length
+     * extents are removed.
+     * @param extents Pass the extents to coalesce, returns the result
+     */
+    static void Coalesce(std::vector<DsmExtent> &extents);
+
+    /**
+     * Create the fewest DSM cmds which describe a set of extents. The
+     * extents are coalesced, those longer than a range can describe are
+     * split, and each cmd is packed with up to DSM_MAX_RANGES ranges.
+     * @param nsid Pass the namspc the extents reside within
+     * @param extents Pass the extents, in any order
+     * @param deallocate Pass true to set the AD attribute of every cmd
+     * @param ctxAttrib Pass the raw context attributes for every range
+     * @return the cmds, ready to be sent
+     */
+    static std::vector<SharedDatasetMgmtPtr> BuildCmds(uint32_t nsid,
+        std::vector<DsmExtent> extents, bool deallocate,
+        uint32_t ctxAttrib = 0);
+
+    /**
+     * Generate a repeatable set of random extents.
+     * @param nsze Pass the num of LBA's within the namspc
+     * @param numExtents Pass the num of extents to generate
+     * @param maxNLB Pass the largest 1-based length of any extent
+     * @param seed Pass the seed making the set repeatable
+     * @return the extents, which may overlap
+     */
+    static std::vector<DsmExtent> RandomExtents(uint64_t nsze,
+        uint32_t numExtents, uint32_t maxNLB, uint32_t seed);
+
+    /**
+     * Issue DSM cmds keeping every SQ as full as possible until all have
+     * completed successfully. This method requires 0 elements to reside in
+     * the CQ and also assumes no other cmd will complete into that CQ while
+     * this operation is occurring. All SQ's must complete into cq.
+     * @note Throws upon errors
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param sqs Pass pre-existing IOSQ's to issue cmds into
+     * @param cq Pass pre-existing IOCQ to reap CE's from
+     * @param cmds Pass the cmds to issue, each is issued once
+     * @param stats Returns the statistics of the cmds
+     */
+    static void Issue(string grpName, string testName,
+        std::vector<SharedSQPtr> &sqs, SharedCQPtr cq,
+        std::vector<SharedDatasetMgmtPtr> &cmds, DsmStats &stats);
+
+    /**
+     * Deallocate every LBA of a namspc, see Issue().
+     * @note Throws upon errors
+     */
+    static void DeallocateNamspc(string grpName, string testName,
+        std::vector<SharedSQPtr> &sqs, SharedCQPtr cq, uint32_t nsid,
+        DsmStats &stats);
+
+    /**
+     * Confirm deallocated LBA's read back as the namspc's DLFEAT field
+     * advertises, sampling up to DSM_VERIFY_SAMPLES LBA's spread evenly
+     * across every extent. Nothing is checked when DLFEAT doesn't define a
+     * value or the DUT predates 1.3. The AD attribute is only advisory, a
+     * controller may keep LBA's allocated, thus a mismatch is only an error
+     * when the controller claims to have deallocated the extents.
+     * @note Throws upon errors, or a mismatch when mustMatch is true
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param sq Pass pre-existing IOSQ to issue reads into
+     * @param cq Pass pre-existing IOCQ to reap CE's from
+     * @param nsid Pass the namspc the extents reside within
+     * @param extents Pass the extents which were deallocated
+     * @param mustMatch Pass true when the controller claims the extents are
+     *      deallocated, otherwise mismatches are only logged
+     * @return the number of LBA's whose content was checked
+     */
+    static uint64_t VerifyDeallocated(string grpName, string testName,
+        SharedSQPtr sq, SharedCQPtr cq, uint32_t nsid,
+        std::vector<DsmExtent> extents, bool mustMatch);
+
+    /**
+     * Log the throughput of a set of DSM cmds.
+     * @param stats Pass the statistics to log
+     */
+    static void LogDsmStats(const DsmStats &stats);
+};
+
+
+#endif
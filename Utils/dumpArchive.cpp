@@ -0,0 +1,496 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include <pthread.h>
+#include <zlib.h>
+#include <sys/time.h>
+#include <deque>
+#include <map>
+#include <set>
+#include <boost/filesystem.hpp>
+#include "tnvme.h"
+#include "dumpArchive.h"
+#include "buffers.h"
+
+/// Tests block dumping once this much awaits compression, bounds memory use
+#define MAX_QUEUED_BYTES            (64 * 1024 * 1024)
+
+bool DumpArchive::mOpen = false;
+
+// Records are queued by the dumping thread and compressed by sWriter
+static pthread_mutex_t sMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sWork = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sRoom = PTHREAD_COND_INITIALIZER;
+static deque<string> sRecs;
+static size_t sQueued = 0;
+static bool sStopping = false;
+static bool sFailed = false;
+static pthread_t sWriter;
+static gzFile sGz = NULL;
+static string sFilename;
+static uint64_t sNumRecs = 0;
+static uint64_t sNumBytes = 0;
+
+/// Text dumps in progress while archiving, keyed by the stream written
+struct PendingDump {
+    string  filename;
+    bool    truncate;
+    char    *buf;
+    size_t  len;
+};
+static map<FILE *, PendingDump *> sPending;
+
+/// Bytes archived per dump name, only accessed by the dumping thread
+static map<string, uint64_t> sDumpSizes;
+
+
+/**
+ * Background thread compressing the records queued by Enqueue().
+ */
+static void *
+Writer(void *)
+{
+    pthread_mutex_lock(&sMutex);
+    while (true) {
+        while (sRecs.empty() && (sStopping == false))
+            pthread_cond_wait(&sWork, &sMutex);
+        if (sRecs.empty())
+            break;
+
+        string rec;
+        rec.swap(sRecs.front());
+        sRecs.pop_front();
+        pthread_mutex_unlock(&sMutex);
+
+        bool ok = (sFailed || (gzwrite(sGz, rec.data(), rec.size()) ==
+            (int)rec.size()));
+
+        pthread_mutex_lock(&sMutex);
+        if ((ok == false) && (sFailed == false)) {
+            LOG_ERR("Unable to write dump archive, further dumps are lost");
+            sFailed = true;
+        }
+        sQueued -= rec.size();
+        pthread_cond_signal(&sRoom);
+    }
+    pthread_mutex_unlock(&sMutex);
+    return NULL;
+}
+
+
+DumpArchive::DumpArchive()
+{
+}
+
+
+DumpArchive::~DumpArchive()
+{
+}
+
+
+bool
+DumpArchive::Open(string filename)
+{
+    struct DumpArchiveHdr hdr;
+
+    Close();
+
+    // A run never appends to a previous run's archive, Extract() could
+    // otherwise not recreate the dumps exactly as that run left them
+    if ((sGz = gzopen(filename.c_str(), "wb")) == NULL) {
+        LOG_ERR("Unable to open dump archive: %s", filename.c_str());
+        return false;
+    }
+    memcpy(hdr.magic, DUMPARCHIVE_MAGIC, sizeof(hdr.magic));
+    hdr.version = DUMPARCHIVE_VERSION;
+    hdr.recSize = sizeof(struct DumpArchiveRec);
+    if (gzwrite(sGz, &hdr, sizeof(hdr)) != (int)sizeof(hdr)) {
+        LOG_ERR("Unable to write dump archive: %s", filename.c_str());
+        gzclose(sGz);
+        sGz = NULL;
+        return false;
+    }
+
+    sStopping = false;
+    sFailed = false;
+    sNumRecs = 0;
+    sNumBytes = 0;
+    if (pthread_create(&sWriter, NULL, Writer, NULL) != 0) {
+        LOG_ERR("Unable to start the dump archive thread");
+        gzclose(sGz);
+        sGz = NULL;
+        return false;
+    }
+    sFilename = filename;
+    mOpen = true;
+    return true;
+}
+
+
+bool
+DumpArchive::Close()
+{
+    if (mOpen == false)
+        return true;
+
+    pthread_mutex_lock(&sMutex);
+    sStopping = true;
+    pthread_cond_signal(&sWork);
+    pthread_mutex_unlock(&sMutex);
+    pthread_join(sWriter, NULL);
+    mOpen = false;
+
+    if ((gzclose(sGz) != Z_OK) && (sFailed == false)) {
+        LOG_ERR("Unable to close dump archive, it may be truncated");
+        sFailed = true;
+    }
+    sGz = NULL;
+    LOG_NRM("Archived %llu dumps, %llu bytes, into %s",
+        (unsigned long long)sNumRecs, (unsigned long long)sNumBytes,
+        sFilename.c_str());
+    return (sFailed == false);
+}
+
+
+void
+DumpArchive::Enqueue(DumpRecType type, const string &filename,
+    const string &fileHdr, const char *data, size_t length)
+{
+    struct DumpArchiveRec rec;
+    struct timeval now;
+    string work;
+
+    bool isDump = ((type != DUMPREC_CLEAN) && (type != DUMPREC_ROTATE));
+    if (type == DUMPREC_TEXT_TRUNC)
+        sDumpSizes[filename] = (fileHdr.size() + length);
+    else if (isDump)
+        sDumpSizes[filename] += (fileHdr.size() + length);
+
+    gettimeofday(&now, NULL);
+    rec.type = type;
+    rec.nameLen = filename.size();
+    rec.hdrLen = fileHdr.size();
+    rec.dataLen = length;
+    rec.time_us = ((now.tv_sec * 1000000ULL) + now.tv_usec);
+
+    work.reserve(sizeof(rec) + filename.size() + fileHdr.size() + length);
+    work.append((const char *)&rec, sizeof(rec));
+    work.append(filename);
+    work.append(fileHdr);
+    work.append(data, length);
+
+    pthread_mutex_lock(&sMutex);
+    while (sQueued && ((sQueued + work.size()) > MAX_QUEUED_BYTES))
+        pthread_cond_wait(&sRoom, &sMutex);
+    sQueued += work.size();
+    if (isDump) {
+        sNumRecs++;
+        sNumBytes += length;
+    }
+    sRecs.push_back(string());
+    sRecs.back().swap(work);
+    pthread_cond_signal(&sWork);
+    pthread_mutex_unlock(&sMutex);
+}
+
+
+void
+DumpArchive::Append(DumpFilename filename, string fileHdr,
+    const uint8_t *buf, unsigned long length)
+{
+    if (mOpen == false)
+        return;
+    Enqueue(DUMPREC_HEX, filename, fileHdr, (const char *)buf, length);
+}
+
+
+FILE *
+DumpArchive::OpenDump(DumpFilename filename, bool truncate)
+{
+    FILE *fp;
+
+    if (mOpen == false)
+        return fopen(filename.c_str(), (truncate ? "w" : "a"));
+
+    PendingDump *dump = new PendingDump;
+    dump->filename = filename;
+    dump->truncate = truncate;
+    dump->buf = NULL;
+    dump->len = 0;
+    if ((fp = open_memstream(&dump->buf, &dump->len)) == NULL) {
+        delete dump;
+        return NULL;
+    }
+    sPending[fp] = dump;
+    return fp;
+}
+
+
+void
+DumpArchive::CloseDump(FILE *fp)
+{
+    map<FILE *, PendingDump *>::iterator it = sPending.find(fp);
+
+    if (it == sPending.end()) {
+        fclose(fp);
+        return;
+    }
+
+    PendingDump *dump = it->second;
+    sPending.erase(it);
+    fclose(fp);     // finalizes dump->buf and dump->len
+    Enqueue((dump->truncate ? DUMPREC_TEXT_TRUNC : DUMPREC_TEXT),
+        dump->filename, "", dump->buf, dump->len);
+    free(dump->buf);
+    delete dump;
+}
+
+
+vector<string>
+DumpArchive::GetDumpFiles(string prefix)
+{
+    vector<string> files;
+
+    // The map is sorted, thus so are the matching names
+    map<string, uint64_t>::const_iterator it = sDumpSizes.lower_bound(prefix);
+    for (; it != sDumpSizes.end(); it++) {
+        if (it->first.compare(0, prefix.length(), prefix) != 0)
+            break;
+        files.push_back(it->first);
+    }
+    return files;
+}
+
+
+uint64_t
+DumpArchive::GetDumpSize(string filename)
+{
+    map<string, uint64_t>::const_iterator it = sDumpSizes.find(filename);
+    return ((it == sDumpSizes.end()) ? 0 : it->second);
+}
+
+
+void
+DumpArchive::CleanDumps(string dir)
+{
+    if (mOpen == false)
+        return;
+    ForgetDumps(dir);
+    Enqueue(DUMPREC_CLEAN, dir, "", NULL, 0);
+}
+
+
+void
+DumpArchive::RotateDumps(string dir, string prevDir)
+{
+    if (mOpen == false)
+        return;
+    ForgetDumps(dir);
+    Enqueue(DUMPREC_ROTATE, dir, prevDir, NULL, 0);
+}
+
+
+void
+DumpArchive::ForgetDumps(string prefix)
+{
+    map<string, uint64_t>::iterator it = sDumpSizes.lower_bound(prefix);
+    while ((it != sDumpSizes.end()) &&
+        (it->first.compare(0, prefix.length(), prefix) == 0)) {
+        sDumpSizes.erase(it++);
+    }
+}
+
+
+/**
+ * Convert the name a dump was recorded under into a path beneath dir.
+ * @param dir Pass the directory to extract into
+ * @param name Pass the recorded name
+ * @param path Returns the path to create
+ * @return false if the name would escape dir, otherwise true
+ */
+static bool
+ExtractPath(const string &dir, const string &name, string &path)
+{
+    boost::filesystem::path rel;
+    boost::filesystem::path full(name);
+
+    for (boost::filesystem::path::iterator it = full.begin();
+        it != full.end(); it++) {
+
+        string elem = it->string();
+        if (elem == "..")
+            return false;
+        else if ((elem == "/") || (elem == ".") || elem.empty())
+            continue;
+        rel /= *it;
+    }
+    if (rel.empty())
+        return false;
+    path = (boost::filesystem::path(dir) / rel).string();
+    return true;
+}
+
+
+/**
+ * Replay a DUMPREC_CLEAN or DUMPREC_ROTATE upon the files extracted so far.
+ * @param created Pass the paths extracted so far, returns them updated
+ * @param path Pass the extraction path of the dump dir being cleaned/rotated
+ * @param prevPath Pass the extraction path receiving the rotated files,
+ *        empty to remove the files instead
+ */
+static void
+ExtractMove(set<string> &created, string path, string prevPath)
+{
+    boost::system::error_code ec;
+
+    path += "/";
+    if (prevPath.empty() == false) {
+        prevPath += "/";
+        // Remove the files rotated last time
+        set<string>::iterator it = created.lower_bound(prevPath);
+        while ((it != created.end()) &&
+            (it->compare(0, prevPath.length(), prevPath) == 0)) {
+            boost::filesystem::remove(*it, ec);
+            created.erase(it++);
+        }
+    }
+
+    set<string> moved;
+    set<string>::iterator it = created.lower_bound(path);
+    while ((it != created.end()) &&
+        (it->compare(0, path.length(), path) == 0)) {
+        if (prevPath.empty()) {
+            boost::filesystem::remove(*it, ec);
+        } else if (it->compare(0, prevPath.length(), prevPath) != 0) {
+            string to = (prevPath + it->substr(path.length()));
+            boost::filesystem::create_directories(
+                boost::filesystem::path(to).parent_path(), ec);
+            if (rename(it->c_str(), to.c_str()) != 0)
+                LOG_ERR("Unable to move %s to %s", it->c_str(), to.c_str());
+            else
+                moved.insert(to);
+        } else {
+            it++;
+            continue;
+        }
+        created.erase(it++);
+    }
+    created.insert(moved.begin(), moved.end());
+}
+
+
+bool
+DumpArchive::Extract(string filename, string dir)
+{
+    gzFile gz;
+    struct DumpArchiveHdr hdr;
+    struct DumpArchiveRec rec;
+    string name, fileHdr, data, path;
+    set<string> created;
+    uint64_t numRecs = 0;
+    uint64_t numDumps = 0;
+    bool ok = false;
+
+    if ((gz = gzopen(filename.c_str(), "rb")) == NULL) {
+        LOG_ERR("Unable to open dump archive: %s", filename.c_str());
+        return false;
+    }
+    if ((gzread(gz, &hdr, sizeof(hdr)) != (int)sizeof(hdr)) ||
+        (memcmp(hdr.magic, DUMPARCHIVE_MAGIC, sizeof(hdr.magic)) != 0)) {
+        LOG_ERR("File is not a dump archive: %s", filename.c_str());
+        goto EXIT;
+    } else if ((hdr.version != DUMPARCHIVE_VERSION) ||
+        (hdr.recSize != sizeof(struct DumpArchiveRec))) {
+        LOG_ERR("Unsupported dump archive version %d", hdr.version);
+        goto EXIT;
+    }
+
+    while (true) {
+        int rc = gzread(gz, &rec, sizeof(rec));
+        if (rc == 0) {
+            ok = true;
+            break;
+        } else if ((rc != (int)sizeof(rec)) || (rec.type >= DUMPREC_FENCE)) {
+            LOG_ERR("Dump archive is corrupt after record %llu",
+                (unsigned long long)numRecs);
+            break;
+        }
+
+        name.resize(rec.nameLen);
+        fileHdr.resize(rec.hdrLen);
+        data.resize(rec.dataLen);
+        if (((rec.nameLen != 0) &&
+            (gzread(gz, &name[0], rec.nameLen) != (int)rec.nameLen)) ||
+            ((rec.hdrLen != 0) &&
+            (gzread(gz, &fileHdr[0], rec.hdrLen) != (int)rec.hdrLen)) ||
+            ((rec.dataLen != 0) &&
+            (gzread(gz, &data[0], rec.dataLen) != (int)rec.dataLen))) {
+            LOG_ERR("Dump archive is truncated after record %llu",
+                (unsigned long long)numRecs);
+            break;
+        }
+        numRecs++;
+
+        if (ExtractPath(dir, name, path) == false) {
+            LOG_ERR("Skipping dump outside of the extraction dir: %s",
+                name.c_str());
+            continue;
+        }
+
+        if ((rec.type == DUMPREC_CLEAN) || (rec.type == DUMPREC_ROTATE)) {
+            string prevPath;
+            if ((rec.type == DUMPREC_ROTATE) &&
+                (ExtractPath(dir, fileHdr, prevPath) == false)) {
+                LOG_ERR("Skipping rotation outside of the extraction dir: "
+                    "%s", fileHdr.c_str());
+                continue;
+            }
+            ExtractMove(created, path, prevPath);
+            continue;
+        }
+        numDumps++;
+
+        // 1st record of a file replaces anything from a previous extraction
+        bool truncate = (rec.type == DUMPREC_TEXT_TRUNC);
+        if (created.insert(path).second) {
+            boost::system::error_code ec;
+            boost::filesystem::create_directories(
+                boost::filesystem::path(path).parent_path(), ec);
+            truncate = true;
+        }
+
+        FILE *fp = fopen(path.c_str(), (truncate ? "w" : "a"));
+        if (fp == NULL) {
+            LOG_ERR("Unable to create file: %s", path.c_str());
+            break;
+        }
+        if (rec.type == DUMPREC_HEX) {
+            fprintf(fp, "%s\n", fileHdr.c_str());
+            Buffers::DumpHex(fp, (const uint8_t *)data.data(), data.size());
+        } else {
+            fwrite(data.data(), data.size(), 1, fp);
+        }
+        fclose(fp);
+    }
+    LOG_NRM("Extracted %llu dumps into %ld files beneath %s",
+        (unsigned long long)numDumps, created.size(), dir.c_str());
+
+EXIT:
+    gzclose(gz);
+    return ok;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _DUMPARCHIVE_H_
+#define _DUMPARCHIVE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "fileSystem.h"
+
+#define DUMPARCHIVE_MAGIC           "TNVMEARC"
+#define DUMPARCHIVE_VERSION         1
+
+
+/**
+ * The archive is a gzip stream which inflates to this header followed by
+ * DumpArchiveRec's, all fields are in host byte order.
+ */
+struct DumpArchiveHdr {
+    char     magic[8];      // DUMPARCHIVE_MAGIC
+    uint32_t version;       // DUMPARCHIVE_VERSION
+    uint32_t recSize;       // sizeof(struct DumpArchiveRec)
+} __attribute__((__packed__));
+
+typedef enum {
+    DUMPREC_TEXT,           // data is text appended to the file
+    DUMPREC_TEXT_TRUNC,     // data is text replacing the file's contents
+    DUMPREC_HEX,            // data is the raw buffer of a Buffers::Dump()
+    DUMPREC_CLEAN,          // name is a dump dir whose files are removed
+    DUMPREC_ROTATE,         // name is a dump dir whose files are moved to
+                            // the dir named by the file header
+    DUMPREC_FENCE           // always must be last element
+} DumpRecType;
+
+/**
+ * A record per dump, immediately followed by nameLen bytes of the dump's
+ * filename, then hdrLen bytes of its file header, then dataLen bytes of data.
+ * The file header is only used by DUMPREC_HEX and DUMPREC_ROTATE.
+ */
+struct DumpArchiveRec {
+    uint32_t type;          // DumpRecType
+    uint32_t nameLen;
+    uint32_t hdrLen;
+    uint32_t dataLen;
+    uint64_t time_us;       // dumped at this time since the epoch
+} __attribute__((__packed__));
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. While open every dump of the run is appended as a record to
+* a single archive instead of creating individual files, see cmd line option
+* --archive. Records are queued and compressed by a background thread so the
+* test dumping them never waits upon compression nor the file system.
+* Extract() recreates the individual dump files from an archive, see cmd line
+* option --extract.
+*
+* @note This class will not throw exceptions.
+*/
+class DumpArchive
+{
+public:
+    DumpArchive();
+    virtual ~DumpArchive();
+
+    /**
+     * Start archiving, replacing any previous content of the archive so it
+     * only ever holds the dumps of a single run.
+     * @param filename Pass the name of the archive to create
+     * @return true upon success, otherwise false
+     */
+    static bool Open(string filename);
+
+    /**
+     * Flush all queued records and stop archiving.
+     * @return true if every record was archived, otherwise false
+     */
+    static bool Close();
+    static bool IsOpen() { return mOpen; }
+
+    /**
+     * Queue a buffer dump, the bytes are copied before returning. Extract()
+     * formats them identically to Buffers::Dump().
+     * @param filename Pass the name of the dump file
+     * @param fileHdr Pass the custom file header description of the dump
+     * @param buf Pass a pointer to the bytes to dump
+     * @param length Pass the number of bytes to dump
+     */
+    static void Append(DumpFilename filename, string fileHdr,
+        const uint8_t *buf, unsigned long length);
+
+    /**
+     * Replacements for fopen()/fclose() of dump files. While archiving the
+     * text written to the returned stream is queued as a record by
+     * CloseDump(), otherwise they act upon the named file.
+     * @param filename Pass the name of the dump file
+     * @param truncate Pass true to replace the file's contents, otherwise
+     *        the file is appended
+     * @return The stream to write the dump, NULL upon failure
+     */
+    static FILE *OpenDump(DumpFilename filename, bool truncate = false);
+    static void CloseDump(FILE *fp);
+
+    /**
+     * Recreate the dump files captured by an archive.
+     * @param filename Pass the name of the archive to extract
+     * @param dir Pass the directory to create the dump files, it must exist;
+     *        the paths recorded within the archive are made relative to it
+     * @return true upon success, otherwise false
+     */
+    static bool Extract(string filename, string dir);
+
+    /**
+     * Lists the dumps archived under names starting with prefix, the
+     * archive's equivalent of listing a dump directory.
+     * @param prefix Pass the start of the names to list
+     * @return The names, sorted, empty if there are none
+     */
+    static vector<string> GetDumpFiles(string prefix);
+
+    /**
+     * @param filename Pass the name of an archived dump
+     * @return The bytes archived under the name, before compression
+     */
+    static uint64_t GetDumpSize(string filename);
+
+    /**
+     * Record the removal of every dump within a dump directory, so Extract()
+     * removes the files it created there, and stop listing them.
+     * @param dir Pass the dump directory being cleaned
+     */
+    static void CleanDumps(string dir);
+
+    /**
+     * Record moving every dump within a dump directory into a sub-dir after
+     * removing the dumps moved there previously, so Extract() does likewise
+     * with the files it created, and stop listing them.
+     * @param dir Pass the dump directory being rotated
+     * @param prevDir Pass the sub-dir of dir receiving the dumps
+     */
+    static void RotateDumps(string dir, string prevDir);
+
+
+private:
+    static bool mOpen;
+
+    static void Enqueue(DumpRecType type, const string &filename,
+        const string &fileHdr, const char *data, size_t length);
+
+    /**
+     * Stop listing the dumps starting with prefix.
+     * @param prefix Pass the start of the names to forget
+     */
+    static void ForgetDumps(string prefix);
+};
+
+
+#endif
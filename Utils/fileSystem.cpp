@@ -18,19 +18,196 @@
 #include <sys/stat.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <pthread.h>
+#include <algorithm>
+#include <deque>
 #include <boost/filesystem.hpp>
 #include "fileSystem.h"
+#include "dumpArchive.h"
 #include "../Exception/frmwkEx.h"
 
 #define BASE_NAME_DIR_INFO      "/Informative/"
 #define BASE_NAME_PENDING       "/GrpPending/"
+#define NAME_DIR_PREV           "prev"
+#define PREFIX_DIR_TRASH        ".trash."
 
 using namespace std;
 
 bool FileSystem::mUseDirInfo = true;
+string FileSystem::mDumpDirRoot;
 string FileSystem::mDumpDirInfo;
 string FileSystem::mDumpDirPending;
 
+// Dumps being discarded are moved into trash dirs which a background thread
+// deletes, so that starting a new group never waits upon the file system.
+static pthread_mutex_t sTrashMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sTrashCond = PTHREAD_COND_INITIALIZER;
+static deque<string> sTrash;
+static pthread_t sReaper;
+static bool sReaperRunning = false;
+static bool sReaperStopping = false;
+static uint32_t sTrashSeq = 0;
+
+
+/**
+ * Delete everything within a directory, the directory itself remains.
+ * @param dirFd Pass an open handle to the directory, it will be closed
+ */
+static void
+RemoveContents(int dirFd)
+{
+    DIR *dir;
+    struct dirent *entry;
+
+    if ((dir = fdopendir(dirFd)) == NULL) {
+        close(dirFd);
+        return;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if ((strcmp(entry->d_name, ".") == 0) ||
+            (strcmp(entry->d_name, "..") == 0)) {
+            continue;
+        }
+
+        // Most entries are dump files, don't pay to stat() them
+        if ((entry->d_type != DT_DIR) &&
+            (unlinkat(dirfd(dir), entry->d_name, 0) == 0)) {
+            continue;
+        }
+        int subFd = openat(dirfd(dir), entry->d_name,
+            (O_RDONLY | O_DIRECTORY | O_NOFOLLOW));
+        if (subFd != -1) {
+            RemoveContents(subFd);
+            unlinkat(dirfd(dir), entry->d_name, AT_REMOVEDIR);
+        }
+    }
+    closedir(dir);
+}
+
+
+/**
+ * Background thread deleting the trash dirs queued by Discard().
+ */
+static void *
+Reaper(void *)
+{
+    pthread_mutex_lock(&sTrashMutex);
+    while (true) {
+        while (sTrash.empty() && (sReaperStopping == false))
+            pthread_cond_wait(&sTrashCond, &sTrashMutex);
+        if (sTrash.empty())
+            break;
+
+        string trash = sTrash.front();
+        sTrash.pop_front();
+        pthread_mutex_unlock(&sTrashMutex);
+
+        int dirFd = open(trash.c_str(), (O_RDONLY | O_DIRECTORY | O_NOFOLLOW));
+        if (dirFd != -1) {
+            RemoveContents(dirFd);
+            rmdir(trash.c_str());
+        }
+        pthread_mutex_lock(&sTrashMutex);
+    }
+    pthread_mutex_unlock(&sTrashMutex);
+    return NULL;
+}
+
+
+/**
+ * Queue a dir to be deleted by the background thread, if the thread can't
+ * be started the dir is deleted before returning.
+ * @param trash Pass the full name of the dir to delete
+ */
+static void
+Discard(string trash)
+{
+    pthread_mutex_lock(&sTrashMutex);
+    sTrash.push_back(trash);
+    if (sReaperRunning == false) {
+        sReaperStopping = false;
+        if (pthread_create(&sReaper, NULL, Reaper, NULL) == 0) {
+            sReaperRunning = true;
+        } else {
+            LOG_WARN("Unable to delete dumps in the background");
+            sReaperStopping = true;
+            pthread_mutex_unlock(&sTrashMutex);
+            Reaper(NULL);
+            return;
+        }
+    }
+    pthread_cond_signal(&sTrashCond);
+    pthread_mutex_unlock(&sTrashMutex);
+}
+
+
+/**
+ * Move every entry of one directory into another, both must reside upon
+ * the same file system.
+ * @param from Pass the name of the dir to empty
+ * @param to Pass the name of the dir to fill
+ * @param except Pass the name of an entry to leave behind, NULL for none
+ * @return true upon success, otherwise false
+ */
+static bool
+MoveContents(string from, string to, const char *except)
+{
+    DIR *dir;
+    struct dirent *entry;
+    bool ok = true;
+
+    if ((dir = opendir(from.c_str())) == NULL) {
+        LOG_ERR("Unable to open %s: %s", from.c_str(), strerror(errno));
+        return false;
+    }
+    int toFd = open(to.c_str(), (O_RDONLY | O_DIRECTORY));
+    if (toFd == -1) {
+        LOG_ERR("Unable to open %s: %s", to.c_str(), strerror(errno));
+        closedir(dir);
+        return false;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if ((strcmp(entry->d_name, ".") == 0) ||
+            (strcmp(entry->d_name, "..") == 0) ||
+            (except && (strcmp(entry->d_name, except) == 0))) {
+            continue;
+        }
+        if (renameat(dirfd(dir), entry->d_name, toFd, entry->d_name) != 0) {
+            LOG_ERR("Unable to move %s%s: %s", from.c_str(), entry->d_name,
+                strerror(errno));
+            ok = false;
+        }
+    }
+    close(toFd);
+    closedir(dir);
+    return ok;
+}
+
+
+/**
+ * Create a dir, and its missing parents, accessible to all users.
+ * @param dir Pass the name of the dir to create
+ * @return true upon success or if it already exists, otherwise false
+ */
+static bool
+MakeDir(string dir)
+{
+    try {
+        boost::filesystem::create_directories(dir);
+    } catch (exception &exc) {
+        LOG_ERR("Unable to create %s: %s", dir.c_str(), exc.what());
+        return false;
+    }
+    if (chmod(dir.c_str(), 0777) != 0)
+        LOG_WARN("Unable to allow all users access to %s", dir.c_str());
+    return true;
+}
+
 
 FileSystem::FileSystem()
 {
@@ -45,29 +222,15 @@ FileSystem::~FileSystem()
 bool
 FileSystem::SetRootDumpDir(string dir)
 {
-    char work[256];
+    DIR *root;
+    struct dirent *entry;
 
+    mDumpDirRoot = (dir + "/");
     mDumpDirPending = (dir + BASE_NAME_PENDING);
     mDumpDirInfo = (dir + BASE_NAME_DIR_INFO);
 
     try {
-        if (boost::filesystem::exists(dir.c_str())) {
-            SetBaseDumpDir(false);
-            snprintf(work, sizeof(work), "mkdir -p -m 777 %s",
-                mDumpDirPending.c_str());
-            system(work);
-            if (CleanDumpDir() == false)
-                return false;
-
-            SetBaseDumpDir(true);    // this is the default
-            snprintf(work, sizeof(work), "mkdir -p -m 777 %s",
-                mDumpDirInfo.c_str());
-            system(work);
-            if (CleanDumpDir() == false)
-                return false;
-
-            return true;
-        } else {
+        if (boost::filesystem::exists(dir.c_str()) == false) {
             LOG_ERR("Root dump directory is missing: %s", dir.c_str());
             return false;
         }
@@ -75,13 +238,52 @@ FileSystem::SetRootDumpDir(string dir)
         LOG_ERR("boost::filesystem exception");
         return false;
     }
+
+    // Trash left behind when a prior run ended before it was deleted
+    if ((root = opendir(mDumpDirRoot.c_str())) != NULL) {
+        while ((entry = readdir(root)) != NULL) {
+            if (strncmp(entry->d_name, PREFIX_DIR_TRASH,
+                strlen(PREFIX_DIR_TRASH)) == 0) {
+                Discard(mDumpDirRoot + entry->d_name);
+            }
+        }
+        closedir(root);
+    }
+
+    SetBaseDumpDir(false);
+    if ((MakeDir(mDumpDirPending) == false) || (CleanDumpDir() == false))
+        return false;
+
+    SetBaseDumpDir(true);    // this is the default
+    if ((MakeDir(mDumpDirInfo) == false) || (CleanDumpDir() == false))
+        return false;
+
+    return true;
+}
+
+
+string
+FileSystem::NewTrashDir()
+{
+    char work[64];
+
+    pthread_mutex_lock(&sTrashMutex);
+    snprintf(work, sizeof(work), "%s%d.%u/", PREFIX_DIR_TRASH, getpid(),
+        sTrashSeq++);
+    pthread_mutex_unlock(&sTrashMutex);
+
+    string trash = (mDumpDirRoot + work);
+    if (mkdir(trash.c_str(), 0700) != 0) {
+        LOG_ERR("Unable to create %s: %s", trash.c_str(), strerror(errno));
+        return "";
+    }
+    return trash;
 }
 
 
 bool
 FileSystem::CleanDumpDir()
 {
-    char work[256];
     string dumpDir = (mUseDirInfo) ? mDumpDirInfo : mDumpDirPending;
 
     if (dumpDir.empty()) {
@@ -89,10 +291,16 @@ FileSystem::CleanDumpDir()
         return false;
     }
 
-    // Remove everything in the dir, not the dir itself
-    snprintf(work, sizeof(work), "rm -rf %s*", dumpDir.c_str());
-    system(work);
-    if (boost::filesystem::exists(work)) {
+    DumpArchive::CleanDumps(dumpDir);
+
+    // Remove everything in the dir, not the dir itself. Moving it all aside
+    // takes 1 rename per entry, the deletion happens in the background.
+    string trash = NewTrashDir();
+    if (trash.empty())
+        return false;
+    bool ok = MoveContents(dumpDir, trash, NULL);
+    Discard(trash);
+    if (ok == false) {
         LOG_ERR("Unable to remove files within: %s", dumpDir.c_str());
         return false;
     }
@@ -103,39 +311,49 @@ FileSystem::CleanDumpDir()
 bool
 FileSystem::RotateDumpDir()
 {
-    char work[256];
     string dumpDir = (mUseDirInfo) ? mDumpDirInfo : mDumpDirPending;
+    string prevDir = (dumpDir + NAME_DIR_PREV + "/");
+    struct stat prevStat;
 
     if (dumpDir.empty())
         return true;
+    DumpArchive::RotateDumps(dumpDir, prevDir);
+
+    // Remove the dumps rotated last time
+    if (stat(prevDir.c_str(), &prevStat) == 0) {
+        string trash = NewTrashDir();
+        if (trash.empty())
+            return false;
+        if (rename(prevDir.c_str(), (trash + NAME_DIR_PREV).c_str()) != 0) {
+            LOG_ERR("Unable to remove %s: %s", prevDir.c_str(),
+                strerror(errno));
+            Discard(trash);
+            return false;
+        }
+        Discard(trash);
+    }
 
-    // Remove everything in the dir of the form "*.prev"
-    snprintf(work, sizeof(work), "sudo rm %sprev", dumpDir.c_str());
-    system(work);
-    // Get a vector of filenames of all other files within dir
-//    boost::filesystem::path targDir(dumpDir);
-//    vector<boost::filesystem::path> allFiles;
-//    boost::filesystem::directory_iterator end_iter;
-//    boost::filesystem::directory_iterator dir_itrs(targDir);
-
-//    copy(boost::filesystem::directory_iterator(targDir),
-//        boost::filesystem::directory_iterator(), back_inserter(allFiles));
-
-    // Rename all files to "*.prev"
-//    for (size_t i = 0; i < allFiles.size(); i++) {
-//        //string newName = (allFiles[i].filename().native() + ".prev");
-//        snprintf(work, sizeof(work), "mv %s%s %s%s.prev",
-//            dumpDir.c_str(), allFiles[i].filename().c_str(),
-//            dumpDir.c_str(), allFiles[i].filename().c_str());
-//        system(work);
-//    }
-    // Create a new directory to store old dumps
-    snprintf(work, sizeof(work), "mkdir %sprev", dumpDir.c_str());
-    system(work);
     // Move all current informative results in new folder
-    snprintf(work, sizeof(work), "sudo mv %s* %sprev/", dumpDir.c_str(), dumpDir.c_str());
-    system(work);
-    return true;
+    if (MakeDir(prevDir) == false)
+        return false;
+    return MoveContents(dumpDir, prevDir, NAME_DIR_PREV);
+}
+
+
+void
+FileSystem::WaitForCleanup()
+{
+    pthread_mutex_lock(&sTrashMutex);
+    if (sReaperRunning == false) {
+        pthread_mutex_unlock(&sTrashMutex);
+        return;
+    }
+    sReaperStopping = true;
+    pthread_cond_signal(&sTrashCond);
+    pthread_mutex_unlock(&sTrashMutex);
+
+    pthread_join(sReaper, NULL);
+    sReaperRunning = false;
 }
 
 
@@ -156,3 +374,31 @@ FileSystem::PrepDumpFile(string grpName, string className, string objName,
         file += "." + qualifier;
     return file;
 }
+
+
+vector<string>
+FileSystem::GetDumpFiles(string grpName, string className)
+{
+    vector<string> files;
+    struct dirent *entry;
+    string dumpDir = (mUseDirInfo) ? mDumpDirInfo : mDumpDirPending;
+    string prefix = grpName + "." + className + ".";
+
+    // Archived dumps never reach the dump directory
+    if (DumpArchive::IsOpen())
+        return DumpArchive::GetDumpFiles(dumpDir + prefix);
+
+    DIR *dir = opendir(dumpDir.c_str());
+    if (dir == NULL)
+        return files;
+
+    while ((entry = readdir(dir)) != NULL) {
+        string name = entry->d_name;
+        if (name.compare(0, prefix.length(), prefix) == 0)
+            files.push_back(dumpDir + name);
+    }
+    closedir(dir);
+
+    sort(files.begin(), files.end());
+    return files;
+}
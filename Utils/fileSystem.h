@@ -72,7 +72,8 @@ public:
      * Cleans all files from the base dump directory. Each new group which
      * executes should start dumping to an empty directory. This approach keeps
      * only the last group's dumps and attempts to prevent the file system from
-     * breaching a maximum limit.
+     * breaching a maximum limit. The files are moved aside and deleted by a
+     * background thread, see WaitForCleanup().
      * @note This method will not throw
      * @return true if successful, otherwise false;
      */
@@ -80,13 +81,22 @@ public:
 
     /**
      * All the files from the base dump directory will be rotated such that
-     * filenames of the format "*.prev" will be deleted, and all other files
-     * currently within will be renamed to "*.prev".
+     * the files within sub directory "prev" will be deleted, and all other
+     * files currently within will be moved into "prev".
      * @note This method will not throw
      * @return true if successful, otherwise false;
      */
     static bool RotateDumpDir();
 
+    /**
+     * Block until the background deletion of the dumps discarded by
+     * CleanDumpDir() and RotateDumpDir() completes, call before exiting.
+     * Trash left behind when tnvme exits early is deleted the next time
+     * SetRootDumpDir() is called upon the same root dump directory.
+     * @note This method will not throw
+     */
+    static void WaitForCleanup();
+
     /**
      * Creates a filename from the parameters within the base dump directory.
      * @note This method may throw
@@ -99,12 +109,32 @@ public:
     static DumpFilename PrepDumpFile(string grpName, string className,
         string objName, string qualifier = "");
 
+    /**
+     * Lists the files within the base dump directory which were created by
+     * a specific test case, i.e. those named by PrepDumpFile() with the same
+     * grpName and className. While archiving, see DumpArchive, the dumps
+     * archived under those names are listed instead.
+     * @note This method will not throw
+     * @param grpName Pass the name of the group, i.e. Test::mGrpName
+     * @param className Pass the test cast class name
+     * @return The full filenames, sorted, empty if there are none
+     */
+    static vector<string> GetDumpFiles(string grpName, string className);
+
 
 private:
     /// true uses mDumpDirGrpInfo; false uses mDumpDirPending
     static bool mUseDirInfo;
+    static string mDumpDirRoot;
     static string mDumpDirInfo;
     static string mDumpDirPending;
+
+    /**
+     * Create a uniquely named, empty, dir within the root dump directory to
+     * move files into which are to be deleted.
+     * @return The full name of the dir, empty upon failure
+     */
+    static string NewTrashDir();
 };
 
 
@@ -19,6 +19,11 @@
 #include "kernelAPI.h"
 #include "globals.h"
 #include "io.h"
+#include "lbaPattern.h"
+#include "protInfo.h"
+#include "../Cmds/read.h"
+#include "../Cmds/write.h"
+#include "../Queues/writeShadow.h"
 
 
 IO::IO()
@@ -213,6 +218,8 @@ IO::SendAndReapCmd(string grpName, string testName, uint32_t ms,
     // throws if an error occurs
     CEStat retStat =
         Reap(cq, numCE, isrCount, grpName, testName, qualify, status, true);
+    if (retStat == CESTAT_SUCCESS)
+        ShadowCompleted(grpName, testName, sq, cmd, qualify);
     if (verbose) {
         cmd->Dump(FileSystem::PrepDumpFile(grpName, testName,
             cmd->GetName(), qualify), "A cmd's contents dumped");
@@ -237,6 +244,8 @@ IO::SendAndReapCmdWhole(string grpName, string testName, uint32_t ms,
     // throws if an error occurs
     union CE retCE = ReapCEWhole(cq, numCE, isrCount, grpName,
         testName, qualify);
+    if (ProcessCE::GetCEStat(retCE) == CESTAT_SUCCESS)
+        ShadowCompleted(grpName, testName, sq, cmd, qualify);
     if (verbose) {
         cmd->Dump(FileSystem::PrepDumpFile(grpName, testName,
             cmd->GetName(), qualify), "A cmd's contents dumped");
@@ -395,3 +404,68 @@ IO::AttemptRetrieveCE(SharedCQPtr cq, uint32_t numCE, uint32_t &isrCount,
 
     return cq->Reap(ceRemain, ceMem, isrCount, numCE, true, failOnIoctl);
 }
+
+
+void
+IO::ShadowCompleted(string grpName, string testName, SharedSQPtr sq,
+    SharedCmdPtr cmd, string qualify)
+{
+    uint8_t opcode = cmd->GetOpcode();
+    const uint8_t *buf = cmd->GetROPrpBuffer();
+    uint32_t nsid = cmd->GetNSID();
+    uint64_t slba = (((uint64_t)cmd->GetDword(11) << 32) | cmd->GetDword(10));
+    uint64_t nlb = (cmd->GetWord(12, 0) + 1);
+    LbaPatKey key;
+    uint64_t lba;
+    uint64_t runLen;
+
+    if ((sq->GetQId() == 0) || (buf == NULL))
+        return;
+    else if ((opcode == Write::Opcode) && !LbaPattern::GetKey(buf, key, lba))
+        return;     // Not the LbaPattern, WriteShadow::Sending() forgot it
+    else if ((opcode == Read::Opcode) && !WriteShadow::Lookup(nsid, slba,
+        key.seed, key.generation, runLen) && ((runLen == 0) || (runLen >= nlb)))
+        return;     // Nothing known about the LBA's read
+    else if ((opcode != Write::Opcode) && (opcode != Read::Opcode))
+        return;
+
+    ConstSharedIdentifyPtr idCmdNamspc =
+        gInformative->GetIdentifyCmdNamspc(nsid);
+    if (idCmdNamspc == Identify::NullIdentifyPtr)
+        return;
+    PILayout layout = ProtInfo::GetLayout(idCmdNamspc);
+    uint32_t stride = layout.lbaDataSize +
+        (layout.interleaved ? layout.metaSize : 0);
+    if ((layout.lbaDataSize < LBAPAT_HDR_SIZE) ||
+        (((nlb - 1) * stride + layout.lbaDataSize) > cmd->GetPrpBufferSize()))
+        return;
+
+    if (opcode == Write::Opcode) {
+        for (uint64_t i = 0; i < nlb; i++) {
+            LbaPatKey blkKey;
+            if (LbaPattern::GetKey((buf + (i * stride)), blkKey, lba) &&
+                (blkKey.nsid == nsid) && (lba == (slba + i))) {
+                WriteShadow::Record(nsid, lba, 1, blkKey.seed,
+                    blkKey.generation);
+            }
+        }
+        return;
+    }
+
+    key.nsid = nsid;
+    for (uint64_t i = 0; i < nlb; i += runLen) {
+        bool known = WriteShadow::Lookup(nsid, (slba + i), key.seed,
+            key.generation, runLen);
+        if ((runLen == 0) || (runLen > (nlb - i)))
+            runLen = (nlb - i);
+        if (known && !LbaPattern::Verify((buf + (i * stride)), key,
+            (slba + i), runLen, layout.lbaDataSize, stride)) {
+
+            cmd->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                "ReadPayload", qualify), "Read miscompared w/ write shadow");
+            throw FrmwkEx(HERE, "Read of NSID %d LBA's 0x%016llX+%lld "
+                "miscompared with what was last written", nsid,
+                (unsigned long long)slba, (long long)nlb);
+        }
+    }
+}
@@ -232,6 +232,16 @@ public:
         uint32_t &isrCount, string grpName, string testName, string qualify,
         const bool failOnIoctl = true);
 
+    /**
+     * Keep the WriteShadow coherent with a successfully completed cmd.
+     * Writes of LbaPattern data are recorded, and reads of LBA's whose
+     * content is known are verified against what was last written.
+     * @note Throws upon a read miscompare
+     */
+    static void ShadowCompleted(string grpName, string testName,
+        SharedSQPtr sq, SharedCmdPtr cmd, string qualify);
+
+
 private:
     /**
      * Send and reap using the specified reap function
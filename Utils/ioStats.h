@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _IOSTATS_H_
+#define _IOSTATS_H_
+
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
+#include <map>
+#include "dnvme.h"
+#include "ioTrace.h"
+
+/*     request                          */
+#define IOCTL_TABLE                                                            \
+    ZZ(NVME_IOCTL_READ_GENERIC)                                                \
+    ZZ(NVME_IOCTL_WRITE_GENERIC)                                               \
+    ZZ(NVME_IOCTL_GET_Q_METRICS)                                               \
+    ZZ(NVME_IOCTL_CREATE_ADMN_Q)                                               \
+    ZZ(NVME_IOCTL_DEVICE_STATE)                                                \
+    ZZ(NVME_IOCTL_SEND_64B_CMD)                                                \
+    ZZ(NVME_IOCTL_TOXIC_64B_DWORD)                                             \
+    ZZ(NVME_IOCTL_PREPARE_SQ_CREATION)                                         \
+    ZZ(NVME_IOCTL_PREPARE_CQ_CREATION)                                         \
+    ZZ(NVME_IOCTL_RING_SQ_DOORBELL)                                            \
+    ZZ(NVME_IOCTL_DUMP_METRICS)                                                \
+    ZZ(NVME_IOCTL_REAP_INQUIRY)                                                \
+    ZZ(NVME_IOCTL_REAP)                                                        \
+    ZZ(NVME_IOCTL_GET_DRIVER_METRICS)                                          \
+    ZZ(NVME_IOCTL_METABUF_CREATE)                                              \
+    ZZ(NVME_IOCTL_METABUF_ALLOC)                                               \
+    ZZ(NVME_IOCTL_METABUF_DELETE)                                              \
+    ZZ(NVME_IOCTL_SET_IRQ)                                                     \
+    ZZ(NVME_IOCTL_GET_DEVICE_METRICS)                                          \
+    ZZ(NVME_IOCTL_MARK_SYSLOG)
+
+
+/// The usage of a single NVME_IOCTL_* request
+struct IoctlCounters {
+    uint64_t num;           // Number of times it was issued
+    uint64_t usec;          // Time spent within ioctl() issuing it
+};
+
+
+/**
+ * Running totals of the interactions with dnvme since tnvme started,
+ * snapshot them before and after an operation and subtract to attribute
+ * the delta to it.
+ */
+struct IoCounters {
+    uint64_t numIoctls;     // Number of ioctl's issued to dnvme
+    uint64_t ioctl_us;      // Time spent within those ioctl's
+    uint64_t numCmds;       // Number of cmds sent into any SQ
+    uint64_t numBytes;      // Number of PRP data bytes of those cmds
+    uint64_t numBytesToDev;     // Of numBytes, those written to the DUT
+    uint64_t numBytesFromDev;   // Of numBytes, those read from the DUT
+    uint64_t numAllocs;     // Number of MemBuffer allocations
+    uint64_t numAllocBytes; // Number of bytes of those allocations
+    /// The breakdown of numIoctls/ioctl_us per NVME_IOCTL_* request
+    std::map<unsigned long, IoctlCounters> ioctls;
+
+    IoCounters() : numIoctls(0), ioctl_us(0), numCmds(0), numBytes(0),
+        numBytesToDev(0), numBytesFromDev(0), numAllocs(0),
+        numAllocBytes(0) {}
+
+    IoCounters &operator+=(const IoCounters &other)
+    {
+        numIoctls += other.numIoctls;
+        ioctl_us += other.ioctl_us;
+        numCmds += other.numCmds;
+        numBytes += other.numBytes;
+        numBytesToDev += other.numBytesToDev;
+        numBytesFromDev += other.numBytesFromDev;
+        numAllocs += other.numAllocs;
+        numAllocBytes += other.numAllocBytes;
+        std::map<unsigned long, IoctlCounters>::const_iterator i;
+        for (i = other.ioctls.begin(); i != other.ioctls.end(); i++) {
+            IoctlCounters &mine = ioctls[i->first];
+            mine.num += i->second.num;
+            mine.usec += i->second.usec;
+        }
+        return *this;
+    }
+
+    /// @return The counters accrued since 'before' was snapshot
+    IoCounters operator-(const IoCounters &before) const
+    {
+        IoCounters delta;
+        delta.numIoctls = (numIoctls - before.numIoctls);
+        delta.ioctl_us = (ioctl_us - before.ioctl_us);
+        delta.numCmds = (numCmds - before.numCmds);
+        delta.numBytes = (numBytes - before.numBytes);
+        delta.numBytesToDev = (numBytesToDev - before.numBytesToDev);
+        delta.numBytesFromDev = (numBytesFromDev - before.numBytesFromDev);
+        delta.numAllocs = (numAllocs - before.numAllocs);
+        delta.numAllocBytes = (numAllocBytes - before.numAllocBytes);
+        std::map<unsigned long, IoctlCounters>::const_iterator i, b;
+        for (i = ioctls.begin(); i != ioctls.end(); i++) {
+            IoctlCounters work = i->second;
+            if ((b = before.ioctls.find(i->first)) != before.ioctls.end()) {
+                work.num -= b->second.num;
+                work.usec -= b->second.usec;
+            }
+            if (work.num)
+                delta.ioctls[i->first] = work;
+        }
+        return delta;
+    }
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It is entirely implemented within this header, therefore
+* all static libraries can account into the same counters without regard to
+* their link order.
+*
+* @note This class will not throw exceptions.
+*/
+class IoStats
+{
+public:
+    /// @return The counters to read or snapshot
+    static IoCounters &Get()
+        { static IoCounters counters; return counters; }
+
+    /**
+     * Every ioctl() issued to dnvme must be issued through this method, it
+     * is also where IoTrace records them.
+     * @param fd Pass the file descriptor to the device under test
+     * @param request Pass the NVME_IOCTL_* request
+     * @param arg Pass the request's argument, a pointer or a value
+     * @return The return value of ioctl()
+     */
+    template <class T>
+    static int Ioctl(int fd, unsigned long request, T arg)
+    {
+        struct timeval start, end;
+        gettimeofday(&start, NULL);
+        int rc = ioctl(fd, request, arg);
+        gettimeofday(&end, NULL);
+
+        uint64_t usec = (((end.tv_sec - start.tv_sec) * 1000000LL) +
+            (end.tv_usec - start.tv_usec));
+        IoCounters &counters = Get();
+        IoctlCounters &req = counters.ioctls[request];
+        counters.numIoctls++;
+        counters.ioctl_us += usec;
+        req.num++;
+        req.usec += usec;
+        if (IoTrace::IsTracing()) {
+            IoTrace::Record(request, rc, ((start.tv_sec * 1000000ULL) +
+                start.tv_usec), usec, arg);
+        }
+        return rc;
+    }
+
+    /**
+     * Account for a cmd issued into a SQ
+     * @param numBytes Pass the size of the cmd's PRP data buffer
+     * @param toDev Pass true if the data is written to the DUT
+     * @param fromDev Pass true if the data is read from the DUT
+     */
+    static void CountCmd(uint64_t numBytes, bool toDev, bool fromDev)
+    {
+        IoCounters &counters = Get();
+        counters.numCmds++;
+        counters.numBytes += numBytes;
+        if (toDev)
+            counters.numBytesToDev += numBytes;
+        if (fromDev)
+            counters.numBytesFromDev += numBytes;
+    }
+
+    /**
+     * Account for a memory allocation backing a MemBuffer
+     * @param numBytes Pass the size of the allocation
+     */
+    static void CountAlloc(uint64_t numBytes)
+        { Get().numAllocs++; Get().numAllocBytes += numBytes; }
+
+    /**
+     * @param request Pass the NVME_IOCTL_* request
+     * @return The name of the request, i.e. "NVME_IOCTL_REAP"
+     */
+    static const char *IoctlName(unsigned long request)
+    {
+        #define ZZ(a)       { a, #a },
+        static const struct { unsigned long request; const char *name; }
+            names[] = { IOCTL_TABLE };
+        #undef ZZ
+        for (size_t i = 0; i < (sizeof(names) / sizeof(names[0])); i++) {
+            if (names[i].request == request)
+                return names[i].name;
+        }
+        return "NVME_IOCTL_UNKNOWN";
+    }
+
+
+private:
+    IoStats();
+    virtual ~IoStats();
+};
+
+
+#endif
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <map>
+#include "tnvme.h"
+#include "dnvme.h"
+#include "ioTrace.h"
+#include "ioStats.h"
+#include "../Cmds/prpData.h"
+#include "../Queues/ce.h"
+
+/// Max time to reap the CE's a trace captured before declaring divergence
+#define REPLAY_REAP_TIMEOUT_us      10000000
+
+/// Admin opcodes whose data buffer backs IOQ memory for the IOQ's lifetime
+#define OPC_CREATE_IOSQ             0x01
+#define OPC_CREATE_IOCQ             0x05
+
+#define CMD_SIZE                    64
+
+FILE *IoTrace::mFp = NULL;
+uint64_t IoTrace::mStart_us = 0;
+
+
+static uint64_t
+NowUsec()
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return ((now.tv_sec * 1000000ULL) + now.tv_usec);
+}
+
+
+IoTrace::IoTrace()
+{
+}
+
+
+IoTrace::~IoTrace()
+{
+}
+
+
+bool
+IoTrace::Start(string filename)
+{
+    struct IoTraceHdr hdr;
+
+    Stop();
+    if ((mFp = fopen(filename.c_str(), "w")) == NULL) {
+        LOG_ERR("Unable to open trace file: %s", filename.c_str());
+        return false;
+    }
+
+    memcpy(hdr.magic, IOTRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version = IOTRACE_VERSION;
+    hdr.recSize = sizeof(struct IoTraceRec);
+    if (fwrite(&hdr, sizeof(hdr), 1, mFp) != 1) {
+        LOG_ERR("Unable to write trace file: %s", filename.c_str());
+        Stop();
+        return false;
+    }
+    mStart_us = NowUsec();
+    return true;
+}
+
+
+void
+IoTrace::Stop()
+{
+    if (mFp == NULL)
+        return;
+    if (fclose(mFp) != 0)
+        LOG_ERR("Unable to close trace file, it may be truncated");
+    mFp = NULL;
+}
+
+
+void
+IoTrace::Append(unsigned long request, int rc, uint64_t start_us,
+    uint64_t dur_us, const void *arg, unsigned long argVal)
+{
+    struct IoTraceRec rec;
+    const void *data[2] = { NULL, NULL };
+    uint32_t dataLen[2] = { 0, 0 };
+
+    if (mFp == NULL)
+        return;
+
+    if (arg != NULL) {
+        switch (request) {
+        case NVME_IOCTL_SEND_64B_CMD: {
+            const struct nvme_64b_send *send =
+                (const struct nvme_64b_send *)arg;
+            data[0] = send->cmd_buf_ptr;
+            dataLen[0] = CMD_SIZE;
+            if ((send->data_buf_ptr != NULL) &&
+                ((send->data_dir == DATADIR_TO_DEVICE) ||
+                (send->data_dir == DATADIR_BIDIRECTIONAL))) {
+                data[1] = send->data_buf_ptr;
+                dataLen[1] = send->data_buf_size;
+            }
+            break;
+        }
+        case NVME_IOCTL_REAP: {
+            const struct nvme_reap *reap = (const struct nvme_reap *)arg;
+            if (rc >= 0) {
+                data[0] = reap->buffer;
+                dataLen[0] = (reap->num_reaped * sizeof(union CE));
+            }
+            break;
+        }
+        case NVME_IOCTL_READ_GENERIC:
+        case NVME_IOCTL_WRITE_GENERIC: {
+            const struct rw_generic *rw = (const struct rw_generic *)arg;
+            if ((rc >= 0) || (request == NVME_IOCTL_WRITE_GENERIC)) {
+                data[0] = rw->buffer;
+                dataLen[0] = rw->nBytes;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    rec.request = request;
+    rec.start_us = (start_us - mStart_us);
+    rec.dur_us = dur_us;
+    rec.rc = rc;
+    rec.argLen = ((arg == NULL) ? 0 : _IOC_SIZE(request));
+    rec.dataLen = (dataLen[0] + dataLen[1]);
+    rec.argVal = ((arg == NULL) ? argVal : 0);
+
+    bool ok = (fwrite(&rec, sizeof(rec), 1, mFp) == 1);
+    if (ok && rec.argLen)
+        ok = (fwrite(arg, rec.argLen, 1, mFp) == 1);
+    for (int i = 0; ok && (i < 2); i++) {
+        if (dataLen[i])
+            ok = (fwrite(data[i], dataLen[i], 1, mFp) == 1);
+    }
+    if (ok == false) {
+        LOG_ERR("Unable to write trace file, tracing stopped");
+        Stop();
+    }
+}
+
+
+/**
+ * Allocate a page aligned buffer suitable for dnvme to map as PRP data.
+ * @param size Pass the size of the buffer
+ * @param data Pass the data to initialize it with, NULL to zero it
+ * @return The buffer, NULL if the allocation failed
+ */
+static uint8_t *
+AllocData(size_t size, const uint8_t *data)
+{
+    uint8_t *buf;
+
+    if (posix_memalign((void **)&buf, sysconf(_SC_PAGESIZE), size) != 0)
+        return NULL;
+    if (data != NULL)
+        memcpy(buf, data, size);
+    else
+        memset(buf, 0, size);
+    return buf;
+}
+
+
+bool
+IoTrace::Replay(int fd, string filename, bool maxSpeed)
+{
+    FILE *fp;
+    struct IoTraceHdr hdr;
+    struct IoTraceRec rec;
+    vector<uint8_t> arg;
+    vector<uint8_t> data;
+    // Data buffers of cmds in flight, keyed by (SQID << 16) | CID
+    map<uint32_t, uint8_t *> inFlight;
+    // Data buffers backing IOQ memory, they live until the DUT is disabled
+    vector<uint8_t *> ioqMem;
+    uint64_t numRecs = 0;
+    uint64_t numSkipped = 0;
+    uint64_t numDiverged = 0;
+    uint64_t captured_us = 0;
+    bool intact = true;
+    int rc;
+
+    if ((fp = fopen(filename.c_str(), "r")) == NULL) {
+        LOG_ERR("Unable to open trace file: %s", filename.c_str());
+        return false;
+    }
+    if ((fread(&hdr, sizeof(hdr), 1, fp) != 1) ||
+        (memcmp(hdr.magic, IOTRACE_MAGIC, sizeof(hdr.magic)) != 0) ||
+        (hdr.version != IOTRACE_VERSION) ||
+        (hdr.recSize != sizeof(struct IoTraceRec))) {
+        LOG_ERR("File %s is not a compatible trace", filename.c_str());
+        fclose(fp);
+        return false;
+    }
+
+    LOG_NRM("Replaying trace %s at %s speed", filename.c_str(),
+        (maxSpeed ? "max" : "original"));
+    uint64_t start_us = NowUsec();
+    while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+        arg.resize(rec.argLen);
+        data.resize(rec.dataLen);
+        if ((rec.argLen && (fread(&arg[0], rec.argLen, 1, fp) != 1)) ||
+            (rec.dataLen && (fread(&data[0], rec.dataLen, 1, fp) != 1)) ||
+            (rec.argLen && (rec.argLen != _IOC_SIZE(rec.request)))) {
+            LOG_ERR("Trace is truncated or corrupt at record %llu",
+                (unsigned long long)numRecs);
+            intact = false;
+            break;
+        }
+        numRecs++;
+        captured_us = (rec.start_us + rec.dur_us);
+
+        if (maxSpeed == false) {
+            uint64_t elapsed_us = (NowUsec() - start_us);
+            if (rec.start_us > elapsed_us)
+                usleep(rec.start_us - elapsed_us);
+        }
+
+        switch (rec.request) {
+        case NVME_IOCTL_GET_Q_METRICS:
+        case NVME_IOCTL_DUMP_METRICS:
+        case NVME_IOCTL_GET_DRIVER_METRICS:
+        case NVME_IOCTL_GET_DEVICE_METRICS:
+        case NVME_IOCTL_MARK_SYSLOG:
+        case NVME_IOCTL_REAP_INQUIRY:
+            // Informational only, reaping below polls on its own
+            numSkipped++;
+            continue;
+
+        case NVME_IOCTL_SEND_64B_CMD: {
+            struct nvme_64b_send send;
+            memcpy(&send, &arg[0], sizeof(send));
+            uint8_t *buf = NULL;
+            if (send.data_buf_size) {
+                const uint8_t *init = NULL;
+                if (rec.dataLen >= (CMD_SIZE + send.data_buf_size))
+                    init = &data[CMD_SIZE];
+                if ((buf = AllocData(send.data_buf_size, init)) == NULL) {
+                    LOG_ERR("Unable to allocate data buffer");
+                    intact = false;
+                    goto OUT;
+                }
+            }
+            send.cmd_buf_ptr = &data[0];
+            send.data_buf_ptr = buf;
+            rc = IoStats::Ioctl(fd, NVME_IOCTL_SEND_64B_CMD, &send);
+            if (rc < 0) {
+                free(buf);
+            } else if ((send.q_id == 0) && ((data[0] == OPC_CREATE_IOSQ) ||
+                (data[0] == OPC_CREATE_IOCQ))) {
+                ioqMem.push_back(buf);
+            } else {
+                inFlight[((uint32_t)send.q_id << 16) | send.unique_id] = buf;
+            }
+            break;
+        }
+
+        case NVME_IOCTL_REAP: {
+            struct nvme_reap reap;
+            memcpy(&reap, &arg[0], sizeof(reap));
+            uint32_t want = reap.num_reaped;
+            uint32_t got = 0;
+            if (want == 0) {
+                numSkipped++;
+                continue;
+            }
+            vector<uint8_t> ces(want * sizeof(union CE));
+            uint64_t reapStart_us = NowUsec();
+            rc = 0;
+            while ((got < want) &&
+                ((NowUsec() - reapStart_us) < REPLAY_REAP_TIMEOUT_us)) {
+                reap.elements = (want - got);
+                reap.size = (reap.elements * sizeof(union CE));
+                reap.buffer = &ces[got * sizeof(union CE)];
+                if ((rc = IoStats::Ioctl(fd, NVME_IOCTL_REAP, &reap)) < 0)
+                    break;
+                got += reap.num_reaped;
+                if (reap.num_reaped == 0)
+                    usleep(10);
+            }
+            for (uint32_t i = 0; i < got; i++) {
+                union CE *ce = (union CE *)&ces[i * sizeof(union CE)];
+                map<uint32_t, uint8_t *>::iterator buf = inFlight.find(
+                    ((uint32_t)ce->n.SQID << 16) | ce->n.CID);
+                if (buf != inFlight.end()) {
+                    free(buf->second);
+                    inFlight.erase(buf);
+                }
+                union CE *was = (union CE *)&data[i * sizeof(union CE)];
+                if ((i < (rec.dataLen / sizeof(union CE))) &&
+                    (ce->n.SF.t.status != was->n.SF.t.status)) {
+                    LOG_WARN("Record %llu: CE status 0x%04X, captured 0x%04X",
+                        (unsigned long long)numRecs, ce->n.SF.t.status,
+                        was->n.SF.t.status);
+                    numDiverged++;
+                }
+            }
+            if (got != want) {
+                LOG_WARN("Record %llu: reaped %d CE(s), captured %d",
+                    (unsigned long long)numRecs, got, want);
+                numDiverged++;
+            }
+            break;
+        }
+
+        case NVME_IOCTL_READ_GENERIC:
+        case NVME_IOCTL_WRITE_GENERIC: {
+            struct rw_generic rw;
+            memcpy(&rw, &arg[0], sizeof(rw));
+            vector<uint8_t> regs(rw.nBytes);
+            if ((rec.request == NVME_IOCTL_WRITE_GENERIC) &&
+                (rec.dataLen >= rw.nBytes) && rw.nBytes) {
+                memcpy(&regs[0], &data[0], rw.nBytes);
+            }
+            rw.buffer = (rw.nBytes ? &regs[0] : NULL);
+            rc = IoStats::Ioctl(fd, rec.request, &rw);
+            break;
+        }
+
+        default:
+            if (rec.argLen) {
+                rc = IoStats::Ioctl(fd, rec.request, &arg[0]);
+            } else {
+                rc = IoStats::Ioctl(fd, rec.request, rec.argVal);
+                if (rec.request == NVME_IOCTL_DEVICE_STATE) {
+                    // Every Q and therefore every cmd is gone
+                    for (size_t i = 0; i < ioqMem.size(); i++)
+                        free(ioqMem[i]);
+                    ioqMem.clear();
+                    map<uint32_t, uint8_t *>::iterator buf;
+                    for (buf = inFlight.begin(); buf != inFlight.end(); buf++)
+                        free(buf->second);
+                    inFlight.clear();
+                }
+            }
+            break;
+        }
+
+        if ((rc < 0) != (rec.rc < 0)) {
+            LOG_WARN("Record %llu: %s returned %d, captured %d",
+                (unsigned long long)numRecs, IoStats::IoctlName(rec.request),
+                rc, rec.rc);
+            numDiverged++;
+        }
+    }
+
+OUT:
+    fclose(fp);
+    for (size_t i = 0; i < ioqMem.size(); i++)
+        free(ioqMem[i]);
+    map<uint32_t, uint8_t *>::iterator buf;
+    for (buf = inFlight.begin(); buf != inFlight.end(); buf++)
+        free(buf->second);
+
+    LOG_NRM("Replayed %llu of %llu ioctl(s), %llu diverged, took %llu ms, "
+        "captured %llu ms", (unsigned long long)(numRecs - numSkipped),
+        (unsigned long long)numRecs, (unsigned long long)numDiverged,
+        (unsigned long long)((NowUsec() - start_us) / 1000),
+        (unsigned long long)(captured_us / 1000));
+    return (intact && (numDiverged == 0));
+}
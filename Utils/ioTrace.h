@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _IOTRACE_H_
+#define _IOTRACE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+
+#define IOTRACE_MAGIC               "TNVMETRC"
+#define IOTRACE_VERSION             1
+
+
+/**
+ * A trace file starts with this header and is followed by IoTraceRec's, all
+ * fields are in host byte order.
+ */
+struct IoTraceHdr {
+    char     magic[8];      // IOTRACE_MAGIC
+    uint32_t version;       // IOTRACE_VERSION
+    uint32_t recSize;       // sizeof(struct IoTraceRec)
+} __attribute__((__packed__));
+
+/**
+ * A record per ioctl() issued to dnvme, the record is immediately followed
+ * by argLen bytes of the marshalled argument and then dataLen bytes of the
+ * request specific data described below.
+ */
+struct IoTraceRec {
+    uint64_t request;       // NVME_IOCTL_*
+    uint64_t start_us;      // issued at this time since the trace started
+    uint32_t dur_us;        // time spent within ioctl()
+    int32_t  rc;            // value returned from ioctl()
+    uint32_t argLen;        // 0 indicates the arg was passed by value
+    uint32_t dataLen;
+    uint64_t argVal;        // the arg passed by value, when argLen == 0
+} __attribute__((__packed__));
+// The arg struct is captured as it was upon returning from ioctl(), thus it
+// contains both the inputs and outputs. Pointers within are meaningless, the
+// data they reference is captured as follows:
+//   NVME_IOCTL_SEND_64B_CMD: the 64B cmd, followed by the data buffer when
+//                            written to the DUT
+//   NVME_IOCTL_REAP:         the reaped CE's
+//   NVME_IOCTL_*_GENERIC:    the register data read or written
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. While started every ioctl() issued by IoStats::Ioctl() is
+* appended to a compact binary trace file, see cmd line option --trace.
+* Replay() reissues a trace against the DUT without the test logic which
+* generated it, see cmd line option --replay.
+*
+* @note This class will not throw exceptions.
+*/
+class IoTrace
+{
+public:
+    IoTrace();
+    virtual ~IoTrace();
+
+    /**
+     * Start tracing into a file, truncating any previous content.
+     * @param filename Pass the name of the trace file to create
+     * @return true upon success, otherwise false
+     */
+    static bool Start(std::string filename);
+    static void Stop();
+    static bool IsTracing() { return (mFp != NULL); }
+
+    /**
+     * Append an ioctl() whose arg was a pointer to a struct.
+     * @param request Pass the NVME_IOCTL_* request
+     * @param rc Pass the value returned by ioctl()
+     * @param start_us Pass the time, in usec since the epoch, it was issued
+     * @param dur_us Pass the time spent within ioctl()
+     * @param arg Pass the arg which was passed to ioctl()
+     */
+    template <class T>
+    static void Record(unsigned long request, int rc, uint64_t start_us,
+        uint64_t dur_us, T *arg)
+        { Append(request, rc, start_us, dur_us, arg, 0); }
+
+    /**
+     * Append an ioctl() whose arg was passed by value.
+     */
+    static void Record(unsigned long request, int rc, uint64_t start_us,
+        uint64_t dur_us, unsigned long arg)
+        { Append(request, rc, start_us, dur_us, NULL, arg); }
+
+    /**
+     * Reissue the ioctl()'s of a trace file against the DUT. Requests which
+     * only retrieve information are not reissued. Data buffers are recreated
+     * from the captured data, CE's are reaped until as many as captured have
+     * been reaped and their status is compared to the captured status.
+     * @param fd Pass the file descriptor to the device under test
+     * @param filename Pass the name of the trace file to replay
+     * @param maxSpeed Pass true to issue requests back to back, false to
+     *        preserve the original time between them
+     * @return true if the DUT behaved as captured, otherwise false
+     */
+    static bool Replay(int fd, std::string filename, bool maxSpeed);
+
+
+private:
+    static FILE *mFp;
+    static uint64_t mStart_us;
+
+    static void Append(unsigned long request, int rc, uint64_t start_us,
+        uint64_t dur_us, const void *arg, unsigned long argVal);
+};
+
+
+#endif
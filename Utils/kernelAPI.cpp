@@ -22,9 +22,8 @@
 #include <errno.h>
 #include "kernelAPI.h"
 #include "globals.h"
-
-#define FILENAME_FLAGS         (O_RDWR | O_TRUNC | O_CREAT)
-#define FILENAME_MODE          (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH)
+#include "ioStats.h"
+#include "dumpArchive.h"
 
 
 KernelAPI::KernelAPI()
@@ -70,15 +69,34 @@ KernelAPI::DumpKernelMetrics(DumpFilename filename)
     struct nvme_file dumpMe = { (short unsigned int)filename.length(), filename.c_str() };
 
     LOG_NRM("Dump dnvme metrics to filename: %s", filename.c_str());
-    if ((rc = ioctl(gDutFd, NVME_IOCTL_DUMP_METRICS, &dumpMe)) < 0)
+    if ((rc = IoStats::Ioctl(gDutFd, NVME_IOCTL_DUMP_METRICS, &dumpMe)) < 0)
         throw FrmwkEx(HERE, "Unable to dump dnvme metrics, err code = %d", rc);
+
+    // dnvme writes the file itself, move its contents into the archive
+    if (DumpArchive::IsOpen()) {
+        FILE *in, *out;
+        char buf[4096];
+        size_t len;
+
+        if ((in = fopen(filename.c_str(), "r")) == NULL)
+            return;
+        if ((out = DumpArchive::OpenDump(filename, true)) == NULL) {
+            fclose(in);
+            return;
+        }
+        while ((len = fread(buf, 1, sizeof(buf), in)) != 0)
+            fwrite(buf, 1, len, out);
+        fclose(in);
+        DumpArchive::CloseDump(out);
+        unlink(filename.c_str());
+    }
 }
 
 
 void
 KernelAPI::DumpCtrlrSpaceRegs(DumpFilename filename, bool verbose)
 {
-    int fd;
+    FILE *fp;
     string work;
     uint64_t value = 0;
     string outFile;
@@ -86,7 +104,7 @@ KernelAPI::DumpCtrlrSpaceRegs(DumpFilename filename, bool verbose)
 
 
     LOG_NRM("Dump ctrlr regs to filename: %s", filename.c_str());
-    if ((fd = open(filename.c_str(), FILENAME_FLAGS, FILENAME_MODE)) == -1)
+    if ((fp = DumpArchive::OpenDump(filename, true)) == NULL)
         throw FrmwkEx(HERE, "file=%s: %s", filename.c_str(), strerror(errno));
 
     // Read all registers in ctrlr space
@@ -105,7 +123,7 @@ KernelAPI::DumpCtrlrSpaceRegs(DumpFilename filename, bool verbose)
                 work += gRegisters->FormatRegister(NVMEIO_BAR01,
                     ctlMetrics[i].size, ctlMetrics[i].offset, buffer);
                 work += "\n";
-                write(fd, work.c_str(), work.size());
+                fputs(work.c_str(), fp);
             }
             delete [] buffer;
         } else if (gRegisters->Read((CtlSpc)i, value, verbose) == false) {
@@ -115,15 +133,15 @@ KernelAPI::DumpCtrlrSpaceRegs(DumpFilename filename, bool verbose)
             work += gRegisters->FormatRegister(ctlMetrics[i].size,
                 ctlMetrics[i].desc, value);
             work += "\n";
-            write(fd, work.c_str(), work.size());
+            fputs(work.c_str(), fp);
         }
     }
 
-    close(fd);
+    DumpArchive::CloseDump(fp);
     return;
 
 ERROR_OUT:
-    close(fd);
+    DumpArchive::CloseDump(fp);
     throw FrmwkEx(HERE);
 }
 
@@ -131,7 +149,7 @@ ERROR_OUT:
 void
 KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
 {
-    int fd;
+    FILE *fp;
     string work;
     uint64_t value;
     const PciSpcType *pciMetrics = gRegisters->GetPciMetrics();
@@ -139,12 +157,12 @@ KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
 
 
     LOG_NRM("Dump PCI regs to filename: %s", filename.c_str());
-    if ((fd = open(filename.c_str(), FILENAME_FLAGS, FILENAME_MODE)) == -1)
+    if ((fp = DumpArchive::OpenDump(filename, true)) == NULL)
         throw FrmwkEx(HERE, "file=%s: %s", filename.c_str(), strerror(errno));
 
     // Traverse the PCI header registers
     work = "PCI header registers\n";
-    write(fd, work.c_str(), work.size());
+    fputs(work.c_str(), fp);
     for (int j = 0; j < PCISPC_FENCE; j++) {
         if (!gRegisters->ValidSpecRev(pciMetrics[j].specRev))
             continue;
@@ -153,7 +171,7 @@ KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
         if (pciMetrics[j].cap == PCICAP_FENCE) {
             if (gRegisters->Read((PciSpc)j, value, verbose) == false)
                 goto ERROR_OUT;
-            RegToFile(fd, pciMetrics[j], value);
+            RegToFile(fp, pciMetrics[j], value);
         }
     }
 
@@ -181,7 +199,7 @@ KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
                 pciCap->at(i));
             goto ERROR_OUT;
         }
-        write(fd, work.c_str(), work.size());
+        fputs(work.c_str(), fp);
 
         // Read all registers assoc with the discovered capability
         for (int j = 0; j < PCISPC_FENCE; j++) {
@@ -202,7 +220,7 @@ KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
                         work += gRegisters->FormatRegister(NVMEIO_PCI_HDR,
                             pciMetrics[j].size, pciMetrics[j].offset, buffer);
                         work += "\n";
-                        write(fd, work.c_str(), work.size());
+                        fputs(work.c_str(), fp);
                     }
                     delete [] buffer;
                     if (err)
@@ -211,29 +229,29 @@ KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
                     false) {
                     goto ERROR_OUT;
                 } else {
-                    RegToFile(fd, pciMetrics[j], value);
+                    RegToFile(fp, pciMetrics[j], value);
                 }
             }
         }
     }
 
-    close(fd);
+    DumpArchive::CloseDump(fp);
     return;
 
 ERROR_OUT:
-    close(fd);
+    DumpArchive::CloseDump(fp);
     throw FrmwkEx(HERE);
 }
 
 
 void
-KernelAPI::RegToFile(int fd, const PciSpcType regMetrics, uint64_t value)
+KernelAPI::RegToFile(FILE *fp, const PciSpcType regMetrics, uint64_t value)
 {
     string work = "  ";    // indent reg values within each capability
     work += gRegisters->FormatRegister(regMetrics.size,
         regMetrics.desc, value);
     work += "\n";
-    write(fd, work.c_str(), work.size());
+    fputs(work.c_str(), fp);
 }
 
 
@@ -269,7 +287,7 @@ KernelAPI::WriteToDnvmeLog(string log)
     struct nvme_logstr logMe = { (short unsigned int)log.length(), log.c_str() };
 
     LOG_NRM("Write custom string to dnvme's log output: \"%s\"", log.c_str());
-    if ((rc = ioctl(gDutFd, NVME_IOCTL_MARK_SYSLOG, &logMe)) < 0) {
+    if ((rc = IoStats::Ioctl(gDutFd, NVME_IOCTL_MARK_SYSLOG, &logMe)) < 0) {
         throw FrmwkEx(HERE, "Unable to log custom string to dnvme, err = %d",
             rc);
     }
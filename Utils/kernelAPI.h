@@ -91,7 +91,7 @@ public:
 
 
 private:
-    static void RegToFile(int fd, const PciSpcType regMetrics, uint64_t value);
+    static void RegToFile(FILE *fp, const PciSpcType regMetrics, uint64_t value);
 };
 
 
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "lbaPattern.h"
+#include "../Exception/frmwkEx.h"
+
+
+static inline uint64_t
+Rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+
+static inline uint64_t
+SplitMix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+uint64_t LbaPattern::mSeed = 0;
+uint32_t LbaPattern::mGeneration = 0;
+
+
+LbaPattern::LbaPattern()
+{
+}
+
+
+LbaPattern::~LbaPattern()
+{
+}
+
+
+void
+LbaPattern::SeedState(uint64_t state[4], const LbaPatKey &key, uint64_t lba)
+{
+    uint64_t mix = key.seed ^ SplitMix64(lba) ^
+        (((uint64_t)key.nsid << 32) | key.generation);
+
+    for (int i = 0; i < 4; i++)
+        state[i] = SplitMix64(mix);
+}
+
+
+uint64_t
+LbaPattern::Next(uint64_t state[4])
+{
+    uint64_t result = Rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = Rotl(state[3], 45);
+    return result;
+}
+
+
+void
+LbaPattern::CheckSizes(uint32_t lbaDataSize, uint32_t &stride)
+{
+    if (lbaDataSize < LBAPAT_HDR_SIZE) {
+        throw FrmwkEx(HERE, "LBA data size %d < pattern header size %d",
+            lbaDataSize, LBAPAT_HDR_SIZE);
+    }
+    if (stride == 0)
+        stride = lbaDataSize;
+    else if (stride < lbaDataSize)
+        throw FrmwkEx(HERE, "Stride %d < LBA data size %d", stride,
+            lbaDataSize);
+}
+
+
+void
+LbaPattern::Fill(uint8_t *buf, const LbaPatKey &key, uint64_t slba,
+    uint32_t numLBA, uint32_t lbaDataSize, uint32_t stride)
+{
+    uint64_t state[4];
+    uint64_t val;
+
+    CheckSizes(lbaDataSize, stride);
+    for (uint32_t i = 0; i < numLBA; i++) {
+        uint8_t *blk = (buf + ((size_t)i * stride));
+        Hdr hdr = { LBAPAT_MAGIC, key.nsid, (slba + i), key.generation, 0,
+            key.seed };
+        memcpy(blk, &hdr, sizeof(hdr));
+
+        SeedState(state, key, (slba + i));
+        uint32_t off = LBAPAT_HDR_SIZE;
+        for (; (off + sizeof(val)) <= lbaDataSize; off += sizeof(val)) {
+            val = Next(state);
+            memcpy((blk + off), &val, sizeof(val));
+        }
+        if (off < lbaDataSize) {
+            val = Next(state);
+            memcpy((blk + off), &val, (lbaDataSize - off));
+        }
+    }
+}
+
+
+void
+LbaPattern::Fill(SharedMemBufferPtr buf, const LbaPatKey &key, uint64_t slba,
+    uint32_t numLBA, uint32_t lbaDataSize, uint32_t stride)
+{
+    if (numLBA == 0)
+        return;     // (numLBA - 1) below would wrap
+    CheckSizes(lbaDataSize, stride);
+    if (((uint64_t)(numLBA - 1) * stride + lbaDataSize) > buf->GetBufSize()) {
+        throw FrmwkEx(HERE, "Buffer of %d bytes cannot hold %d LBA's",
+            buf->GetBufSize(), numLBA);
+    }
+    Fill(buf->GetBuffer(), key, slba, numLBA, lbaDataSize, stride);
+}
+
+
+LbaPatStatus
+LbaPattern::Check(const uint8_t *blk, const LbaPatKey &key, uint64_t lba,
+    uint32_t lbaDataSize, uint32_t &badOffset)
+{
+    Hdr hdr;
+    uint64_t state[4];
+    uint64_t val;
+
+    badOffset = 0;
+    memcpy(&hdr, blk, sizeof(hdr));
+    if (hdr.magic != LBAPAT_MAGIC)
+        return LBAPAT_NO_HDR;
+    else if (hdr.seed != key.seed)
+        return LBAPAT_FOREIGN_SEED;
+    else if (hdr.nsid != key.nsid)
+        return LBAPAT_WRONG_NSID;
+    else if (hdr.lba != lba)
+        return LBAPAT_MISDIRECTED;
+    else if (hdr.generation != key.generation)
+        return LBAPAT_STALE;
+
+    SeedState(state, key, lba);
+    for (uint32_t off = LBAPAT_HDR_SIZE; off < lbaDataSize;
+        off += sizeof(val)) {
+
+        uint32_t len = MIN((uint32_t)sizeof(val), (lbaDataSize - off));
+        val = Next(state);
+        if (memcmp((blk + off), &val, len) != 0) {
+            for (badOffset = off; badOffset < (off + len); badOffset++) {
+                if (blk[badOffset] != ((uint8_t *)&val)[badOffset - off])
+                    break;
+            }
+            return LBAPAT_CORRUPT;
+        }
+    }
+    return LBAPAT_OK;
+}
+
+
+bool
+LbaPattern::Verify(const uint8_t *buf, const LbaPatKey &key, uint64_t slba,
+    uint32_t numLBA, uint32_t lbaDataSize, uint32_t stride)
+{
+    uint32_t badOffset;
+
+    CheckSizes(lbaDataSize, stride);
+    for (uint32_t i = 0; i < numLBA; i++) {
+        const uint8_t *blk = (buf + ((size_t)i * stride));
+        LbaPatStatus status = Check(blk, key, (slba + i), lbaDataSize,
+            badOffset);
+        if (status == LBAPAT_OK)
+            continue;
+
+        Hdr hdr;
+        memcpy(&hdr, blk, sizeof(hdr));
+        LOG_ERR("NSID %d LBA 0x%016llX gen %d: %s", key.nsid,
+            (unsigned long long)(slba + i), key.generation,
+            StatusStr(status));
+        if (status == LBAPAT_CORRUPT) {
+            LOG_ERR("1st miscompare at byte offset 0x%04X", badOffset);
+        } else if (status != LBAPAT_NO_HDR) {
+            LOG_ERR("Found NSID %d LBA 0x%016llX gen %d seed 0x%016llX",
+                hdr.nsid, (unsigned long long)hdr.lba, hdr.generation,
+                (unsigned long long)hdr.seed);
+        }
+        return false;
+    }
+    return true;
+}
+
+
+bool
+LbaPattern::Verify(SharedMemBufferPtr buf, const LbaPatKey &key,
+    uint64_t slba, uint32_t numLBA, uint32_t lbaDataSize, uint32_t stride)
+{
+    if (numLBA == 0)
+        return true;    // (numLBA - 1) below would wrap
+    CheckSizes(lbaDataSize, stride);
+    if (((uint64_t)(numLBA - 1) * stride + lbaDataSize) > buf->GetBufSize()) {
+        throw FrmwkEx(HERE, "Buffer of %d bytes cannot hold %d LBA's",
+            buf->GetBufSize(), numLBA);
+    }
+    return Verify(buf->GetBuffer(), key, slba, numLBA, lbaDataSize, stride);
+}
+
+
+const char *
+LbaPattern::StatusStr(LbaPatStatus status)
+{
+    switch (status) {
+    case LBAPAT_OK:             return "content as expected";
+    case LBAPAT_NO_HDR:         return "never written by this pattern";
+    case LBAPAT_MISDIRECTED:    return "misdirected, holds another LBA";
+    case LBAPAT_WRONG_NSID:     return "holds another namspc's LBA";
+    case LBAPAT_STALE:          return "stale, holds another generation";
+    case LBAPAT_FOREIGN_SEED:   return "written by another run";
+    case LBAPAT_CORRUPT:        return "corrupt data";
+    }
+    return "unknown";
+}
+
+
+bool
+LbaPattern::GetKey(const uint8_t *blk, LbaPatKey &key, uint64_t &lba)
+{
+    Hdr hdr;
+
+    memcpy(&hdr, blk, sizeof(hdr));
+    if (hdr.magic != LBAPAT_MAGIC)
+        return false;
+
+    key.seed = hdr.seed;
+    key.nsid = hdr.nsid;
+    key.generation = hdr.generation;
+    lba = hdr.lba;
+    return true;
+}
+
+
+LbaPatKey
+LbaPattern::NewKey(uint32_t nsid)
+{
+    LbaPatKey key;
+
+    if (mSeed == 0) {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        uint64_t mix = (((uint64_t)now.tv_sec << 20) ^ now.tv_usec ^
+            ((uint64_t)getpid() << 40));
+        mSeed = SplitMix64(mix);
+        LOG_NRM("LBA pattern seed for this run: 0x%016llX",
+            (unsigned long long)mSeed);
+    }
+
+    key.seed = mSeed;
+    key.nsid = nsid;
+    key.generation = ++mGeneration;
+    return key;
+}
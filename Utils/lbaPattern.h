@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _LBAPATTERN_H_
+#define _LBAPATTERN_H_
+
+#include "tnvme.h"
+#include "../Singletons/memBuffer.h"
+
+/// Number of bytes at the start of each LBA identifying its content
+#define LBAPAT_HDR_SIZE             32
+#define LBAPAT_MAGIC                0x4D564E54      // "TNVM"
+
+/// Everything needed to regenerate the content of any LBA
+struct LbaPatKey {
+    uint64_t    seed;               // Chosen per run, i.e. from time of day
+    uint32_t    nsid;
+    uint32_t    generation;         // Bump each time an LBA is rewritten
+};
+
+/// Outcome of checking 1 LBA against its expected content
+typedef enum {
+    LBAPAT_OK,
+    LBAPAT_NO_HDR,                  // Never written with this pattern
+    LBAPAT_MISDIRECTED,             // Holds the content of another LBA
+    LBAPAT_WRONG_NSID,              // Holds the content of another namspc
+    LBAPAT_STALE,                   // Holds the content of another generation
+    LBAPAT_FOREIGN_SEED,            // Written by another run
+    LBAPAT_CORRUPT                  // Header matches, data does not
+} LbaPatStatus;
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It produces pseudo-random data, xoshiro256**, which is
+* unique to every (seed, namspc, LBA, generation). Each LBA starts with a
+* header recording that tuple followed by the generator's output, so a read
+* can be verified by regenerating what was expected, without keeping a copy
+* of what was written, and a miscompare can be classified as a misdirected,
+* stale, or corrupted read. Verifying an entire namspc thus requires memory
+* only for the chunk being read.
+*
+* @note This class may throw exceptions.
+*/
+class LbaPattern
+{
+public:
+    LbaPattern();
+    virtual ~LbaPattern();
+
+    /**
+     * Fill consecutive LBA's of a payload.
+     * @param buf Pass the payload
+     * @param key Pass the seed, namspc and generation to embed
+     * @param slba Pass the LBA of the 1st block within the payload
+     * @param numLBA Pass the number of LBA's to fill, 0 fills nothing
+     * @param lbaDataSize Pass the number of data bytes per LBA
+     * @param stride Pass the bytes between consecutive LBA's in buf, i.e.
+     *      lbaDataSize + meta size for interleaved meta data; 0 implies
+     *      lbaDataSize. Bytes beyond the LBA data are not touched.
+     */
+    static void Fill(uint8_t *buf, const LbaPatKey &key, uint64_t slba,
+        uint32_t numLBA, uint32_t lbaDataSize, uint32_t stride = 0);
+    static void Fill(SharedMemBufferPtr buf, const LbaPatKey &key,
+        uint64_t slba, uint32_t numLBA, uint32_t lbaDataSize,
+        uint32_t stride = 0);
+
+    /**
+     * Check a single LBA against the content expected of it.
+     * @param blk Pass the start of the LBA's data
+     * @param key Pass the seed, namspc and generation expected
+     * @param lba Pass the LBA expected
+     * @param lbaDataSize Pass the number of data bytes per LBA
+     * @param badOffset Returns the 1st byte offset which differs
+     * @return the classification of the LBA's content
+     */
+    static LbaPatStatus Check(const uint8_t *blk, const LbaPatKey &key,
+        uint64_t lba, uint32_t lbaDataSize, uint32_t &badOffset);
+
+    /**
+     * Verify consecutive LBA's of a payload, logging the 1st failure.
+     * Parameters match those of Fill().
+     * @return true if every LBA holds its expected content, thus also when
+     *      numLBA is 0
+     */
+    static bool Verify(const uint8_t *buf, const LbaPatKey &key,
+        uint64_t slba, uint32_t numLBA, uint32_t lbaDataSize,
+        uint32_t stride = 0);
+    static bool Verify(SharedMemBufferPtr buf, const LbaPatKey &key,
+        uint64_t slba, uint32_t numLBA, uint32_t lbaDataSize,
+        uint32_t stride = 0);
+
+    /// @return a human readable description of a status
+    static const char *StatusStr(LbaPatStatus status);
+
+    /**
+     * Decode the header of an LBA previously filled by this pattern.
+     * @param blk Pass the start of the LBA's data
+     * @param key Returns the key the LBA was filled with
+     * @param lba Returns the LBA the content was generated for
+     * @return true if a header was found, otherwise false
+     */
+    static bool GetKey(const uint8_t *blk, LbaPatKey &key, uint64_t &lba);
+
+    /**
+     * Create a key unique to this run which has never been used before.
+     * @param nsid Pass the namspc which will be written
+     * @return the key with the seed of this run and the next generation
+     */
+    static LbaPatKey NewKey(uint32_t nsid);
+
+
+private:
+    static uint64_t mSeed;              // 0 until the 1st key is created
+    static uint32_t mGeneration;
+
+    struct Hdr {
+        uint32_t    magic;
+        uint32_t    nsid;
+        uint64_t    lba;
+        uint32_t    generation;
+        uint32_t    rsvd;
+        uint64_t    seed;
+    } __attribute__((__packed__));
+
+    /// Seed the generator state from the identifying tuple
+    static void SeedState(uint64_t state[4], const LbaPatKey &key,
+        uint64_t lba);
+    static uint64_t Next(uint64_t state[4]);
+    static void CheckSizes(uint32_t lbaDataSize, uint32_t &stride);
+};
+
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <map>
+#include "logicalIO.h"
+#include "globals.h"
+#include "io.h"
+#include "protInfo.h"
+#include "../Cmds/read.h"
+#include "../Cmds/write.h"
+#include "../Queues/ce.h"
+
+
+LogicalIO::LogicalIO()
+{
+}
+
+
+LogicalIO::~LogicalIO()
+{
+}
+
+
+uint32_t
+LogicalIO::MaxBlksPerCmd(uint32_t nsid)
+{
+    ConstSharedIdentifyPtr idCmdNamspc =
+        gInformative->GetIdentifyCmdNamspc(nsid);
+    if (idCmdNamspc == Identify::NullIdentifyPtr)
+        throw FrmwkEx(HERE, "Namespace #%d must exist", nsid);
+
+    PILayout layout = ProtInfo::GetLayout(idCmdNamspc);
+    uint32_t stride = layout.lbaDataSize +
+        (layout.interleaved ? layout.metaSize : 0);
+    uint32_t maxBlks = LIO_MAX_NLB;
+
+    // MDTS of 0 indicates no limit beyond that of the NLB field
+    uint32_t maxDtXferSz =
+        gInformative->GetIdentifyCmdCtrlr()->GetMaxDataXferSize();
+    if (maxDtXferSz)
+        maxBlks = MIN(maxBlks, (maxDtXferSz / stride));
+    if (maxBlks == 0) {
+        throw FrmwkEx(HERE, "MDTS of %d bytes can't xfer 1 block of %d bytes",
+            maxDtXferSz, stride);
+    }
+    return maxBlks;
+}
+
+
+void
+LogicalIO::Write(string grpName, string testName, SharedSQPtr sq,
+    SharedCQPtr cq, uint32_t nsid, uint64_t slba, SharedMemBufferPtr buf,
+    uint32_t qDepth)
+{
+    Xfer(grpName, testName, sq, cq, nsid, slba, buf, qDepth, true);
+}
+
+
+void
+LogicalIO::Read(string grpName, string testName, SharedSQPtr sq,
+    SharedCQPtr cq, uint32_t nsid, uint64_t slba, SharedMemBufferPtr buf,
+    uint32_t qDepth)
+{
+    Xfer(grpName, testName, sq, cq, nsid, slba, buf, qDepth, false);
+}
+
+
+void
+LogicalIO::Xfer(string grpName, string testName, SharedSQPtr sq,
+    SharedCQPtr cq, uint32_t nsid, uint64_t slba, SharedMemBufferPtr buf,
+    uint32_t qDepth, bool write)
+{
+    uint32_t numCE;
+    uint32_t ceRemain;
+    uint32_t isrCount;
+    uint16_t uniqueId;
+    // Key is CID, value is the index into cmds
+    std::map<uint16_t, uint32_t> outstanding;
+    SharedMemBufferPtr ceMem = SharedMemBufferPtr(new MemBuffer());
+
+    PILayout layout = ProtInfo::GetLayout(
+        gInformative->GetIdentifyCmdNamspc(nsid));
+    if ((layout.type != PITYPE_NONE) ||
+        (layout.metaSize && (layout.interleaved == false))) {
+        throw FrmwkEx(HERE, "Namspc #%d requires meta/E2E handling per cmd",
+            nsid);
+    }
+    uint32_t stride = layout.lbaDataSize + layout.metaSize;
+    if ((buf->GetBufSize() == 0) || (buf->GetBufSize() % stride)) {
+        throw FrmwkEx(HERE, "Buffer of %d bytes isn't a multiple of %d bytes",
+            buf->GetBufSize(), stride);
+    }
+    uint64_t nlb = (buf->GetBufSize() / stride);
+    uint32_t maxBlks = MaxBlksPerCmd(nsid);
+
+    LOG_NRM("Split %s of %lld LBA's into cmds of <= %d LBA's",
+        write ? "write" : "read", (long long)nlb, maxBlks);
+    std::vector<SharedCmdPtr> cmds;
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+    for (uint64_t blk = 0; blk < nlb; blk += maxBlks) {
+        uint32_t numBlks = (uint32_t)MIN((uint64_t)maxBlks, (nlb - blk));
+        uint64_t offset = (blk * stride);
+        if (write) {
+            SharedWritePtr cmd = SharedWritePtr(new class Write());
+            cmd->SetPrpBuffer(prpBitmask, buf, offset, (numBlks * stride));
+            cmd->SetNSID(nsid);
+            cmd->SetSLBA(slba + blk);
+            cmd->SetNLB(numBlks - 1);   // convert to 0-based value
+            cmds.push_back(cmd);
+        } else {
+            SharedReadPtr cmd = SharedReadPtr(new class Read());
+            cmd->SetPrpBuffer(prpBitmask, buf, offset, (numBlks * stride));
+            cmd->SetNSID(nsid);
+            cmd->SetSLBA(slba + blk);
+            cmd->SetNLB(numBlks - 1);   // convert to 0-based value
+            cmds.push_back(cmd);
+        }
+    }
+
+    uint32_t maxDepth = MIN((sq->GetNumEntries() - 1),
+        (cq->GetNumEntries() - 1));
+    if ((qDepth == 0) || (qDepth > maxDepth))
+        qDepth = maxDepth;
+    qDepth = MIN(qDepth, (uint32_t)cmds.size());
+    if ((numCE = cq->ReapInquiry(isrCount, true)) != 0) {
+        cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq", "notEmpty"),
+            "Test assumption have not been met");
+        throw FrmwkEx(HERE, "Require 0 CE's within CQ %d, not upheld, found %d",
+            cq->GetQId(), numCE);
+    }
+
+    uint32_t numSent = 0;
+    uint32_t numDone = 0;
+    for (; numSent < qDepth; numSent++) {
+        sq->Send(cmds[numSent], uniqueId);
+        outstanding[uniqueId] = numSent;
+    }
+    sq->Ring();
+
+    while (numDone < cmds.size()) {
+        if (cq->ReapInquiryWaitAny(CALC_TIMEOUT_ms(qDepth), numCE, isrCount)
+            == false) {
+            cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+                "timeout"), "Dump Entire CQ");
+            sq->Dump(FileSystem::PrepDumpFile(grpName, testName, "sq",
+                "timeout"), "Dump Entire SQ");
+            throw FrmwkEx(HERE, "Unable to see CEs for issued cmds");
+        }
+
+        uint32_t numReaped = cq->Reap(ceRemain, ceMem, isrCount, numCE, true);
+        bool ring = false;
+        for (uint32_t i = 0; i < numReaped; i++) {
+            union CE *ce = (union CE *)(ceMem->GetBuffer() +
+                (i * cq->GetEntrySize()));
+            std::map<uint16_t, uint32_t>::iterator it =
+                outstanding.find(ce->n.CID);
+            if ((ce->n.SQID != sq->GetQId()) || (it == outstanding.end())) {
+                cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+                    "unknownCID"), "Dump Entire CQ");
+                throw FrmwkEx(HERE, "CE reports unknown SQID %d, CID 0x%04X",
+                    (int)ce->n.SQID, (int)ce->n.CID);
+            }
+
+            SharedCmdPtr cmd = cmds[it->second];
+            outstanding.erase(it);
+            if (ProcessCE::ValidatePeek(*ce) == false) {
+                cmd->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                    cmd->GetName(), "failed"), "A cmd's contents dumped");
+                ProcessCE::Validate(*ce);   // throws
+            }
+            IO::ShadowCompleted(grpName, testName, sq, cmd, "split");
+            numDone++;
+
+            if (numSent < cmds.size()) {
+                sq->Send(cmds[numSent], uniqueId);
+                outstanding[uniqueId] = numSent++;
+                ring = true;
+            }
+        }
+        if (ring)
+            sq->Ring();
+    }
+}
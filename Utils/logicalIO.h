@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _LOGICALIO_H_
+#define _LOGICALIO_H_
+
+#include "tnvme.h"
+#include "../Queues/sq.h"
+#include "../Queues/cq.h"
+
+/// Largest 1-based NLB any 1 NVM cmd can carry, CDW12.NLB is 16 bits
+#define LIO_MAX_NLB                 0x10000
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It performs logical reads/writes of any size over a single
+* MemBuffer. Each logical request is split into cmds which honor both MDTS
+* and the NLB field's limit; each cmd references its own sub-range of the
+* buffer thus no data is ever copied. The cmds are pipelined into the SQ,
+* keeping it as full as allowed, and the logical request completes when the
+* last cmd does. Every cmd's completion keeps the WriteShadow coherent.
+* Namspcs with separate meta data or E2E protection are not supported since
+* each cmd would need its own meta buffer or protection information.
+*
+* @note This class may throw exceptions, please see comment within specific
+*       methods.
+*/
+class LogicalIO
+{
+public:
+    LogicalIO();
+    virtual ~LogicalIO();
+
+    /**
+     * @param nsid Pass the namspc to be accessed
+     * @return the max 1-based NLB a single cmd may xfer to/from the namspc
+     */
+    static uint32_t MaxBlksPerCmd(uint32_t nsid);
+
+    /**
+     * Write an entire buffer to consecutive LBA's. This method requires 0
+     * elements to reside in the CQ and also assumes no other cmd will
+     * complete into that CQ while this operation is occurring.
+     * @note Throws upon errors
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param sq Pass pre-existing IOSQ to issue cmds into
+     * @param cq Pass pre-existing IOCQ to reap CE's from
+     * @param nsid Pass the namspc to write
+     * @param slba Pass the 1st LBA to write
+     * @param buf Pass the data, its size must be a multiple of the LBA size,
+     *      including interleaved meta data
+     * @param qDepth Pass the max num of cmds outstanding at once, 0 implies
+     *      as many as the SQ and CQ allow
+     */
+    static void Write(string grpName, string testName, SharedSQPtr sq,
+        SharedCQPtr cq, uint32_t nsid, uint64_t slba, SharedMemBufferPtr buf,
+        uint32_t qDepth = 0);
+
+    /**
+     * Read consecutive LBA's to fill an entire buffer. Parameters and
+     * requirements match those of Write().
+     * @note Throws upon errors
+     */
+    static void Read(string grpName, string testName, SharedSQPtr sq,
+        SharedCQPtr cq, uint32_t nsid, uint64_t slba, SharedMemBufferPtr buf,
+        uint32_t qDepth = 0);
+
+
+private:
+    static void Xfer(string grpName, string testName, SharedSQPtr sq,
+        SharedCQPtr cq, uint32_t nsid, uint64_t slba, SharedMemBufferPtr buf,
+        uint32_t qDepth, bool write);
+};
+
+
+#endif
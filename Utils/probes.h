@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _PROBES_H_
+#define _PROBES_H_
+
+/**
+ * Static user space tracepoints (USDT) marking the framework's hot spots,
+ * allowing perf, bpftrace and systemtap to correlate tnvme's activity with
+ * kernel and device events without guessing at symbols, i.e.
+ *     bpftrace -e 'usdt:./tnvme:tnvme:sq_send { printf("%d\n", arg1); }'
+ * When systemtap's <sys/sdt.h> is installed, see the Makefile, each probe
+ * compiles to a single nop until a tracer attaches; otherwise to nothing.
+ *
+ * provider tnvme {
+ *     probe sq_send(qId, cid, opcode, dataSize);
+ *     probe sq_ring(qId);
+ *     probe cq_reap_inquiry(qId, numRemaining, isrCount);
+ *     probe cq_reap(qId, numReaped, numRemaining);
+ *     probe cq_reap_ce(sqId, cid, status);
+ *     probe ctrlr_set_state(state);
+ *     probe ctrlr_set_state_done(state, success);
+ *     probe reg_read(space, offset, size);
+ *     probe reg_write(space, offset, size);
+ *     probe membuffer_init(size, align);
+ *     probe test_start(group, xLev, yLev, zLev);
+ *     probe test_end(group, xLev, yLev, zLev, result);
+ *     probe frmwk_ex(char *filename, lineNum, char *msg);
+ * };
+ */
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+#define TNVME_PROBE1(name, a)                                                 \
+    DTRACE_PROBE1(tnvme, name, a)
+#define TNVME_PROBE2(name, a, b)                                              \
+    DTRACE_PROBE2(tnvme, name, a, b)
+#define TNVME_PROBE3(name, a, b, c)                                           \
+    DTRACE_PROBE3(tnvme, name, a, b, c)
+#define TNVME_PROBE4(name, a, b, c, d)                                        \
+    DTRACE_PROBE4(tnvme, name, a, b, c, d)
+#define TNVME_PROBE5(name, a, b, c, d, e)                                     \
+    DTRACE_PROBE5(tnvme, name, a, b, c, d, e)
+
+#else
+// Args are never evaluated, sizeof() only quiets unused variable warnings
+#define TNVME_PROBE1(name, a)                                                 \
+    do { (void)sizeof(a); } while (0)
+#define TNVME_PROBE2(name, a, b)                                              \
+    do { (void)sizeof(a); (void)sizeof(b); } while (0)
+#define TNVME_PROBE3(name, a, b, c)                                           \
+    do { (void)sizeof(a); (void)sizeof(b); (void)sizeof(c); } while (0)
+#define TNVME_PROBE4(name, a, b, c, d)                                        \
+    do { TNVME_PROBE3(name, a, b, c); (void)sizeof(d); } while (0)
+#define TNVME_PROBE5(name, a, b, c, d, e)                                     \
+    do { TNVME_PROBE4(name, a, b, c, d); (void)sizeof(e); } while (0)
+
+#endif
+
+
+#endif
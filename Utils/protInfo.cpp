@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#endif
+#include "protInfo.h"
+#include "../Exception/frmwkEx.h"
+
+#define CRC16_T10DIF_POLY           0x8BB7
+/// Buffers smaller than this gain nothing from folding
+#define CRC_CLMUL_MIN_LEN           32
+
+static uint16_t sCrcTbl[8][256];
+
+uint16_t (*ProtInfo::mCrcImpl)(uint16_t crc, const uint8_t *buf, size_t len) =
+    NULL;
+
+
+/**
+ * Calculate x^n mod P(x), the CRC polynomial.
+ */
+static uint64_t
+XPowModP(uint32_t n)
+{
+    uint32_t rem = 1;
+
+    for (uint32_t i = 0; i < n; i++) {
+        rem <<= 1;
+        if (rem & 0x10000)
+            rem ^= (0x10000 | CRC16_T10DIF_POLY);
+    }
+    return rem;
+}
+
+
+ProtInfo::ProtInfo()
+{
+}
+
+
+ProtInfo::~ProtInfo()
+{
+}
+
+
+void
+ProtInfo::SelectImpl()
+{
+    // Table n yields the CRC of a byte followed by n zero bytes
+    for (uint32_t i = 0; i < 256; i++) {
+        uint16_t crc = (uint16_t)(i << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ?
+                ((crc << 1) ^ CRC16_T10DIF_POLY) : (crc << 1);
+        }
+        sCrcTbl[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int s = 1; s < 8; s++) {
+            sCrcTbl[s][i] = (sCrcTbl[s - 1][i] << 8) ^
+                sCrcTbl[0][sCrcTbl[s - 1][i] >> 8];
+        }
+    }
+
+    mCrcImpl = CrcSlice8;
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("pclmul"))
+        mCrcImpl = CrcClmul;
+#endif
+    LOG_NRM("CRC16-T10DIF implementation: %s",
+        (mCrcImpl == CrcSlice8) ? "slice-by-8" : "PCLMULQDQ");
+}
+
+
+bool
+ProtInfo::IsAccelerated()
+{
+    if (mCrcImpl == NULL)
+        SelectImpl();
+    return (mCrcImpl != CrcSlice8);
+}
+
+
+uint16_t
+ProtInfo::Crc16T10Dif(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    if (mCrcImpl == NULL)
+        SelectImpl();
+    return mCrcImpl(crc, buf, len);
+}
+
+
+uint16_t
+ProtInfo::CrcSlice8(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    while (len >= 8) {
+        crc = sCrcTbl[7][buf[0] ^ (crc >> 8)] ^
+            sCrcTbl[6][buf[1] ^ (crc & 0xff)] ^
+            sCrcTbl[5][buf[2]] ^ sCrcTbl[4][buf[3]] ^
+            sCrcTbl[3][buf[4]] ^ sCrcTbl[2][buf[5]] ^
+            sCrcTbl[1][buf[6]] ^ sCrcTbl[0][buf[7]];
+        buf += 8;
+        len -= 8;
+    }
+    while (len--)
+        crc = (crc << 8) ^ sCrcTbl[0][(crc >> 8) ^ *buf++];
+    return crc;
+}
+
+
+#if defined(__x86_64__)
+/**
+ * The message is consumed as big endian 128 bit polynomials. The running
+ * remainder S is folded ahead by 128 bits as
+ * S_hi * (x^192 mod P) + S_lo * (x^128 mod P) before the next block is xor'd
+ * in; the final 128 bits are reduced by the tables.
+ */
+__attribute__((target("pclmul,sse2")))
+uint16_t
+ProtInfo::CrcClmul(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    static uint64_t k192 = 0;
+    static uint64_t k128 = 0;
+    uint64_t hi, lo;
+    uint8_t rem[16];
+
+    if (len < CRC_CLMUL_MIN_LEN)
+        return CrcSlice8(crc, buf, len);
+    if (k192 == 0) {
+        k192 = XPowModP(192);
+        k128 = XPowModP(128);
+    }
+
+    // A CRC to continue is equivalent to xor'ing it into the 1st 16 bits
+    memcpy(&hi, buf, sizeof(hi));
+    memcpy(&lo, (buf + 8), sizeof(lo));
+    hi = __builtin_bswap64(hi) ^ ((uint64_t)crc << 48);
+    lo = __builtin_bswap64(lo);
+    __m128i k = _mm_set_epi64x(k192, k128);
+    __m128i s = _mm_set_epi64x(hi, lo);
+    buf += 16;
+    len -= 16;
+
+    while (len >= 16) {
+        memcpy(&hi, buf, sizeof(hi));
+        memcpy(&lo, (buf + 8), sizeof(lo));
+        __m128i blk = _mm_set_epi64x(__builtin_bswap64(hi),
+            __builtin_bswap64(lo));
+        s = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(s, k, 0x11),
+            _mm_clmulepi64_si128(s, k, 0x00)), blk);
+        buf += 16;
+        len -= 16;
+    }
+
+    hi = __builtin_bswap64((uint64_t)_mm_cvtsi128_si64(
+        _mm_unpackhi_epi64(s, s)));
+    lo = __builtin_bswap64((uint64_t)_mm_cvtsi128_si64(s));
+    memcpy(rem, &hi, sizeof(hi));
+    memcpy((rem + 8), &lo, sizeof(lo));
+    crc = CrcSlice8(0, rem, sizeof(rem));
+    return CrcSlice8(crc, buf, len);
+}
+#else
+uint16_t
+ProtInfo::CrcClmul(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    return CrcSlice8(crc, buf, len);
+}
+#endif
+
+
+PILayout
+ProtInfo::GetLayout(ConstSharedIdentifyPtr idCmdNamspc)
+{
+    PILayout layout;
+    uint8_t dps = (uint8_t)idCmdNamspc->GetValue(IDNAMESPC_DPS);
+    uint8_t flbas = (uint8_t)idCmdNamspc->GetValue(IDNAMESPC_FLBAS);
+
+    layout.lbaDataSize = idCmdNamspc->GetLBADataSize();
+    layout.metaSize = idCmdNamspc->GetLBAFormat().MS;
+    layout.interleaved = ((flbas & 0x10) != 0);
+    layout.first8 = ((dps & 0x08) != 0);
+    switch (dps & 0x07) {
+    case 0:     layout.type = PITYPE_NONE;      break;
+    case 1:     layout.type = PITYPE_1;         break;
+    case 2:     layout.type = PITYPE_2;         break;
+    case 3:     layout.type = PITYPE_3;         break;
+    default:
+        throw FrmwkEx(HERE, "Illegal Identify.DPS = 0x%02X", dps);
+    }
+
+    if ((layout.type != PITYPE_NONE) && (layout.metaSize < PI_SIZE)) {
+        throw FrmwkEx(HERE, "PI type %d requires >= %d meta bytes, only %d",
+            layout.type, PI_SIZE, layout.metaSize);
+    }
+    return layout;
+}
+
+
+void
+ProtInfo::Locate(const PILayout &layout, uint32_t lba, size_t &dataOff,
+    size_t &metaOff)
+{
+    size_t piOff = layout.first8 ? 0 : (layout.metaSize - PI_SIZE);
+
+    if (layout.interleaved) {
+        dataOff = (size_t)lba * (layout.lbaDataSize + layout.metaSize);
+        metaOff = dataOff + layout.lbaDataSize + piOff;
+    } else {
+        dataOff = (size_t)lba * layout.lbaDataSize;
+        metaOff = ((size_t)lba * layout.metaSize) + piOff;
+    }
+}
+
+
+void
+ProtInfo::Generate(const PILayout &layout, uint8_t *data, uint8_t *meta,
+    uint32_t numLBA, uint64_t slba, uint16_t appTag)
+{
+    size_t dataOff, metaOff;
+    size_t preceding = layout.first8 ? 0 : (layout.metaSize - PI_SIZE);
+
+    if (layout.type == PITYPE_NONE)
+        throw FrmwkEx(HERE, "Namespace is not formatted with PI");
+    else if ((layout.interleaved == false) && (meta == NULL))
+        throw FrmwkEx(HERE, "Separate PI requires a meta data buffer");
+
+    for (uint32_t i = 0; i < numLBA; i++) {
+        Locate(layout, i, dataOff, metaOff);
+        uint8_t *base = layout.interleaved ? data : meta;
+        uint8_t *pi = (base + metaOff);
+
+        uint16_t guard = Crc16T10Dif(0, (data + dataOff), layout.lbaDataSize);
+        guard = Crc16T10Dif(guard, (pi - preceding), preceding);
+        uint32_t refTag = (uint32_t)(slba + i);
+
+        // All PI fields are big endian
+        pi[0] = (uint8_t)(guard >> 8);
+        pi[1] = (uint8_t)guard;
+        pi[2] = (uint8_t)(appTag >> 8);
+        pi[3] = (uint8_t)appTag;
+        pi[4] = (uint8_t)(refTag >> 24);
+        pi[5] = (uint8_t)(refTag >> 16);
+        pi[6] = (uint8_t)(refTag >> 8);
+        pi[7] = (uint8_t)refTag;
+    }
+}
+
+
+bool
+ProtInfo::Verify(const PILayout &layout, const uint8_t *data,
+    const uint8_t *meta, uint32_t numLBA, uint64_t slba, uint16_t appTag,
+    uint8_t prchk)
+{
+    size_t dataOff, metaOff;
+    size_t preceding = layout.first8 ? 0 : (layout.metaSize - PI_SIZE);
+
+    if (layout.type == PITYPE_NONE)
+        throw FrmwkEx(HERE, "Namespace is not formatted with PI");
+    else if ((layout.interleaved == false) && (meta == NULL))
+        throw FrmwkEx(HERE, "Separate PI requires a meta data buffer");
+
+    for (uint32_t i = 0; i < numLBA; i++) {
+        Locate(layout, i, dataOff, metaOff);
+        const uint8_t *base = layout.interleaved ? data : meta;
+        const uint8_t *pi = (base + metaOff);
+
+        uint16_t guard = ((uint16_t)pi[0] << 8) | pi[1];
+        uint16_t app = ((uint16_t)pi[2] << 8) | pi[3];
+        uint32_t ref = ((uint32_t)pi[4] << 24) | ((uint32_t)pi[5] << 16) |
+            ((uint32_t)pi[6] << 8) | pi[7];
+
+        // Escape values disable checking of the LBA
+        if ((app == 0xffff) && ((layout.type != PITYPE_3) ||
+            (ref == 0xffffffff))) {
+            continue;
+        }
+
+        if (prchk & PRINFO_PRCHK_GUARD) {
+            uint16_t calc = Crc16T10Dif(0, (data + dataOff),
+                layout.lbaDataSize);
+            calc = Crc16T10Dif(calc, (pi - preceding), preceding);
+            if (calc != guard) {
+                LOG_ERR("LBA 0x%016llX: guard 0x%04X, expected 0x%04X",
+                    (unsigned long long)(slba + i), guard, calc);
+                return false;
+            }
+        }
+        if ((prchk & PRINFO_PRCHK_APP) && (app != appTag)) {
+            LOG_ERR("LBA 0x%016llX: app tag 0x%04X, expected 0x%04X",
+                (unsigned long long)(slba + i), app, appTag);
+            return false;
+        }
+        if ((prchk & PRINFO_PRCHK_REF) && (layout.type != PITYPE_3) &&
+            (ref != (uint32_t)(slba + i))) {
+            LOG_ERR("LBA 0x%016llX: ref tag 0x%08X, expected 0x%08X",
+                (unsigned long long)(slba + i), ref, (uint32_t)(slba + i));
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void
+ProtInfo::SetCmdTags(SharedCmdPtr cmd, uint64_t slba, uint16_t appTag)
+{
+    cmd->SetDword((uint32_t)slba, 14);      // EILBRT
+    cmd->SetWord(appTag, 15, 0);            // ELBAT
+    cmd->SetWord(0xffff, 15, 1);            // ELBATM
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _PROTINFO_H_
+#define _PROTINFO_H_
+
+#include "tnvme.h"
+#include "../Cmds/identify.h"
+#include "../Cmds/cmd.h"
+
+/// Number of bytes of T10 protection information per LBA
+#define PI_SIZE                     8
+
+/// PRINFO field bits of the NVM read/write family of cmds
+#define PRINFO_PRACT                0x8
+#define PRINFO_PRCHK_GUARD          0x4
+#define PRINFO_PRCHK_APP            0x2
+#define PRINFO_PRCHK_REF            0x1
+#define PRINFO_PRCHK_ALL            \
+    (PRINFO_PRCHK_GUARD | PRINFO_PRCHK_APP | PRINFO_PRCHK_REF)
+
+typedef enum {
+    PITYPE_NONE,                    // E2E protection is disabled
+    PITYPE_1,
+    PITYPE_2,
+    PITYPE_3
+} PIType;
+
+/// Describes where the PI resides within a formatted namespace
+struct PILayout {
+    PIType      type;
+    bool        first8;             // PI in 1st 8B of meta, otherwise last 8B
+    bool        interleaved;        // Meta follows each LBA within the payload
+    uint32_t    lbaDataSize;
+    uint32_t    metaSize;
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It generates and verifies T10 protection information, guard
+* CRC16-T10DIF, application tag and reference tag, for namespaces formatted
+* with E2E protection; the PI is placed into either the separate meta data
+* buffer (MetaData) or the interleaved payload (MemBuffer) according to the
+* namespace's layout. The guard covers the LBA data plus any meta data bytes
+* which precede the PI.
+*
+* The CRC is computed by carry-less multiplication folding when the CPU
+* supports PCLMULQDQ, otherwise by slice-by-8 tables; the choice is made at
+* runtime upon the 1st use.
+*
+* @note This class may throw exceptions.
+*/
+class ProtInfo
+{
+public:
+    ProtInfo();
+    virtual ~ProtInfo();
+
+    /**
+     * Calculate the CRC16-T10DIF of a buffer, polynomial 0x8BB7.
+     * @param crc Pass 0 to start a new CRC, or the result of a prior call to
+     *      continue the CRC over an adjacent buffer
+     * @param buf Pass the buffer to calculate over
+     * @param len Pass the number of bytes of the buffer
+     * @return the CRC
+     */
+    static uint16_t Crc16T10Dif(uint16_t crc, const uint8_t *buf, size_t len);
+
+    /// @return true if the PCLMULQDQ implementation of the CRC is in use
+    static bool IsAccelerated();
+
+    /**
+     * Learn the PI layout of a namespace from its identify data.
+     * @param idCmdNamspc Pass the namespace's identify cmd
+     * @return the layout, PITYPE_NONE indicates E2E protection is disabled
+     */
+    static PILayout GetLayout(ConstSharedIdentifyPtr idCmdNamspc);
+
+    /**
+     * Fill in the PI of a number of consecutive LBA's.
+     * @param layout Pass the layout as returned by GetLayout()
+     * @param data Pass the payload, for interleaved layouts the PI is written
+     *      into the meta data following each LBA
+     * @param meta Pass the separate meta data buffer, ignored for interleaved
+     * @param numLBA Pass the number of LBA's within the payload
+     * @param slba Pass the 1st LBA, which is also the initial reference tag
+     * @param appTag Pass the application tag
+     */
+    static void Generate(const PILayout &layout, uint8_t *data, uint8_t *meta,
+        uint32_t numLBA, uint64_t slba, uint16_t appTag);
+
+    /**
+     * Verify the PI of a number of consecutive LBA's, PI fields carrying the
+     * escape values the spec defines for the PI type are not checked.
+     * @param layout Pass the layout as returned by GetLayout()
+     * @param data Pass the payload
+     * @param meta Pass the separate meta data buffer, ignored for interleaved
+     * @param numLBA Pass the number of LBA's within the payload
+     * @param slba Pass the 1st LBA, which is also the initial reference tag
+     * @param appTag Pass the expected application tag
+     * @param prchk Pass which fields to check, see PRINFO_PRCHK_*
+     * @return true if all checked fields match, otherwise false after logging
+     *      the 1st mismatch
+     */
+    static bool Verify(const PILayout &layout, const uint8_t *data,
+        const uint8_t *meta, uint32_t numLBA, uint64_t slba, uint16_t appTag,
+        uint8_t prchk);
+
+    /**
+     * Set the expected initial LBA reference tag, CDW14, and the expected LBA
+     * application tag and mask, CDW15, of a read/write family cmd.
+     * @param cmd Pass the cmd to modify
+     * @param slba Pass the 1st LBA, which is also the initial reference tag
+     * @param appTag Pass the application tag, all bits are checked
+     */
+    static void SetCmdTags(SharedCmdPtr cmd, uint64_t slba, uint16_t appTag);
+
+
+private:
+    static uint16_t (*mCrcImpl)(uint16_t crc, const uint8_t *buf, size_t len);
+
+    static void SelectImpl();
+    static uint16_t CrcSlice8(uint16_t crc, const uint8_t *buf, size_t len);
+    static uint16_t CrcClmul(uint16_t crc, const uint8_t *buf, size_t len);
+
+    /// Locate the guard-covered bytes and the PI of LBA number lba
+    static void Locate(const PILayout &layout, uint32_t lba, size_t &dataOff,
+        size_t &metaOff);
+};
+
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <boost/format.hpp>
+#include "verifyEngine.h"
+#include "globals.h"
+#include "io.h"
+#include "lbaPattern.h"
+#include "protInfo.h"
+#include "../Cmds/read.h"
+#include "../Queues/writeShadow.h"
+
+/// Bit definition for IDCTRLRCAP_FUSES
+#define FUSES_SUP_COMPARE_WRITE     0x0001
+#define FUSE_1ST_CMD                0x01
+#define FUSE_2ND_CMD                0x02
+
+
+VerifyEngine::VerifyEngine()
+{
+}
+
+
+VerifyEngine::~VerifyEngine()
+{
+}
+
+
+bool
+VerifyEngine::CompareSupported()
+{
+    ConstSharedIdentifyPtr idCtrlrCap = gInformative->GetIdentifyCmdCtrlr();
+    return ((idCtrlrCap->GetValue(IDCTRLRCAP_ONCS) & ONCS_SUP_COMP_CMD) != 0);
+}
+
+
+bool
+VerifyEngine::FusedCompareWriteSupported()
+{
+    ConstSharedIdentifyPtr idCtrlrCap = gInformative->GetIdentifyCmdCtrlr();
+    return (CompareSupported() &&
+        ((idCtrlrCap->GetValue(IDCTRLRCAP_FUSES) & FUSES_SUP_COMPARE_WRITE)
+        != 0));
+}
+
+
+uint64_t
+VerifyEngine::VerifyRange(string grpName, string testName, SharedSQPtr sq,
+    SharedCQPtr cq, uint32_t nsid, uint64_t slba, uint64_t nlb,
+    uint32_t maxBlksPerCmd)
+{
+    LbaPatKey key;
+    uint64_t runLen;
+    uint64_t numVerified = 0;
+    string qualify;
+
+    ConstSharedIdentifyPtr idCmdNamspc =
+        gInformative->GetIdentifyCmdNamspc(nsid);
+    if (idCmdNamspc == Identify::NullIdentifyPtr)
+        throw FrmwkEx(HERE, "Namespace #%d must exist", nsid);
+    else if (maxBlksPerCmd == 0)
+        throw FrmwkEx(HERE, "Require >= 1 block per cmd");
+    maxBlksPerCmd = MIN(maxBlksPerCmd, (uint32_t)(0xffff + 1));  // NLB is 16b
+
+    PILayout layout = ProtInfo::GetLayout(idCmdNamspc);
+    uint32_t stride = layout.lbaDataSize +
+        (layout.interleaved ? layout.metaSize : 0);
+    uint32_t sepMetaSize = (layout.interleaved ? 0 : layout.metaSize);
+    bool useCompare = (CompareSupported() && (layout.metaSize == 0));
+    LOG_NRM("Verify NSID %d LBA's 0x%016llX+%lld via %s", nsid,
+        (unsigned long long)slba, (long long)nlb,
+        useCompare ? "compare cmds" : "host reads");
+
+    key.nsid = nsid;
+    for (uint64_t i = 0; i < nlb; i += runLen) {
+        bool known = WriteShadow::Lookup(nsid, (slba + i), key.seed,
+            key.generation, runLen);
+        if ((runLen == 0) || (runLen > (nlb - i)))
+            runLen = (nlb - i);
+        if (known == false)
+            continue;
+        runLen = MIN(runLen, (uint64_t)maxBlksPerCmd);
+
+        uint64_t lba = (slba + i);
+        uint32_t numBlks = (uint32_t)runLen;
+        qualify = str(boost::format("lba.%llX") % lba);
+        if (useCompare == false) {
+            HostVerify(grpName, testName, sq, cq, nsid, lba, numBlks,
+                ((uint64_t)numBlks * stride), sepMetaSize, qualify);
+            numVerified += numBlks;
+            continue;
+        }
+
+        SharedMemBufferPtr expected = SharedMemBufferPtr(new MemBuffer());
+        expected->Init((uint64_t)numBlks * stride);
+        LbaPattern::Fill(expected, key, lba, numBlks, layout.lbaDataSize,
+            stride);
+
+        SharedComparePtr cmp = SharedComparePtr(new Compare());
+        send_64b_bitmask prpBitmask = (send_64b_bitmask)
+            (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+        cmp->SetPrpBuffer(prpBitmask, expected);
+        cmp->SetNSID(nsid);
+        cmp->SetSLBA(lba);
+        cmp->SetNLB(numBlks - 1);     // convert to 0-based value
+
+        std::vector<CEStat> status;
+        status.push_back(CESTAT_SUCCESS);
+        status.push_back(CESTAT_COMPARE_FAIL);
+        if (IO::SendAndReapCmd(grpName, testName, CALC_TIMEOUT_ms(1), sq, cq,
+            cmp, qualify, false, status) == CESTAT_COMPARE_FAIL) {
+
+            LOG_ERR("DUT reports compare failure, reading back to isolate");
+            HostVerify(grpName, testName, sq, cq, nsid, lba, numBlks,
+                ((uint64_t)numBlks * stride), sepMetaSize, qualify);
+            cmp->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                "CompareCmd", qualify), "Compare failed, read back matched");
+            throw FrmwkEx(HERE, "DUT failed compare of NSID %d LBA's "
+                "0x%016llX+%d, yet reading them back matched", nsid,
+                (unsigned long long)lba, numBlks);
+        }
+        numVerified += numBlks;
+    }
+    return numVerified;
+}
+
+
+void
+VerifyEngine::HostVerify(string grpName, string testName, SharedSQPtr sq,
+    SharedCQPtr cq, uint32_t nsid, uint64_t slba, uint32_t nlb,
+    uint64_t bufSize, uint32_t sepMetaSize, string qualify)
+{
+    SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
+    readMem->Init(bufSize);
+
+    SharedReadPtr readCmd = SharedReadPtr(new Read());
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+    readCmd->SetPrpBuffer(prpBitmask, readMem);
+    readCmd->SetNSID(nsid);
+    readCmd->SetSLBA(slba);
+    readCmd->SetNLB(nlb - 1);       // convert to 0-based value
+
+    // Separate meta data isn't covered by the shadow, but needs a home
+    if (sepMetaSize) {
+        if (gRsrcMngr->SetMetaAllocSize(sepMetaSize * nlb) == false)
+            throw FrmwkEx(HERE);
+        readCmd->AllocMetaBuffer();
+    }
+
+    // IO::ShadowCompleted() verifies the payload against the WriteShadow
+    IO::SendAndReapCmd(grpName, testName, CALC_TIMEOUT_ms(1), sq, cq,
+        readCmd, qualify, false);
+}
+
+
+CEStat
+VerifyEngine::CompareAndWrite(string grpName, string testName, uint32_t ms,
+    SharedSQPtr sq, SharedCQPtr cq, SharedComparePtr cmp, SharedWritePtr write,
+    string qualify)
+{
+    uint32_t numCE;
+    uint32_t isrCount;
+    uint32_t ceRemain;
+    uint16_t cmpId;
+    uint16_t writeId;
+
+    if (FusedCompareWriteSupported() == false)
+        throw FrmwkEx(HERE, "DUT doesn't support fused compare and write");
+    if ((numCE = cq->ReapInquiry(isrCount, true)) != 0) {
+        cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+            "notEmpty"), "Test assumption have not been met");
+        throw FrmwkEx(HERE, "Require 0 CE's within CQ %d, not upheld, found %d",
+            cq->GetQId(), numCE);
+    }
+
+    // Sending the write forgets the shadow of its LBA's, an aborted write
+    // leaves them intact, so remember what to restore
+    uint64_t seed;
+    uint32_t generation;
+    uint64_t runLen;
+    bool known = WriteShadow::Lookup(write->GetNSID(), write->GetSLBA(),
+        seed, generation, runLen) && (runLen > write->GetNLB());
+
+    LOG_NRM("Send fused compare and write via SQ %d", sq->GetQId());
+    cmp->SetFUSE(FUSE_1ST_CMD);
+    write->SetFUSE(FUSE_2ND_CMD);
+    sq->Send(cmp, cmpId);
+    sq->Send(write, writeId);
+    sq->Ring();
+
+    if ((cq->ReapInquiryWaitSpecify(ms, 2, numCE, isrCount) == false) ||
+        (numCE != 2)) {
+        cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq.fused",
+            qualify), "Unable to see both fused CE's");
+        throw FrmwkEx(HERE, "Expected 2 CE's in CQ %d, found %d",
+            cq->GetQId(), numCE);
+    }
+
+    SharedMemBufferPtr ceMem = SharedMemBufferPtr(new MemBuffer());
+    if (cq->Reap(ceRemain, ceMem, isrCount, numCE, true) != 2)
+        throw FrmwkEx(HERE, "Verified there were 2 CE's, but couldn't reap");
+
+    union CE *cmpCE = NULL;
+    union CE *writeCE = NULL;
+    for (uint32_t i = 0; i < 2; i++) {
+        union CE *ce = (union CE *)(ceMem->GetBuffer() +
+            (i * cq->GetEntrySize()));
+        if (ce->n.CID == cmpId)
+            cmpCE = ce;
+        else if (ce->n.CID == writeId)
+            writeCE = ce;
+    }
+    if ((cmpCE == NULL) || (writeCE == NULL)) {
+        cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq.fused",
+            qualify), "CE's don't match the fused cmds");
+        throw FrmwkEx(HERE, "CE's don't report CID's 0x%04X and 0x%04X",
+            cmpId, writeId);
+    }
+
+    CEStat cmpStat = CESTAT_COMPARE_FAIL;
+    if (ProcessCE::ValidatePeek(*cmpCE, CESTAT_SUCCESS)) {
+        cmpStat = CESTAT_SUCCESS;
+        ProcessCE::Validate(*writeCE);      // throws upon error
+        IO::ShadowCompleted(grpName, testName, sq, write, qualify);
+    } else if (ProcessCE::ValidatePeek(*cmpCE, CESTAT_COMPARE_FAIL)) {
+        ProcessCE::Validate(*writeCE, CESTAT_ABRT_FAIL_FUSE);
+        if (known) {
+            WriteShadow::Record(write->GetNSID(), write->GetSLBA(),
+                (write->GetNLB() + 1), seed, generation);
+        }
+    } else {
+        ProcessCE::Validate(*cmpCE, CESTAT_COMPARE_FAIL);   // throws
+    }
+    return cmpStat;
+}
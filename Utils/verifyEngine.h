@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _VERIFYENGINE_H_
+#define _VERIFYENGINE_H_
+
+#include "tnvme.h"
+#include "../Queues/sq.h"
+#include "../Queues/cq.h"
+#include "../Queues/ce.h"
+#include "../Cmds/compare.h"
+#include "../Cmds/write.h"
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It verifies LBA's whose content the WriteShadow knows by
+* regenerating their LbaPattern data and sending it to the DUT within a
+* compare cmd, thus the DUT performs the comparison and the payload never
+* needs to be read back into host memory. Only when the DUT reports a compare
+* failure, or when compare cannot be used, is the range read back and checked
+* on the host, which also pinpoints the offending LBA.
+*
+* @note This class may throw exceptions, please see comment within specific
+*       methods.
+*/
+class VerifyEngine
+{
+public:
+    VerifyEngine();
+    virtual ~VerifyEngine();
+
+    /// @return true if the DUT supports the compare cmd, otherwise false
+    static bool CompareSupported();
+
+    /// @return true if the DUT supports fused compare and write
+    static bool FusedCompareWriteSupported();
+
+    /**
+     * Verify every LBA within a range whose content the WriteShadow knows,
+     * skipping those it doesn't. Compare cmds are used for namspcs without
+     * meta data, since the shadow doesn't cover meta data, otherwise reads.
+     * This method requires 0 elements to reside in the CQ.
+     * @note Throws upon errors or any miscompare
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param sq Pass pre-existing IOSQ to issue cmds into
+     * @param cq Pass pre-existing IOCQ to reap CE's from
+     * @param nsid Pass the namspc to verify
+     * @param slba Pass the 1st LBA of the range
+     * @param nlb Pass the 1-based number of LBA's in the range
+     * @param maxBlksPerCmd Pass the max 1-based NLB of any 1 cmd
+     * @return the number of LBA's verified
+     */
+    static uint64_t VerifyRange(string grpName, string testName,
+        SharedSQPtr sq, SharedCQPtr cq, uint32_t nsid, uint64_t slba,
+        uint64_t nlb, uint32_t maxBlksPerCmd);
+
+    /**
+     * Issue a fused compare and write pair targeting the same LBA's and
+     * reap both CE's. When compare succeeds the write must succeed, when
+     * compare fails the write must be aborted due to the failed fused cmd.
+     * This method requires 0 elements to reside in the CQ.
+     * @note Throws upon errors
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param ms Pass the max number of ms to wait for both CE's
+     * @param sq Pass pre-existing IOSQ to issue cmds into
+     * @param cq Pass pre-existing IOCQ to reap CE's from
+     * @param cmp Pass the 1st fused cmd, the FUSE field is set by this method
+     * @param write Pass the 2nd fused cmd, the FUSE field is set by this
+     *      method
+     * @param qualify Pass a qualifying string to append to each dump file
+     * @return CESTAT_SUCCESS or CESTAT_COMPARE_FAIL as reported by compare
+     */
+    static CEStat CompareAndWrite(string grpName, string testName,
+        uint32_t ms, SharedSQPtr sq, SharedCQPtr cq, SharedComparePtr cmp,
+        SharedWritePtr write, string qualify);
+
+
+private:
+    /**
+     * Read back a range of LBA's whose content is known and verify it on
+     * the host.
+     * @note Throws upon a miscompare
+     */
+    static void HostVerify(string grpName, string testName, SharedSQPtr sq,
+        SharedCQPtr cq, uint32_t nsid, uint64_t slba, uint32_t nlb,
+        uint64_t bufSize, uint32_t sepMetaSize, string qualify);
+};
+
+
+#endif
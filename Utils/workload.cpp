@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <map>
+#include <string.h>
+#include <sys/time.h>
+#include "workload.h"
+#include "globals.h"
+#include "../Queues/ce.h"
+#include "../Cmds/read.h"
+
+// Number of seconds between progress reports during a soak
+#define SOAK_REPORT_SEC             10
+
+
+Workload::Workload()
+{
+}
+
+
+Workload::~Workload()
+{
+}
+
+
+uint64_t
+Workload::ElapsedUsec(const struct timeval &start, const struct timeval &end)
+{
+    int64_t delta = ((int64_t)end.tv_sec - (int64_t)start.tv_sec) * 1000000;
+    delta += ((int64_t)end.tv_usec - (int64_t)start.tv_usec);
+    return (delta < 0) ? 0 : (uint64_t)delta;
+}
+
+
+void
+Workload::SustainQD(string grpName, string testName, SharedSQPtr sq,
+    SharedCQPtr cq, std::vector<SharedCmdPtr> &cmds, uint64_t numCmds,
+    WorkloadStats &stats)
+{
+    std::vector<SharedSQPtr> sqs(1, sq);
+    std::vector<std::vector<SharedCmdPtr> > sqCmds(1, cmds);
+    std::vector<WorkloadStats> sqStats;
+
+    SustainQD(grpName, testName, sqs, cq, sqCmds, numCmds, sqStats);
+    stats = sqStats[0];
+}
+
+
+void
+Workload::SustainQD(string grpName, string testName,
+    std::vector<SharedSQPtr> &sqs, SharedCQPtr cq,
+    std::vector<std::vector<SharedCmdPtr> > &cmds, uint64_t numCmds,
+    std::vector<WorkloadStats> &stats)
+{
+    uint32_t numCE;
+    uint32_t ceRemain;
+    uint32_t isrStart;
+    uint32_t isrCount;
+    uint16_t uniqueId;
+    uint64_t numSent = 0;
+    uint64_t numDone = 0;
+    uint32_t totalDepth = 0;
+    struct timeval start;
+    struct timeval now;
+    // Key is (SQID << 16 | CID), value is (SQ index << 16 | slot)
+    std::map<uint32_t, uint32_t> outstanding;
+    std::vector<std::vector<struct timeval> > slotRung(sqs.size());
+    SharedMemBufferPtr ceMem = SharedMemBufferPtr(new MemBuffer());
+
+    if (sqs.empty() || (sqs.size() != cmds.size()))
+        throw FrmwkEx(HERE, "Need 1 set of cmds for each of the SQ's");
+
+    WorkloadStats zero;
+    memset(&zero, 0, sizeof(zero));
+    zero.latMin_us = (uint64_t)-1;
+    stats.assign(sqs.size(), zero);
+
+    for (size_t q = 0; q < sqs.size(); q++) {
+        uint32_t qDepth = cmds[q].size();
+        if ((qDepth == 0) || (qDepth >= sqs[q]->GetNumEntries()) ||
+            (qDepth > 0xffff)) {
+            throw FrmwkEx(HERE, "Queue depth %d illegal for SQ %d (%d)",
+                qDepth, sqs[q]->GetQId(), sqs[q]->GetNumEntries());
+        }
+        slotRung[q].resize(qDepth);
+        totalDepth += qDepth;
+    }
+    if (totalDepth >= cq->GetNumEntries()) {
+        throw FrmwkEx(HERE, "Total queue depth %d illegal for CQ %d (%d)",
+            totalDepth, cq->GetQId(), cq->GetNumEntries());
+    } else if ((numCE = cq->ReapInquiry(isrStart, true)) != 0) {
+        cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq", "notEmpty"),
+            "Test assumption have not been met");
+        throw FrmwkEx(HERE, "Require 0 CE's within CQ %d, not upheld, found %d",
+            cq->GetQId(), numCE);
+    }
+    isrCount = isrStart;
+
+    LOG_NRM("Sustain QD %d across %ld SQ(s) into CQ %d until %llu cmds "
+        "complete", totalDepth, sqs.size(), cq->GetQId(),
+        (unsigned long long)numCmds);
+    for (size_t q = 0; q < sqs.size(); q++) {
+        for (uint32_t slot = 0; (slot < cmds[q].size()) &&
+            (numSent < numCmds); slot++) {
+            sqs[q]->Send(cmds[q][slot], uniqueId);
+            outstanding[((uint32_t)sqs[q]->GetQId() << 16) | uniqueId] =
+                (q << 16) | slot;
+            numSent++;
+        }
+    }
+    for (size_t q = 0; q < sqs.size(); q++)
+        sqs[q]->Ring();
+    if (gettimeofday(&start, NULL) != 0)
+        throw FrmwkEx(HERE, "Cannot retrieve system time");
+    for (size_t q = 0; q < sqs.size(); q++) {
+        for (uint32_t slot = 0; slot < slotRung[q].size(); slot++)
+            slotRung[q][slot] = start;
+    }
+
+    while (numDone < numCmds) {
+        if (cq->ReapInquiryWaitAny(CALC_TIMEOUT_ms(totalDepth), numCE,
+            isrCount) == false) {
+            cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+                "timeout"), "Dump Entire CQ");
+            for (size_t q = 0; q < sqs.size(); q++) {
+                sqs[q]->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                    "sq", "timeout"), "Dump Entire SQ");
+            }
+            throw FrmwkEx(HERE, "Unable to see CEs for issued cmds");
+        }
+
+        uint32_t numReaped = cq->Reap(ceRemain, ceMem, isrCount, numCE, true);
+        if (gettimeofday(&now, NULL) != 0)
+            throw FrmwkEx(HERE, "Cannot retrieve system time");
+
+        std::vector<uint32_t> resent;
+        for (uint32_t i = 0; i < numReaped; i++) {
+            union CE *ce = (union CE *)(ceMem->GetBuffer() +
+                (i * cq->GetEntrySize()));
+            ProcessCE::Validate(*ce);
+
+            std::map<uint32_t, uint32_t>::iterator it =
+                outstanding.find(((uint32_t)ce->n.SQID << 16) | ce->n.CID);
+            if (it == outstanding.end()) {
+                cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+                    "unknownCID"), "Dump Entire CQ");
+                throw FrmwkEx(HERE, "CE reports unknown SQID %d, CID 0x%04X",
+                    ce->n.SQID, ce->n.CID);
+            }
+            uint32_t q = (it->second >> 16);
+            uint32_t slot = (it->second & 0xffff);
+            outstanding.erase(it);
+
+            uint64_t lat = ElapsedUsec(slotRung[q][slot], now);
+            stats[q].latSum_us += lat;
+            stats[q].latMin_us = MIN(stats[q].latMin_us, lat);
+            stats[q].latMax_us = MAX(stats[q].latMax_us, lat);
+            stats[q].numBytes += cmds[q][slot]->GetPrpBufferSize();
+            stats[q].numCmds++;
+            numDone++;
+
+            if (numSent < numCmds) {
+                sqs[q]->Send(cmds[q][slot], uniqueId);
+                outstanding[((uint32_t)sqs[q]->GetQId() << 16) | uniqueId] =
+                    (q << 16) | slot;
+                resent.push_back((q << 16) | slot);
+                numSent++;
+            }
+        }
+
+        if (resent.empty() == false) {
+            std::vector<bool> ring(sqs.size(), false);
+            for (size_t i = 0; i < resent.size(); i++)
+                ring[resent[i] >> 16] = true;
+            for (size_t q = 0; q < sqs.size(); q++) {
+                if (ring[q])
+                    sqs[q]->Ring();
+            }
+            if (gettimeofday(&now, NULL) != 0)
+                throw FrmwkEx(HERE, "Cannot retrieve system time");
+            for (size_t i = 0; i < resent.size(); i++)
+                slotRung[resent[i] >> 16][resent[i] & 0xffff] = now;
+        }
+    }
+
+    if (gettimeofday(&now, NULL) != 0)
+        throw FrmwkEx(HERE, "Cannot retrieve system time");
+    for (size_t q = 0; q < stats.size(); q++) {
+        stats[q].elapsed_us = ElapsedUsec(start, now);
+        stats[q].isrCount = isrCount - isrStart;
+        if (stats[q].numCmds == 0)
+            stats[q].latMin_us = 0;
+    }
+}
+
+
+void
+Workload::SoakWrap(string grpName, string testName, SharedSQPtr sq,
+    SharedCQPtr cq, SharedCmdPtr cmd, uint64_t maxWraps, uint32_t maxSec,
+    SoakStats &stats)
+{
+    uint32_t numCE;
+    uint32_t ceRemain;
+    uint32_t isrCount;
+    uint16_t uniqueId;
+    bool stopping = false;
+    struct timeval start;
+    struct timeval now;
+    struct timeval lastReport;
+    // Key is the CID, value is the SQ slot the cmd was placed into
+    std::map<uint16_t, uint32_t> outstanding;
+    SharedMemBufferPtr ceMem = SharedMemBufferPtr(new MemBuffer());
+    uint32_t sqSize = sq->GetNumEntries();
+    uint32_t cqSize = cq->GetNumEntries();
+    uint32_t qDepth = MIN((sqSize - 1), (cqSize - 1));
+
+    memset(&stats, 0, sizeof(stats));
+    if ((maxWraps == 0) && (maxSec == 0))
+        throw FrmwkEx(HERE, "A soak without any limit would never end");
+    else if (qDepth == 0)
+        throw FrmwkEx(HERE, "Queues of 1 element can't hold any cmds");
+    else if ((numCE = cq->ReapInquiry(isrCount, true)) != 0) {
+        cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq", "notEmpty"),
+            "Test assumption have not been met");
+        throw FrmwkEx(HERE, "Require 0 CE's within CQ %d, not upheld, found %d",
+            cq->GetQId(), numCE);
+    }
+
+    struct nvme_gen_sq sqMetrics = sq->GetQMetrics();
+    struct nvme_gen_cq cqMetrics = cq->GetQMetrics();
+    uint32_t sqTail = sqMetrics.tail_ptr;
+    uint32_t sqHead = sqMetrics.tail_ptr;       // SQ is empty
+    uint32_t cqHead = cqMetrics.head_ptr;
+    uint8_t phase = cqMetrics.pbit_new_entry;
+
+    LOG_NRM("Soak SQ %d (%d)/CQ %d (%d) at QD %d for %llu wraps or %d sec",
+        sq->GetQId(), sqSize, cq->GetQId(), cqSize, qDepth,
+        (unsigned long long)maxWraps, maxSec);
+    if (gettimeofday(&start, NULL) != 0)
+        throw FrmwkEx(HERE, "Cannot retrieve system time");
+    lastReport = start;
+
+    while ((stopping == false) || (outstanding.empty() == false)) {
+        // Top off the SQ, ringing once for the whole batch
+        bool sent = false;
+        while ((stopping == false) && (outstanding.size() < qDepth)) {
+            sq->Send(cmd, uniqueId);
+            if (outstanding.find(uniqueId) != outstanding.end()) {
+                throw FrmwkEx(HERE, "dnvme reused outstanding CID 0x%04X",
+                    uniqueId);
+            }
+            outstanding[uniqueId] = sqTail;
+            if (++sqTail == sqSize) {
+                sqTail = 0;
+                stats.sqWraps++;
+            }
+            sent = true;
+        }
+        if (sent)
+            sq->Ring();
+
+        if (cq->ReapInquiryWaitAny(CALC_TIMEOUT_ms(qDepth), numCE, isrCount)
+            == false) {
+            cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+                "soak.timeout"), "Dump Entire CQ");
+            sq->Dump(FileSystem::PrepDumpFile(grpName, testName, "sq",
+                "soak.timeout"), "Dump Entire SQ");
+            throw FrmwkEx(HERE, "Soak stalled after %llu cmds",
+                (unsigned long long)stats.numCmds);
+        }
+
+        uint32_t numReaped = cq->Reap(ceRemain, ceMem, isrCount, numCE, true);
+        for (uint32_t i = 0; i < numReaped; i++) {
+            union CE *ce = (union CE *)(ceMem->GetBuffer() +
+                (i * cq->GetEntrySize()));
+            std::map<uint16_t, uint32_t>::iterator it =
+                outstanding.find(ce->n.CID);
+            char anomaly[160] = "";
+
+            if (ce->n.SQID != sq->GetQId()) {
+                snprintf(anomaly, sizeof(anomaly), "CE.SQID=%d, expected %d",
+                    (int)ce->n.SQID, sq->GetQId());
+            } else if (ce->n.SF.t.P != phase) {
+                snprintf(anomaly, sizeof(anomaly),
+                    "CE.P=%d at CQ index %d, expected %d",
+                    (int)ce->n.SF.t.P, cqHead, (int)phase);
+            } else if (it == outstanding.end()) {
+                snprintf(anomaly, sizeof(anomaly),
+                    "CE.CID=0x%04X not outstanding", (int)ce->n.CID);
+            } else if (ce->n.SQHD >= sqSize) {
+                snprintf(anomaly, sizeof(anomaly),
+                    "CE.SQHD=%d beyond SQ size %d", (int)ce->n.SQHD, sqSize);
+            } else {
+                // Distances are measured in the direction the SQ fills
+                uint32_t slot = it->second;
+                uint32_t advance = ((ce->n.SQHD + sqSize - sqHead) % sqSize);
+                uint32_t pending = ((sqTail + sqSize - sqHead) % sqSize);
+                uint32_t passed = ((ce->n.SQHD + sqSize - slot) % sqSize);
+                uint32_t window = ((sqTail + sqSize - slot) % sqSize);
+                if (advance > pending) {
+                    snprintf(anomaly, sizeof(anomaly),
+                        "CE.SQHD=%d regressed or passed SQ tail, head was %d, "
+                        "tail is %d", (int)ce->n.SQHD, sqHead, sqTail);
+                } else if ((passed == 0) || (passed > window)) {
+                    snprintf(anomaly, sizeof(anomaly),
+                        "CE.SQHD=%d does not cover CID 0x%04X in SQ slot %d",
+                        (int)ce->n.SQHD, (int)ce->n.CID, slot);
+                }
+            }
+
+            if (anomaly[0] != '\0') {
+                cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq",
+                    "soak.anomaly"), "Dump Entire CQ");
+                sq->Dump(FileSystem::PrepDumpFile(grpName, testName, "sq",
+                    "soak.anomaly"), "Dump Entire SQ");
+                throw FrmwkEx(HERE, "Soak anomaly after %llu cmds, %llu SQ "
+                    "wraps, %llu CQ wraps: %s",
+                    (unsigned long long)stats.numCmds,
+                    (unsigned long long)stats.sqWraps,
+                    (unsigned long long)stats.cqWraps, anomaly);
+            }
+            ProcessCE::Validate(*ce);   // throws upon error
+
+            outstanding.erase(it);
+            sqHead = ce->n.SQHD;
+            if (++cqHead == cqSize) {
+                cqHead = 0;
+                phase ^= 1;
+                stats.cqWraps++;
+            }
+            stats.numCmds++;
+        }
+
+        if (gettimeofday(&now, NULL) != 0)
+            throw FrmwkEx(HERE, "Cannot retrieve system time");
+        stats.elapsed_us = ElapsedUsec(start, now);
+        if ((maxWraps && (MAX(stats.sqWraps, stats.cqWraps) >= maxWraps)) ||
+            (maxSec && (stats.elapsed_us >= ((uint64_t)maxSec * 1000000)))) {
+            stopping = true;
+        }
+        if ((now.tv_sec - lastReport.tv_sec) >= SOAK_REPORT_SEC) {
+            LogSoakStats(stats);
+            lastReport = now;
+        }
+    }
+    LogSoakStats(stats);
+}
+
+
+void
+Workload::LogSoakStats(const SoakStats &stats)
+{
+    double sec = MAX(stats.elapsed_us, (uint64_t)1) / 1000000.0;
+
+    LOG_NRM("Soak: cmds=%llu, SQ wraps=%llu (%.1f/s), CQ wraps=%llu (%.1f/s)"
+        ", %.1f sec", (unsigned long long)stats.numCmds,
+        (unsigned long long)stats.sqWraps, (stats.sqWraps / sec),
+        (unsigned long long)stats.cqWraps, (stats.cqWraps / sec), sec);
+}
+
+
+void
+Workload::LogStats(string qualify, const WorkloadStats &stats)
+{
+    uint64_t cmds = MAX(stats.numCmds, (uint64_t)1);
+    uint64_t us = MAX(stats.elapsed_us, (uint64_t)1);
+
+    LOG_NRM("%s: cmds=%llu, irqs/cmd=%.3f, lat(us) min/avg/max=%llu/%llu/%llu"
+        ", IOPS=%llu, MB/s=%.1f", qualify.c_str(),
+        (unsigned long long)stats.numCmds, (double)stats.isrCount / cmds,
+        (unsigned long long)stats.latMin_us,
+        (unsigned long long)(stats.latSum_us / cmds),
+        (unsigned long long)stats.latMax_us,
+        (unsigned long long)((stats.numCmds * 1000000) / us),
+        (double)stats.numBytes / us);
+}
+
+
+std::vector<SharedCmdPtr>
+Workload::CreateReadCmds(uint32_t qDepth)
+{
+    std::vector<SharedCmdPtr> cmds;
+    Informative::Namspc namspcData = gInformative->Get1stBareMetaE2E();
+    LBAFormat lbaFormat = namspcData.idCmdNamspc->GetLBAFormat();
+    uint64_t lbaDataSize = namspcData.idCmdNamspc->GetLBADataSize();
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)(MASK_PRP1_PAGE
+        | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+
+    // Separate meta data bufs for every cmd are reserved up front
+    if ((namspcData.type == Informative::NS_METAS) ||
+        (namspcData.type == Informative::NS_E2ES)) {
+        if ((gRsrcMngr->SetMetaAllocSize(lbaFormat.MS) == false) ||
+            (gRsrcMngr->PreallocMetaBuf(qDepth) == false)) {
+            throw FrmwkEx(HERE);
+        }
+    }
+
+    for (uint32_t i = 0; i < qDepth; i++) {
+        SharedReadPtr readCmd = SharedReadPtr(new Read());
+        SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
+
+        switch (namspcData.type) {
+        case Informative::NS_BARE:
+            readMem->Init(lbaDataSize);
+            break;
+        case Informative::NS_METAS:
+            readMem->Init(lbaDataSize);
+            readCmd->AllocMetaBuffer();
+            break;
+        case Informative::NS_METAI:
+            readMem->Init(lbaDataSize + lbaFormat.MS);
+            break;
+        case Informative::NS_E2ES:
+            readMem->Init(lbaDataSize);
+            readCmd->AllocMetaBuffer();
+            break;
+        case Informative::NS_E2EI:
+            readMem->Init(lbaDataSize + lbaFormat.MS);
+            break;
+        }
+        readCmd->SetPrpBuffer(prpBitmask, readMem);
+        readCmd->SetNSID(namspcData.id);
+        cmds.push_back(readCmd);
+    }
+    return cmds;
+}
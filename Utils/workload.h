@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _WORKLOAD_H_
+#define _WORKLOAD_H_
+
+#include <vector>
+#include "tnvme.h"
+#include "../Queues/sq.h"
+#include "../Queues/cq.h"
+
+
+/**
+ * Statistics gathered while sustaining a workload against a SQ/CQ pair.
+ * Latencies are measured from ringing the SQ doorbell until the CE is reaped
+ * from the CQ, thus they include the host side reaping overhead.
+ */
+struct WorkloadStats {
+    uint64_t numCmds;       // Number of cmds which were completed
+    uint64_t numBytes;      // Number of bytes xfer'd by the completed cmds
+    uint64_t elapsed_us;    // Wall clock time to complete all cmds
+    uint32_t isrCount;      // Number of ISR's which fired during the workload
+    uint64_t latMin_us;
+    uint64_t latMax_us;
+    uint64_t latSum_us;
+};
+
+
+/**
+ * Statistics gathered while soaking a SQ/CQ pair with SoakWrap().
+ */
+struct SoakStats {
+    uint64_t numCmds;       // Number of cmds which were completed
+    uint64_t sqWraps;       // Number of times the SQ tail rolled over
+    uint64_t cqWraps;       // Number of times the CQ head rolled over
+    uint64_t elapsed_us;    // Wall clock time of the soak
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. These utility functions can be viewed as wrappers to
+* perform common, repetitious tasks which avoids coping the same chunks of
+* code throughout the framework.
+*
+* @note This class may throw exceptions, please see comment within specific
+*       methods.
+*/
+class Workload
+{
+public:
+    Workload();
+    virtual ~Workload();
+
+    /**
+     * Keep a fixed number of cmds outstanding against the spec'd SQ/CQ pair
+     * until the desired number of cmds have completed. Each cmd in cmds is
+     * one slot of the queue depth; as soon as a slot's CE is reaped the same
+     * cmd is resubmitted. This method requires 0 elements to reside in the
+     * CQ and also assumes no other cmd will complete into that CQ while this
+     * operation is occurring. Every CE must report successful status.
+     * @note Throws upon errors
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param sq Pass pre-existing SQ to issue cmds into
+     * @param cq Pass pre-existing CQ to reap CE's from
+     * @param cmds Pass the cmds to keep outstanding, the queue depth is
+     *      cmds.size() and must be less than the number of entries in
+     *      either queue.
+     * @param numCmds Pass the total number of cmds to complete
+     * @param stats Returns the statistics gathered during the workload
+     */
+    static void SustainQD(string grpName, string testName, SharedSQPtr sq,
+        SharedCQPtr cq, std::vector<SharedCmdPtr> &cmds, uint64_t numCmds,
+        WorkloadStats &stats);
+
+    /**
+     * Identical to SustainQD() above, however multiple SQ's feed a single CQ
+     * and every SQ is kept saturated concurrently. The numCmds limit applies
+     * to the sum of cmds completed across all SQ's, thus the share each SQ
+     * achieves reflects how the DUT arbitrates between them.
+     * @note Throws upon errors
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param sqs Pass pre-existing SQ's to issue cmds into
+     * @param cq Pass the pre-existing CQ all of the SQ's complete into
+     * @param cmds Pass 1 set of cmds for each SQ, each set's size is the
+     *      queue depth for that SQ. The sum of all queue depths must be less
+     *      than the number of entries in the CQ.
+     * @param numCmds Pass the total number of cmds to complete
+     * @param stats Returns the statistics gathered for each SQ, indexed
+     *      identically to sqs; isrCount is that of the shared CQ.
+     */
+    static void SustainQD(string grpName, string testName,
+        std::vector<SharedSQPtr> &sqs, SharedCQPtr cq,
+        std::vector<std::vector<SharedCmdPtr> > &cmds, uint64_t numCmds,
+        std::vector<WorkloadStats> &stats);
+
+    /**
+     * Keep the spec'd SQ/CQ pair full with the spec'd cmd, continuously
+     * wrapping both queues until either limit is reached. Every CE is checked
+     * for successful status, CE.SQID, the CE phase tag anticipated at that
+     * position of the CQ, CE.CID matching an outstanding cmd, and CE.SQHD
+     * never regressing nor passing the SQ tail while covering the cmd's
+     * own SQ slot. The 1st anomaly dumps both queues and throws. This method
+     * requires both queues to be empty and dedicated to this operation.
+     * @note Throws upon errors
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param sq Pass pre-existing SQ to issue cmds into
+     * @param cq Pass pre-existing CQ to reap CE's from
+     * @param cmd Pass the cmd to issue repeatedly
+     * @param maxWraps Pass the number of wraps of the faster wrapping queue
+     *      after which to stop, 0 implies no limit
+     * @param maxSec Pass the number of seconds after which to stop, 0 implies
+     *      no limit
+     * @param stats Returns the statistics gathered during the soak
+     */
+    static void SoakWrap(string grpName, string testName, SharedSQPtr sq,
+        SharedCQPtr cq, SharedCmdPtr cmd, uint64_t maxWraps, uint32_t maxSec,
+        SoakStats &stats);
+
+    /**
+     * Create a set of read cmds suitable to be passed to SustainQD(). Each
+     * cmd reads 1 block at LBA 0 of the 1st bare, meta or E2E namspc into
+     * its own buffer, thus the cmds never modify the media. PI is returned
+     * unchecked, i.e. PRINFO=0, since LBA 0 may never have been written.
+     * @note Throws upon errors
+     * @param qDepth Pass the number of cmds to create
+     * @return The newly created cmds
+     */
+    static std::vector<SharedCmdPtr> CreateReadCmds(uint32_t qDepth);
+
+    /**
+     * Log the stats gathered by SustainQD() as a single line.
+     * @param qualify Pass a qualifying string to prepend to the line
+     * @param stats Pass the statistics to log
+     */
+    static void LogStats(string qualify, const WorkloadStats &stats);
+
+    /**
+     * Log the stats gathered by SoakWrap() as a single line.
+     * @param stats Pass the statistics to log
+     */
+    static void LogSoakStats(const SoakStats &stats);
+
+    /**
+     * Calculate the number of micro seconds elapsed between 2 points in time.
+     * @param start Pass the earlier point in time
+     * @param end Pass the later point in time
+     * @return The number of usec's elapsed, 0 if end occurs before start
+     */
+    static uint64_t ElapsedUsec(const struct timeval &start,
+        const struct timeval &end);
+};
+
+
+#endif
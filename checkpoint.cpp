@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fstream>
+#include <boost/format.hpp>
+#include "tnvme.h"
+#include "checkpoint.h"
+
+#define CHECKPOINT_VERSION          1
+
+#define ZZ(a, b)          #a,
+static const char *resultKey[] =
+{
+    TR_TABLE
+};
+#undef ZZ
+
+
+Checkpoint::Checkpoint()
+{
+}
+
+
+Checkpoint::~Checkpoint()
+{
+}
+
+
+bool
+Checkpoint::Save(string filename, const CheckpointState &state)
+{
+    string tmpName = filename + ".tmp";
+    FILE *fp;
+
+    if ((fp = fopen(tmpName.c_str(), "w")) == NULL) {
+        LOG_ERR("Unable to open checkpoint file: %s", tmpName.c_str());
+        return false;
+    }
+
+    fprintf(fp, "version=%d\n", CHECKPOINT_VERSION);
+    fprintf(fp, "target=%ld:%ld.%ld.%ld\n", state.target.group,
+        state.target.xLev, state.target.yLev, state.target.zLev);
+    fprintf(fp, "numLoops=%ld\n", state.numLoops);
+    fprintf(fp, "loop=%ld\n", state.loop);
+    fprintf(fp, "group=%ld\n", state.group);
+    fprintf(fp, "numGrps=%d\n", state.numGrps);
+    fprintf(fp, "elapsed_us=%llu\n", (unsigned long long)state.elapsed_us);
+    for (int i = 0; i < TR_FENCE; i++)
+        fprintf(fp, "%s=%d\n", resultKey[i], state.results.getResult(
+            (TestResult)i));
+    fprintf(fp, "failed=%s\n", ToString(state.failedTests).c_str());
+    fprintf(fp, "skipped=%s\n", ToString(state.skippedTests).c_str());
+    fprintf(fp, "done=%s\n", ToString(state.done).c_str());
+
+    bool ok = ((fflush(fp) == 0) && (fsync(fileno(fp)) == 0));
+    ok = ((fclose(fp) == 0) && ok);
+    if ((ok == false) || (rename(tmpName.c_str(), filename.c_str()) != 0)) {
+        LOG_ERR("Unable to write checkpoint file: %s", filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+bool
+Checkpoint::Load(string filename, CheckpointState &state)
+{
+    string work;
+    int version = 0;
+
+    // Lines are unbounded, the test lists grow with every --loop iteration
+    ifstream file(filename.c_str());
+    if (file.is_open() == false) {
+        LOG_ERR("Unable to open checkpoint file: %s", filename.c_str());
+        return false;
+    }
+
+    state = CheckpointState();
+    while (getline(file, work)) {
+        size_t eqLoc = work.find('=');
+        if (eqLoc == string::npos)
+            continue;
+        string key = work.substr(0, eqLoc);
+        const char *line = key.c_str();
+        const char *val = (work.c_str() + eqLoc + 1);
+
+        unsigned long long ull;
+        int num;
+        bool ok = true;
+        if (strcmp(line, "version") == 0) {
+            ok = (sscanf(val, "%d", &version) == 1);
+        } else if (strcmp(line, "target") == 0) {
+            ok = (sscanf(val, "%ld:%ld.%ld.%ld", &state.target.group,
+                &state.target.xLev, &state.target.yLev,
+                &state.target.zLev) == 4);
+        } else if (strcmp(line, "numLoops") == 0) {
+            ok = (sscanf(val, "%ld", &state.numLoops) == 1);
+        } else if (strcmp(line, "loop") == 0) {
+            ok = (sscanf(val, "%ld", &state.loop) == 1);
+        } else if (strcmp(line, "group") == 0) {
+            ok = (sscanf(val, "%ld", &state.group) == 1);
+        } else if (strcmp(line, "numGrps") == 0) {
+            ok = (sscanf(val, "%d", &state.numGrps) == 1);
+        } else if (strcmp(line, "elapsed_us") == 0) {
+            ok = (sscanf(val, "%llu", &ull) == 1);
+            state.elapsed_us = ull;
+        } else if (strcmp(line, "failed") == 0) {
+            ok = FromString(val, state.failedTests);
+        } else if (strcmp(line, "skipped") == 0) {
+            ok = FromString(val, state.skippedTests);
+        } else if (strcmp(line, "done") == 0) {
+            ok = FromString(val, state.done);
+        } else {
+            for (int i = 0; i < TR_FENCE; i++) {
+                if (strcmp(line, resultKey[i]) == 0) {
+                    ok = (sscanf(val, "%d", &num) == 1);
+                    state.results.addResult((TestResult)i, num);
+                    break;
+                }
+            }
+        }
+
+        if (ok == false) {
+            LOG_ERR("Checkpoint file corrupt at key: %s", line);
+            return false;
+        }
+    }
+
+    if (version != CHECKPOINT_VERSION) {
+        LOG_ERR("Checkpoint file version %d unsupported", version);
+        return false;
+    }
+    return true;
+}
+
+
+string
+Checkpoint::ToString(const vector<TestRef> &tests)
+{
+    string list;
+    vector<TestRef> distinct;
+    vector<size_t> count;
+
+    // A test repeats every --loop iteration, persist how often rather than
+    // each occurrence to keep the file, and rewriting it, bounded
+    for (size_t i = 0; i < tests.size(); i++) {
+        size_t j;
+        for (j = 0; j < distinct.size(); j++) {
+            if (distinct[j] == tests[i])
+                break;
+        }
+        if (j == distinct.size()) {
+            distinct.push_back(tests[i]);
+            count.push_back(0);
+        }
+        count[j]++;
+    }
+
+    for (size_t i = 0; i < distinct.size(); i++) {
+        list += str(boost::format("%s%ld:%ld.%ld.%ld") % (i ? "," : "") %
+            distinct[i].group % distinct[i].xLev % distinct[i].yLev %
+            distinct[i].zLev);
+        if (count[i] > 1)
+            list += str(boost::format("*%ld") % count[i]);
+    }
+    return list;
+}
+
+
+bool
+Checkpoint::FromString(string list, vector<TestRef> &tests)
+{
+    size_t pos = 0;
+
+    tests.clear();
+    while (pos < list.length()) {
+        size_t end = list.find(',', pos);
+        if (end == string::npos)
+            end = list.length();
+
+        // Parsing <g:x.y.z>[*<count>]
+        TestRef tr;
+        size_t count = 1;
+        int num = sscanf(list.substr(pos, (end - pos)).c_str(),
+            "%ld:%ld.%ld.%ld*%ld", &tr.group, &tr.xLev, &tr.yLev, &tr.zLev,
+            &count);
+        if ((num < 4) || (count == 0))
+            return false;
+        tests.insert(tests.end(), count, tr);
+        pos = (end + 1);
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include "testRef.h"
+#include "testResults.h"
+
+
+/**
+ * The progress of ExecuteTests() which is needed to continue a run at the
+ * point it was interrupted.
+ */
+struct CheckpointState {
+    TestRef     target;         // cmd line --test target the run satisfies
+    size_t      numLoops;       // cmd line --loop count of the run
+    size_t      loop;           // loop iteration in progress
+    size_t      group;          // group in progress within that loop
+    int         numGrps;        // groups started so far, all iterations
+    uint64_t    elapsed_us;     // wall clock time spent so far, all attempts
+    TestResults results;        // accumulated results so far
+    std::vector<TestRef> failedTests;
+    std::vector<TestRef> skippedTests;
+    /// Tests of 'group' already completed; empty when it hasn't started
+    std::vector<TestRef> done;
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. A checkpoint is a small text file of key=value lines which
+* ExecuteTests() rewrites after every test, see cmd line option --checkpoint,
+* so that --resume can continue a long run after a crash or host reboot.
+*
+* @note This class will not throw exceptions.
+*/
+class Checkpoint
+{
+public:
+    Checkpoint();
+    virtual ~Checkpoint();
+
+    /**
+     * Persist the state, atomically replacing any previous checkpoint. The
+     * data is synced to the media before the rename, thus either the new or
+     * the old checkpoint survives a power loss.
+     * @param filename Pass the name of the checkpoint file
+     * @param state Pass the state to persist
+     * @return true upon success, otherwise false
+     */
+    static bool Save(std::string filename, const CheckpointState &state);
+
+    /**
+     * Retrieve the state persisted by Save().
+     * @param filename Pass the name of the checkpoint file
+     * @param state Returns the persisted state
+     * @return true upon success, otherwise false
+     */
+    static bool Load(std::string filename, CheckpointState &state);
+
+
+private:
+    static std::string ToString(const std::vector<TestRef> &tests);
+    static bool FromString(std::string list, std::vector<TestRef> &tests);
+};
+
+
+#endif
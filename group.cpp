@@ -14,9 +14,17 @@
  *  limitations under the License.
  */
 
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include "tnvme.h"
 #include "group.h"
 #include "globals.h"
+#include "resultsWriter.h"
+#include "Utils/fileSystem.h"
+#include "Utils/dumpArchive.h"
+#include "Utils/workload.h"
+#include "Utils/probes.h"
 
 #define PAD_INDENT_LVL1         "    "
 #define PAD_INDENT_LVL2         "      "
@@ -201,12 +209,55 @@ Group::GetTestSet(TestRef &target, TestSetType &dependencies, int64_t &tstIdx)
         }
     }
 
+    mDag.Build(dependencies);
+    mDag.Log();
+
     tstIdx = 0;
     LOG_DBG("dependencies(size)=%ld, tstIdx=%ld", dependencies.size(), tstIdx);
     return true;
 }
 
 
+void
+Group::ResumeTestSet(const vector<TestRef> &done, TestSetType &dependencies,
+    int64_t &tstIdx, int64_t &numReplay)
+{
+    vector<bool> isDone(dependencies.size(), false);
+    vector<bool> replay(dependencies.size(), false);
+    TestSetType remain;
+
+    for (size_t i = 0; i < dependencies.size(); i++) {
+        for (size_t d = 0; d < done.size(); d++) {
+            TestRef tr = done[d];
+            if (tr == dependencies[i])
+                isDone[i] = true;
+        }
+        if (isDone[i])
+            continue;
+
+        remain.push_back(dependencies[i]);
+        for (size_t a = 0; a < i; a++) {
+            if (isDone[a] && mDag.DependsOn(i, a))
+                replay[a] = true;
+        }
+    }
+
+    TestSetType resumed;
+    for (size_t i = 0; i < dependencies.size(); i++) {
+        if (replay[i]) {
+            LOG_NRM("Replaying %s", dependencies[i].ToString().c_str());
+            resumed.push_back(dependencies[i]);
+        }
+    }
+    numReplay = resumed.size();
+    resumed.insert(resumed.end(), remain.begin(), remain.end());
+
+    dependencies = resumed;
+    mDag.Build(dependencies);
+    tstIdx = (dependencies.size() ? 0 : -1);
+}
+
+
 TestResult
 Group::RunTest(TestSetType &dependencies, int64_t &tstIdx,
     vector<TestRef> &skipTest, int64_t &numSkipped, bool preserve,
@@ -242,6 +293,12 @@ Group::RunTest(TestSetType &dependencies, int64_t &tstIdx,
         }
     }
 
+#ifdef DEBUG
+    // Objs not owned by the RsrcMngr have test lifetime and must be gone
+    // once the test completes, see check following the test's execution
+    uint64_t numAlive = (Trackable::GetNumAlive() - gRsrcMngr->GetNumObj());
+#endif
+
     LOG_NRM("-----------------START TEST-----------------");
     FORMAT_GROUP_DESCRIPTION(work, this)
     LOG_NRM("%s", work.c_str());
@@ -253,6 +310,16 @@ Group::RunTest(TestSetType &dependencies, int64_t &tstIdx,
     LOG_NRM("Compliance: %s", (*myTest)->GetComplianceDescription().c_str());
     LOG_NRM("%s", (*myTest)->GetLongDescription(false, 0).c_str());
 
+    struct timeval start;
+    gettimeofday(&start, NULL);
+    IoCounters before = IoStats::Get();
+    size_t firstSkipped = skippedTests.size();
+    struct rusage usage;
+    usage.ru_maxrss = 0;
+    if (ResultsWriter::IsOpen())
+        getrusage(RUSAGE_SELF, &usage);
+    TNVME_PROBE4(test_start, tr.group, tr.xLev, tr.yLev, tr.zLev);
+
     if (SkippingTest(tr, skipTest)) {
         result = TR_SKIPPING;
         skippedTests.push_back(tr);
@@ -300,6 +367,20 @@ Group::RunTest(TestSetType &dependencies, int64_t &tstIdx,
     LOG_NRM("%s", work.c_str());
     LOG_NRM("------------------END TEST------------------");
 
+    // A rerun is not a result of its own, the tests it skips still are
+    if (tr.rerun) {
+        if (result == TR_FAIL) {
+            LOG_ERR("Rerun of %s failed", tr.ToString().c_str());
+            failedTests.pop_back();
+        } else if (result == TR_SKIPPING) {
+            skippedTests.erase(skippedTests.begin() + firstSkipped);
+            numSkipped--;
+        }
+    }
+    TNVME_PROBE5(test_end, tr.group, tr.xLev, tr.yLev, tr.zLev, (int)result);
+    ReportResult(tr, result, start, before, usage.ru_maxrss, skippedTests,
+        firstSkipped);
+
     // The last test within every group or a test failure must be following
     // with a chance to restore the state of the DUT, if and only if the
     // feature is enabled.
@@ -312,14 +393,18 @@ Group::RunTest(TestSetType &dependencies, int64_t &tstIdx,
         }
     }
 
-    // Guarantee nothing residing or unintended is left around. Enforce this
-    // by destroying the existing test obj and replace it with a clone of
-    // itself so looping tests over can still be supported.
-    LOG_DBG("Enforcing test obj cleanup, cloning & destroying");
-    Test *cleanMeUp = (*myTest);  // Refer to test obj
-    deque<Test *>::iterator insertPos = mTests[tr.xLev][tr.yLev].erase(myTest);
-    mTests[tr.xLev][tr.yLev].insert(insertPos, cleanMeUp->Clone());
-    delete cleanMeUp;
+    // Guarantee nothing residing or unintended is left around, the same test
+    // obj is reused so looping tests over can still be supported.
+    LOG_DBG("Enforcing test obj cleanup, resetting");
+    (*myTest)->Reset();
+
+#ifdef DEBUG
+    uint64_t numLeaked = (Trackable::GetNumAlive() - gRsrcMngr->GetNumObj());
+    if (numLeaked > numAlive) {
+        LOG_ERR("Test %s left %ld trackable obj(s) alive outside RsrcMngr",
+            tr.ToString().c_str(), (long)(numLeaked - numAlive));
+    }
+#endif
     return result;
 }
 
@@ -329,65 +414,42 @@ Group::AdvanceDependencies(TestSetType &dependencies, int64_t &tstIdx,
     bool failed, vector<TestRef> &skippedTests)
 {
     int64_t origTstIdx = tstIdx;
-    int64_t work;
 
     // Preliminary error checking
     if ((tstIdx >= (int64_t)dependencies.size()) || (tstIdx == -1)) {
         tstIdx = -1;
         return 0;
     }
-    TestRef dt = dependencies[tstIdx];      // DependentTest  (dt)
+    size_t dt = tstIdx;                     // DependentTest  (dt)
 
-    if (++tstIdx >= (int64_t)dependencies.size()) {
-        tstIdx = -1;
-        return 0;
+    // Only the tests which depend upon dt, directly or transitively, are
+    // skipped; the next independent branch proceeds
+    while ((size_t)++tstIdx < dependencies.size()) {
+        if (mDag.DependsOn(tstIdx, dt) == false)
+            break;
+        skippedTests.push_back(dependencies[tstIdx]);
     }
-    TestRef st = dependencies[tstIdx];      // SubsequentTest (st)
-
-    if (failed) {
-        // When a test fails, a FrmwkEx() is thrown and performs a
-        // DISABLE_COMPLETELY. This is the most destructive action in the
-        // framework, and thus everything subsequent of the xLev must be
-        // considered dependents since no resource remains in the DUT
-        while (dt.xLev == st.xLev) {
-            skippedTests.push_back(st);
-            if (++tstIdx >= (int64_t)dependencies.size()) {
-                work = ((tstIdx - origTstIdx) - 1);
-                tstIdx = -1;
-                return work;
-            }
-            st = dependencies[tstIdx];
-        }
-    } else {
-        // A failure didn't occur, something was skipped rather and thus
-        // a complete destruction of resource did not occur. Considering
-        // only those dependents which rely upon the now missing logic.
-        if ((dt.yLev == 0) && (dt.zLev == 0)) {
-            // All the following are dependents
-            while (dt.xLev == st.xLev) {
-                skippedTests.push_back(st);
-                if (++tstIdx >= (int64_t)dependencies.size()) {
-                    work = ((tstIdx - origTstIdx) - 1);
-                    tstIdx = -1;
-                    return work;
-                }
-                st = dependencies[tstIdx];
-            }
-        } else {
-            // All the following are dependents
-            while ((dt.xLev == st.xLev)  && (dt.yLev == st.yLev)){
-                skippedTests.push_back(st);
-                if (++tstIdx >= (int64_t)dependencies.size()) {
-                    work = ((tstIdx - origTstIdx) - 1);
-                    tstIdx = -1;
-                    return work;
-                }
-                st = dependencies[tstIdx];
-            }
-        }
+    int64_t numSkipped = (tstIdx - origTstIdx - 1);
+    if (tstIdx >= (int64_t)dependencies.size()) {
+        tstIdx = -1;
+        return numSkipped;
     }
 
-    return (tstIdx - origTstIdx - 1);
+    // When a test fails, a FrmwkEx() is thrown and performs a
+    // DISABLE_COMPLETELY. This is the most destructive action in the
+    // framework, no resource remains in the DUT. Rather than considering
+    // everything subsequent of the xLev a dependent, rerun the test which
+    // provides the resources the next independent branch consumes.
+    size_t provider;
+    if (failed && mDag.GetResourceProvider(tstIdx, provider)) {
+        TestRef pt = dependencies[provider];
+        pt.rerun = true;
+        LOG_NRM("Resources destroyed, rerun %s before continuing with %s",
+            pt.ToString().c_str(), dependencies[tstIdx].ToString().c_str());
+        dependencies.insert((dependencies.begin() + tstIdx), pt);
+        mDag.Build(dependencies);
+    }
+    return numSkipped;
 }
 
 
@@ -492,3 +554,66 @@ RestoreState()
     LOG_NRM("Restoring state is intended to be over ridden in children");
     return true;
 }
+
+
+void
+Group::ReportResult(TestRef tr, TestResult result, const struct timeval &start,
+    const IoCounters &before, long rssBefore_kb, vector<TestRef> &skippedTests,
+    size_t firstSkipped)
+{
+    struct timeval now;
+    struct rusage usage;
+    struct stat dumpStat;
+    ResultRecord rec;
+
+    gettimeofday(&now, NULL);
+    deque<Test *>::iterator myTest = mTests[tr.xLev][tr.yLev].begin();
+    advance(myTest, tr.zLev);
+
+    rec.tr = tr;
+    rec.grpName = mGrpName;
+    rec.className = (*myTest)->GetClassName();
+    rec.result = result;
+    if (result == TR_FAIL)
+        rec.failure = (*myTest)->GetFailure();
+    rec.wall_us = Workload::ElapsedUsec(start, now);
+    rec.io = (IoStats::Get() - before);
+    rec.dumpBytes = 0;
+    rec.rssPeak_kb = 0;
+    rec.rssGrowth_kb = 0;
+
+    // Listing the dumps and the RSS are only reported to --results
+    if (ResultsWriter::IsOpen()) {
+        rec.dumps = FileSystem::GetDumpFiles(mGrpName, rec.className);
+        for (size_t i = 0; i < rec.dumps.size(); i++) {
+            if (DumpArchive::IsOpen())
+                rec.dumpBytes += DumpArchive::GetDumpSize(rec.dumps[i]);
+            else if (stat(rec.dumps[i].c_str(), &dumpStat) == 0)
+                rec.dumpBytes += dumpStat.st_size;
+        }
+        getrusage(RUSAGE_SELF, &usage);
+        rec.rssPeak_kb = usage.ru_maxrss;
+        rec.rssGrowth_kb = (usage.ru_maxrss - rssBefore_kb);
+    }
+    if (tr.rerun == false)
+        ResultsWriter::Record(rec);
+
+    // Dependents skipped because of this test never started
+    for (size_t i = firstSkipped; i < skippedTests.size(); i++) {
+        if (skippedTests[i] == tr)
+            continue;
+        myTest = mTests[skippedTests[i].xLev][skippedTests[i].yLev].begin();
+        advance(myTest, skippedTests[i].zLev);
+
+        rec.tr = skippedTests[i];
+        rec.className = (*myTest)->GetClassName();
+        rec.result = TR_SKIPPING;
+        rec.failure.clear();
+        rec.wall_us = 0;
+        rec.io = IoCounters();
+        rec.dumps.clear();
+        rec.dumpBytes = 0;
+        rec.rssGrowth_kb = 0;
+        ResultsWriter::Record(rec);
+    }
+}
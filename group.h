@@ -19,10 +19,13 @@
 
 #include <string>
 #include <deque>
+#include <sys/time.h>
 #include "tnvme.h"
 #include "test.h"
 #include "globals.h"
 #include "testResults.h"
+#include "testDag.h"
+#include "Utils/ioStats.h"
 
 
 /// Use to append a new x.0.0 test number at the XLEVEL
@@ -136,6 +139,20 @@ public:
     bool GetTestSet(TestRef &target, TestSetType &dependencies,
         int64_t &tstIdx);
 
+    /**
+     * Reduce a test set returned by GetTestSet() to those tests which are not
+     * done, preceded by the done tests they depend upon. The latter must be
+     * replayed to recreate the state of the DUT the former depend upon.
+     * @param done Pass the tests which have completed
+     * @param dependencies Pass the set returned by GetTestSet(), returns
+     *        the reduced set
+     * @param tstIdx Returns an index to the 1st test within dependencies,
+     *        -1 when there is nothing left to execute
+     * @param numReplay Returns the number of leading done tests to replay
+     */
+    void ResumeTestSet(const vector<TestRef> &done,
+        TestSetType &dependencies, int64_t &tstIdx, int64_t &numReplay);
+
     /**
      * Run a spec'd test case within the provided dependencies using tstIdx
      * which references the test to execute. Upon exit the tstIdx will
@@ -146,7 +163,8 @@ public:
      * @note The dependencies & tstIdx should be provided by GetTestSet()
      * @param dependencies Pass the ordered list of tests which are desired to
      *        be executed in sequence, one-at-a time. This set should not
-     *        be modified between consecutive calls to this method.
+     *        be modified by the caller between consecutive calls to this
+     *        method, although this method may insert tests to be rerun.
      * @param tstIdx Pass the index which points to the next test to
      *        execute, returns the next test in the dependencies to execute upon
      *        a subsequent call to RunTest(), returns -1 when the last test
@@ -172,6 +190,9 @@ protected:
     /// Refer to: https://github.com/nvmecompliance/tnvme/wiki/Test-Numbering
     deque<deque<deque<Test *> > > mTests;
 
+    /// Explicit dependencies of the test set last returned by GetTestSet()
+    TestDag mDag;
+
     /**
      * In coordination with cmd line option --restore, these functions should
      * be over ridden by children to support the saving and restoring of a DUT's
@@ -226,7 +247,9 @@ private:
      * Advance tstIdx so that the tests dependent upon the test case referenced
      * by dependencies[tstIdx] are skipped, the new returned value of tstIdx
      * will point to the next test to execute without dependencies upon the
-     * one being reference when the method is called.
+     * one being reference when the method is called. Dependents are those
+     * reported by mDag. Upon failure the test providing the resources of the
+     * next test is inserted into dependencies to be rerun first.
      * @param dependencies Pass the ordered list of tests which are desired to
      *        be executed in sequence.
      * @param tstIdx Pass the index which points to the test which all other
@@ -239,6 +262,22 @@ private:
     int64_t  AdvanceDependencies(TestSetType &dependencies, int64_t &tstIdx,
         bool failed, vector<TestRef> &skippedTests);
 
+    /**
+     * Account for the resources a test consumed and report its outcome to
+     * the ResultsWriter.
+     * @param tr Pass the test which executed, or was skipped
+     * @param result Pass the test's result
+     * @param start Pass the time at which the test started
+     * @param before Pass the IoStats counters at the time the test started
+     * @param rssBefore_kb Pass the peak RSS at the time the test started,
+     *        only measured while the ResultsWriter::IsOpen()
+     * @param skippedTests Pass the skipped tests, those appended from index
+     *        firstSkipped onward are reported as skipped descendants of tr
+     * @param firstSkipped Pass the size of skippedTests when the test started
+     */
+    void ReportResult(TestRef tr, TestResult result,
+        const struct timeval &start, const IoCounters &before,
+        long rssBefore_kb, vector<TestRef> &skippedTests, size_t firstSkipped);
 };
 
 
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <algorithm>
+#include <boost/format.hpp>
+#include "tnvme.h"
+#include "resultsWriter.h"
+
+/// Number of tests/ioctl's highlighted by LogSummary()
+#define SUMMARY_TOP_N           5
+
+string ResultsWriter::mBasename;
+FILE *ResultsWriter::mFp = NULL;
+FILE *ResultsWriter::mSuitesFp = NULL;
+size_t ResultsWriter::mLoop = 0;
+vector<ResultRecord> ResultsWriter::mRecords;
+
+
+ResultsWriter::ResultsWriter()
+{
+}
+
+
+ResultsWriter::~ResultsWriter()
+{
+}
+
+
+bool
+ResultsWriter::Open(string basename)
+{
+    string filename = basename + ".jsonl";
+
+    if (mFp != NULL)
+        Close();
+
+    if ((mFp = fopen(filename.c_str(), "a")) == NULL) {
+        LOG_ERR("Unable to open results file: %s", filename.c_str());
+        return false;
+    }
+
+    // The testsuites of completed groups await Close() in here
+    if ((mSuitesFp = tmpfile()) == NULL) {
+        LOG_ERR("Unable to create a temporary file for JUnit testsuites");
+        fclose(mFp);
+        mFp = NULL;
+        return false;
+    }
+    mBasename = basename;
+    mRecords.clear();
+    return true;
+}
+
+
+void
+ResultsWriter::Record(const ResultRecord &rec)
+{
+    TestRef tr = rec.tr;
+
+    mRecords.push_back(rec);
+    mRecords.back().loop = mLoop;
+    if (mFp == NULL)
+        return;
+
+    fprintf(mFp, "{\"test\":\"%s\",\"loop\":%ld,\"group\":\"%s\","
+        "\"class\":\"%s\",\"result\":\"%s\",\"failure\":\"%s\","
+        "\"wall_us\":%llu,\"cmds\":%llu,\"bytes\":%llu,"
+        "\"bytes_to_dev\":%llu,\"bytes_from_dev\":%llu,\"ioctls\":%llu,"
+        "\"ioctl_us\":%llu,\"allocs\":%llu,\"alloc_bytes\":%llu,"
+        "\"dump_bytes\":%llu,\"rss_peak_kb\":%llu,\"rss_growth_kb\":%llu,",
+        tr.ToString().c_str(), mLoop, Escape(rec.grpName, false).c_str(),
+        Escape(rec.className, false).c_str(),
+        TestResults::getDesc(rec.result), Escape(rec.failure, false).c_str(),
+        (unsigned long long)rec.wall_us,
+        (unsigned long long)rec.io.numCmds,
+        (unsigned long long)rec.io.numBytes,
+        (unsigned long long)rec.io.numBytesToDev,
+        (unsigned long long)rec.io.numBytesFromDev,
+        (unsigned long long)rec.io.numIoctls,
+        (unsigned long long)rec.io.ioctl_us,
+        (unsigned long long)rec.io.numAllocs,
+        (unsigned long long)rec.io.numAllocBytes,
+        (unsigned long long)rec.dumpBytes,
+        (unsigned long long)rec.rssPeak_kb,
+        (unsigned long long)rec.rssGrowth_kb);
+
+    fprintf(mFp, "\"ioctl\":{");
+    map<unsigned long, IoctlCounters>::const_iterator i;
+    for (i = rec.io.ioctls.begin(); i != rec.io.ioctls.end(); i++) {
+        fprintf(mFp, "%s\"%s\":{\"num\":%llu,\"us\":%llu}",
+            ((i == rec.io.ioctls.begin()) ? "" : ","),
+            IoStats::IoctlName(i->first), (unsigned long long)i->second.num,
+            (unsigned long long)i->second.usec);
+    }
+    fprintf(mFp, "},\"dumps\":[");
+    for (size_t d = 0; d < rec.dumps.size(); d++) {
+        fprintf(mFp, "%s\"%s\"", (d ? "," : ""),
+            Escape(rec.dumps[d], false).c_str());
+    }
+    fprintf(mFp, "]}\n");
+
+    // The consumer may be following the file, don't let records linger
+    if (fflush(mFp) != 0)
+        LOG_WARN("Unable to flush results file");
+}
+
+
+void
+ResultsWriter::LogSummary(string grpName, size_t firstRecord)
+{
+    IoCounters io;
+    uint64_t wall_us = 0;
+    uint64_t dumpBytes = 0;
+    uint64_t rssPeak_kb = 0;
+    size_t numDumps = 0;
+    vector<size_t> byWall;
+
+    for (size_t i = firstRecord; i < mRecords.size(); i++) {
+        if (mRecords[i].grpName != grpName)
+            continue;
+        io += mRecords[i].io;
+        wall_us += mRecords[i].wall_us;
+        dumpBytes += mRecords[i].dumpBytes;
+        numDumps += mRecords[i].dumps.size();
+        rssPeak_kb = MAX(rssPeak_kb, mRecords[i].rssPeak_kb);
+        if (mRecords[i].wall_us)
+            byWall.push_back(i);
+    }
+    if (byWall.empty()) {
+        Forget(firstRecord);
+        return;
+    }
+
+    LOG_NRM("Group %s resource accounting, %ld test(s) ran for %llu ms:",
+        grpName.c_str(), byWall.size(), (unsigned long long)(wall_us / 1000));
+    LOG_NRM("   %llu ioctl(s) consumed %llu ms, %llu cmd(s), "
+        "%llu/%llu byte(s) to/from DUT",
+        (unsigned long long)io.numIoctls, (unsigned long long)(io.ioctl_us /
+        1000), (unsigned long long)io.numCmds,
+        (unsigned long long)io.numBytesToDev,
+        (unsigned long long)io.numBytesFromDev);
+    if (mFp == NULL) {
+        // Dumps and RSS are only gathered for --results
+        LOG_NRM("   %llu alloc(s) of %llu byte(s)",
+            (unsigned long long)io.numAllocs,
+            (unsigned long long)io.numAllocBytes);
+    } else {
+        LOG_NRM("   %llu alloc(s) of %llu byte(s), %ld dump(s) of %llu "
+            "byte(s), peak RSS %llu KB", (unsigned long long)io.numAllocs,
+            (unsigned long long)io.numAllocBytes, numDumps,
+            (unsigned long long)dumpBytes, (unsigned long long)rssPeak_kb);
+    }
+
+    // Point at where optimizing would pay off the most
+    size_t numTop = MIN(byWall.size(), (size_t)SUMMARY_TOP_N);
+    partial_sort(byWall.begin(), byWall.begin() + numTop, byWall.end(),
+        MoreWall);
+    LOG_NRM("   Most time consuming test(s):");
+    for (size_t i = 0; i < numTop; i++) {
+        ResultRecord &rec = mRecords[byWall[i]];
+        LOG_NRM("      %s %s: %llu ms, %llu ms within %llu ioctl(s)",
+            rec.tr.ToString().c_str(), rec.className.c_str(),
+            (unsigned long long)(rec.wall_us / 1000),
+            (unsigned long long)(rec.io.ioctl_us / 1000),
+            (unsigned long long)rec.io.numIoctls);
+    }
+
+    vector<pair<uint64_t, unsigned long> > byUsec;
+    map<unsigned long, IoctlCounters>::const_iterator i;
+    for (i = io.ioctls.begin(); i != io.ioctls.end(); i++)
+        byUsec.push_back(make_pair(i->second.usec, i->first));
+    sort(byUsec.rbegin(), byUsec.rend());
+    LOG_NRM("   Most time consuming ioctl(s):");
+    for (size_t u = 0; u < MIN(byUsec.size(), (size_t)SUMMARY_TOP_N); u++) {
+        LOG_NRM("      %s: %llu call(s), %llu ms",
+            IoStats::IoctlName(byUsec[u].second),
+            (unsigned long long)io.ioctls[byUsec[u].second].num,
+            (unsigned long long)(byUsec[u].first / 1000));
+    }
+    Forget(firstRecord);
+}
+
+
+void
+ResultsWriter::Forget(size_t firstRecord)
+{
+    // Only the JUnit XML needs the records beyond the group's summary, keep
+    // its testsuite rather than the records so memory doesn't grow per loop
+    if (mFp != NULL)
+        WriteSuites(firstRecord);
+    if (firstRecord < mRecords.size())
+        mRecords.resize(firstRecord);
+}
+
+
+bool
+ResultsWriter::MoreWall(size_t a, size_t b)
+{
+    return (mRecords[a].wall_us > mRecords[b].wall_us);
+}
+
+
+bool
+ResultsWriter::Close()
+{
+    if (mFp == NULL)
+        return true;
+
+    WriteSuites(0);     // groups which never completed
+    bool ok = WriteJUnit();
+    if (fclose(mFp) != 0) {
+        LOG_ERR("Unable to close results file");
+        ok = false;
+    }
+    fclose(mSuitesFp);
+    mFp = NULL;
+    mSuitesFp = NULL;
+    mRecords.clear();
+    return ok;
+}
+
+
+void
+ResultsWriter::WriteSuites(size_t firstRecord)
+{
+    vector<pair<string, size_t> > suites;
+
+    // A testsuite per group and loop, in the order the groups executed
+    for (size_t i = firstRecord; i < mRecords.size(); i++) {
+        pair<string, size_t> suite(mRecords[i].grpName, mRecords[i].loop);
+        if (find(suites.begin(), suites.end(), suite) == suites.end())
+            suites.push_back(suite);
+    }
+
+    for (size_t s = 0; s < suites.size(); s++) {
+        int numTests = 0;
+        int numFailed = 0;
+        int numSkipped = 0;
+        uint64_t wall_us = 0;
+        uint64_t dumpBytes = 0;
+        uint64_t rssPeak_kb = 0;
+        IoCounters io;
+        for (size_t i = firstRecord; i < mRecords.size(); i++) {
+            if ((mRecords[i].grpName != suites[s].first) ||
+                (mRecords[i].loop != suites[s].second)) {
+                continue;
+            }
+            numTests++;
+            wall_us += mRecords[i].wall_us;
+            io += mRecords[i].io;
+            dumpBytes += mRecords[i].dumpBytes;
+            rssPeak_kb = MAX(rssPeak_kb, mRecords[i].rssPeak_kb);
+            if (mRecords[i].result == TR_FAIL)
+                numFailed++;
+            else if (mRecords[i].result == TR_SKIPPING)
+                numSkipped++;
+        }
+
+        // Every loop reruns the same tests, tell their testcases apart
+        string loop;
+        if (gCmdLine.loop > 1)
+            loop = str(boost::format(" loop %ld") % suites[s].second);
+
+        fprintf(mSuitesFp, "  <testsuite name=\"%s%s\" tests=\"%d\" "
+            "failures=\"%d\" skipped=\"%d\" time=\"%s\">\n",
+            Escape(suites[s].first, true).c_str(), loop.c_str(), numTests,
+            numFailed, numSkipped,
+            str(boost::format("%.6f") % (wall_us / 1000000.0)).c_str());
+        WriteProperties(mSuitesFp, io, dumpBytes, rssPeak_kb);
+
+        for (size_t i = firstRecord; i < mRecords.size(); i++) {
+            ResultRecord &rec = mRecords[i];
+            if ((rec.grpName != suites[s].first) ||
+                (rec.loop != suites[s].second)) {
+                continue;
+            }
+
+            fprintf(mSuitesFp, "    <testcase classname=\"%s\" "
+                "name=\"%s %s%s\" time=\"%s\"",
+                Escape(rec.grpName, true).c_str(), rec.tr.ToString().c_str(),
+                Escape(rec.className, true).c_str(), loop.c_str(),
+                str(boost::format("%.6f") % (rec.wall_us / 1000000.0)).c_str());
+            if (rec.result == TR_FAIL) {
+                fprintf(mSuitesFp, ">\n      <failure message=\"%s\"/>\n"
+                    "    </testcase>\n", Escape((rec.failure.empty() ?
+                    TestResults::getDesc(rec.result) : rec.failure),
+                    true).c_str());
+            } else if (rec.result == TR_SKIPPING) {
+                fprintf(mSuitesFp, ">\n      <skipped/>\n    </testcase>\n");
+            } else {
+                fprintf(mSuitesFp, ">\n");
+                WriteProperties(mSuitesFp, rec.io, rec.dumpBytes,
+                    rec.rssPeak_kb);
+                fprintf(mSuitesFp, "    </testcase>\n");
+            }
+        }
+        fprintf(mSuitesFp, "  </testsuite>\n");
+    }
+}
+
+
+bool
+ResultsWriter::WriteJUnit()
+{
+    string filename = mBasename + ".xml";
+    char buf[4096];
+    size_t len;
+    FILE *fp;
+
+    if ((fp = fopen(filename.c_str(), "w")) == NULL) {
+        LOG_ERR("Unable to open results file: %s", filename.c_str());
+        return false;
+    }
+
+    fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(fp, "<testsuites name=\"%s\">\n", APPNAME);
+    rewind(mSuitesFp);
+    while ((len = fread(buf, 1, sizeof(buf), mSuitesFp)) != 0)
+        fwrite(buf, 1, len, fp);
+    fprintf(fp, "</testsuites>\n");
+
+    bool ok = (ferror(mSuitesFp) == 0);
+    if ((fclose(fp) != 0) || (ok == false)) {
+        LOG_ERR("Unable to write results file: %s", filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+void
+ResultsWriter::WriteProperties(FILE *fp, const IoCounters &io,
+    uint64_t dumpBytes, uint64_t rssPeak_kb)
+{
+    const struct {
+        const char *name;
+        uint64_t value;
+    } prop[] = {
+        { "ioctls",         io.numIoctls },
+        { "ioctl_us",       io.ioctl_us },
+        { "cmds",           io.numCmds },
+        { "bytes_to_dev",   io.numBytesToDev },
+        { "bytes_from_dev", io.numBytesFromDev },
+        { "allocs",         io.numAllocs },
+        { "alloc_bytes",    io.numAllocBytes },
+        { "dump_bytes",     dumpBytes },
+        { "rss_peak_kb",    rssPeak_kb }
+    };
+
+    fprintf(fp, "      <properties>\n");
+    for (size_t i = 0; i < (sizeof(prop) / sizeof(prop[0])); i++) {
+        fprintf(fp, "        <property name=\"%s\" value=\"%llu\"/>\n",
+            prop[i].name, (unsigned long long)prop[i].value);
+    }
+    fprintf(fp, "      </properties>\n");
+}
+
+
+string
+ResultsWriter::Escape(string raw, bool xml)
+{
+    string work;
+
+    for (size_t i = 0; i < raw.length(); i++) {
+        char c = raw[i];
+        if (xml) {
+            switch (c) {
+            case '&':   work += "&amp;";    break;
+            case '<':   work += "&lt;";     break;
+            case '>':   work += "&gt;";     break;
+            case '"':   work += "&quot;";   break;
+            default:    work += c;          break;
+            }
+        } else if ((c == '"') || (c == '\\')) {
+            work += '\\';
+            work += c;
+        } else if ((unsigned char)c < 0x20) {
+            work += str(boost::format("\\u%04x") % (int)c);
+        } else {
+            work += c;
+        }
+    }
+    return work;
+}
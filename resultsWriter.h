@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _RESULTSWRITER_H_
+#define _RESULTSWRITER_H_
+
+#include <string>
+#include <vector>
+#include "testRef.h"
+#include "testResults.h"
+#include "Utils/ioStats.h"
+
+
+/**
+ * The outcome of a single test case as reported by Group::RunTest().
+ */
+struct ResultRecord {
+    TestRef     tr;             // the test's number
+    std::string grpName;        // Group::GetClassName()
+    std::string className;      // Test::GetClassName()
+    TestResult  result;
+    std::string failure;        // Test::GetFailure(), empty unless TR_FAIL
+    size_t      loop;           // --loop iteration, stamped by Record()
+    uint64_t    wall_us;        // wall clock time spent in the test
+    IoCounters  io;             // dnvme interactions attributed to the test
+    std::vector<std::string> dumps;  // files the test dumped, or archived
+    uint64_t    dumpBytes;      // total size of those files, uncompressed
+    uint64_t    rssPeak_kb;     // peak resident set size of tnvme so far
+    uint64_t    rssGrowth_kb;   // growth of that peak during the test
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It accounts for the host side resources every test
+* consumed, logging a summary per group. It also produces the machine
+* readable results requested by cmd line option --results. One JSON object
+* per line (JSON Lines) is appended to \<basename\>.jsonl and flushed as each
+* test completes, thus a harness may follow the run as it progresses and
+* nothing is lost if tnvme dies. As every group completes its records are
+* summarized into a JUnit testsuite and forgotten, upon Close() the testsuites
+* are written as JUnit XML, \<basename\>.xml.
+*
+* @note This class will not throw exceptions.
+*/
+class ResultsWriter
+{
+public:
+    ResultsWriter();
+    virtual ~ResultsWriter();
+
+    /**
+     * Start streaming records. The JSON Lines file is appended to, rather
+     * than truncated, so that a --resume continues the original stream.
+     * @param basename Pass the filename w/o extension of both output files
+     * @return true upon success, otherwise false
+     */
+    static bool Open(std::string basename);
+
+    /// @return true if records are being streamed, i.e. Open() succeeded
+    static bool IsOpen() { return (mFp != NULL); }
+
+    /**
+     * Remember a record for the summaries, streaming it if IsOpen().
+     * @param rec Pass the outcome of the test to report
+     */
+    static void Record(const ResultRecord &rec);
+
+    /// @return The number of records remembered so far
+    static size_t GetNumRecords() { return mRecords.size(); }
+
+    /// @param loop Pass the --loop iteration subsequent records belong to
+    static void SetLoop(size_t loop) { mLoop = loop; }
+
+    /**
+     * Log the resources consumed by a group's tests, highlighting those
+     * tests and ioctl's which dominate its runtime. The group's records are
+     * forgotten afterwards, if IsOpen() once summarized into a testsuite.
+     * @param grpName Pass the name of the group, i.e. Group::GetClassName()
+     * @param firstRecord Pass GetNumRecords() from when the group started
+     */
+    static void LogSummary(std::string grpName, size_t firstRecord);
+
+    /**
+     * Stop streaming records and write the JUnit XML file describing every
+     * record issued since Open(), does nothing unless IsOpen().
+     * @return true upon success, otherwise false
+     */
+    static bool Close();
+
+
+private:
+    static std::string mBasename;
+    static FILE *mFp;
+    static FILE *mSuitesFp;
+    static size_t mLoop;
+    static std::vector<ResultRecord> mRecords;
+
+    static std::string Escape(std::string raw, bool xml);
+    static bool MoreWall(size_t a, size_t b);
+    static void Forget(size_t firstRecord);
+    static void WriteSuites(size_t firstRecord);
+    static bool WriteJUnit();
+    static void WriteProperties(FILE *fp, const IoCounters &io,
+        uint64_t dumpBytes, uint64_t rssPeak_kb);
+};
+
+
+#endif
@@ -41,7 +41,7 @@ Test::~Test()
 Test::Test(const Test &other) :
     mSpecRev(other.mSpecRev), mGrpName(other.mGrpName),
     mTestName(other.mTestName), mTestDesc(other.mTestDesc),
-    mResult(other.mResult)
+    mResult(other.mResult), mFailure(other.mFailure)
 
 {
     ///////////////////////////////////////////////////////////////////////////
@@ -63,13 +63,22 @@ Test::operator=(const Test &other)
     mTestName = other.mTestName;
     mTestDesc = other.mTestDesc;
     mResult = other.mResult;
+    mFailure = other.mFailure;
     return *this;
 }
 
 
+void
+Test::Reset()
+{
+    mResult = TR_SUCCESS;
+}
+
+
 TestResult
 Test::Run()
 {
+    mFailure.clear();
     try {
         ResetStatusRegErrors();
         KernelAPI::DumpKernelMetrics(FileSystem::PrepDumpFile(mGrpName,
@@ -78,11 +87,15 @@ Test::Run()
         RunCoreTest();  // Throws upon errors, returns upon success
 
         // What do the PCI registers say about errors that may have occurred?
-        if (GetStatusRegErrors() == false)
+        if (GetStatusRegErrors() == false) {
+            mFailure = "Status registers report errors";
             return TR_FAIL;
+        }
     } catch (FrmwkEx &ex) {
+        mFailure = ex.GetMessage();
         return TR_FAIL;
     } catch (...) {
+        mFailure = "Unsupported exception";
         // If this exception is thrown from some library which tnvme links
         // with then there is nothing that can be done about this. However,
         // If the source of this exception is source within the compliance
@@ -102,11 +115,14 @@ Test::Run()
 Test::RunType
 Test::Runnable(bool preserve)
 {
+    mFailure.clear();
     try {
         return RunnableCoreTest(preserve);  // Throws upon errors
     } catch (FrmwkEx &ex) {
+        mFailure = ex.GetMessage();
         return RUN_FAIL;
     } catch (...) {
+        mFailure = "Unsupported exception";
         // If this exception is thrown from some library which tnvme links
         // with then there is nothing that can be done about this. However,
         // If the source of this exception is source within the compliance
@@ -37,10 +37,10 @@
 * 2) Utilize class RsrcMngr to create objects to pass to subsequent tests which
 *    are all part of the same group.
 * 3) Heap allocations taken during test execution, and not under the control
-*    of the RsrcMngr, must be deleted in destructor.
+*    of the RsrcMngr, must be deleted in destructor and in Reset().
 * 4) The creation of member variables is allowed but special attention to
-*    copy construction and operator=() must be implemented in all children.
-*    See the comment in Test::Clone() for complete details.
+*    copy construction, operator=() and Reset() must be implemented in all
+*    children. See the comment in Test::Clone() for complete details.
 * 5) Execute dbgMemLeak.sh to find any memory leaks as a result of adding and
 *    running any new test cases.
 * -----------------------------------------------------------------------------
@@ -103,6 +103,12 @@ public:
      */
     TestResult Run();
 
+    /**
+     * Get the reason the last Run() or Runnable() failed.
+     * @return The message of the FrmwkEx thrown, empty if nothing failed
+     */
+    string GetFailure() { return mFailure; }
+
     typedef enum {
         RUN_TRUE,       // Test is runnable and should be run
         RUN_FALSE,      // Test is not runnable, this is not an error
@@ -127,10 +133,11 @@ public:
     virtual RunType Runnable(bool preserve);
 
     /**
-     * Cloning objects are necessary to support automated resource cleanup
-     * between subsequent test case runs. This is the cleanup action of test
-     * lifetimes. Objects are cloned, then freed after each test completes to
-     * force resource cleanup. This cloning uses special copy construction and
+     * Cloning objects was once the cleanup action of test lifetimes; objects
+     * were cloned, then freed after each test completed to force resource
+     * cleanup. Reset() now serves that purpose, but copies must remain safe
+     * for any framework code duplicating a test. This cloning uses special
+     * copy construction and
      * operator=() to achieve proper resource cleanup. The end result of a
      * clone action should be to re-create a new object w/o doing any copying of
      * pointers. Do not do shallow or deep copies of any pointer. Any pointer
@@ -145,6 +152,16 @@ public:
     Test &operator=(const Test &other);
     Test(const Test &other);
 
+    /**
+     * Return this object to the state it had after construction so the same
+     * instance can be run again. Test objects are reused for every run,
+     * rather than cloned and destroyed, thus children adding member
+     * variables must override this to release/reinitialize them, and must
+     * call Test::Reset(). Test lifetime objects should remain local to
+     * RunCoreTest() so they are destroyed when it returns or throws.
+     */
+    virtual void Reset();
+
 
 protected:
     ///////////////////////////////////////////////////////////////////////////
@@ -160,6 +177,8 @@ protected:
     TestDescribe mTestDesc;
     /// The test result type; default is success
     TestResult mResult;
+    /// Why the test last failed; default is empty
+    string mFailure;
 
     /**
      * Forcing children to implement the core logic of each test case.
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "tnvme.h"
+#include "testDag.h"
+
+
+TestDag::TestDag()
+{
+}
+
+
+TestDag::~TestDag()
+{
+}
+
+
+void
+TestDag::Build(const vector<TestRef> &tests)
+{
+    mNodes = tests;
+    mEdges.clear();
+    mEdges.resize(mNodes.size());
+
+    for (size_t n = 0; n < mNodes.size(); n++) {
+        TestRef tr = mNodes[n];
+        DepEdge edge;
+
+        if (tr.zLev != 0) {
+            // Sequence dependency upon the preceding test within the yLev
+            TestRef prev(tr.group, tr.xLev, tr.yLev, (tr.zLev - 1));
+            if (FindNode(n, prev, edge.on)) {
+                edge.type = DEP_SEQUENCE;
+                mEdges[n].push_back(edge);
+            }
+        } else if (tr.yLev != 0) {
+            // The root of every yLev branch is configured by x.0.0, which
+            // also allocates the group lifetime resources the branch uses
+            TestRef config(tr.group, tr.xLev, 0, 0);
+            if (FindNode(n, config, edge.on)) {
+                edge.type = DEP_CONFIG;
+                mEdges[n].push_back(edge);
+                edge.type = DEP_RESOURCE;
+                mEdges[n].push_back(edge);
+            }
+        }
+    }
+}
+
+
+bool
+TestDag::DependsOn(size_t node, size_t ancestor)
+{
+    if ((node >= mNodes.size()) || (ancestor >= node))
+        return false;
+
+    for (size_t e = 0; e < mEdges[node].size(); e++) {
+        if ((mEdges[node][e].on == ancestor) ||
+            DependsOn(mEdges[node][e].on, ancestor)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool
+TestDag::GetResourceProvider(size_t node, size_t &provider)
+{
+    // The resource dependency of a sequence is that of its root
+    while (node < mNodes.size()) {
+        bool seq = false;
+        for (size_t e = 0; e < mEdges[node].size(); e++) {
+            if (mEdges[node][e].type == DEP_RESOURCE) {
+                provider = mEdges[node][e].on;
+                return true;
+            } else if (mEdges[node][e].type == DEP_SEQUENCE) {
+                node = mEdges[node][e].on;
+                seq = true;
+                break;
+            }
+        }
+        if (seq == false)
+            break;
+    }
+    return false;
+}
+
+
+void
+TestDag::Log()
+{
+    for (size_t n = 0; n < mNodes.size(); n++) {
+        for (size_t e = 0; e < mEdges[n].size(); e++) {
+            LOG_DBG("%s depends upon %s (%s)", mNodes[n].ToString().c_str(),
+                mNodes[mEdges[n][e].on].ToString().c_str(),
+                DepTypeStr(mEdges[n][e].type));
+        }
+    }
+}
+
+
+const char *
+TestDag::DepTypeStr(DepType type)
+{
+    switch (type) {
+    case DEP_CONFIG:    return "config";
+    case DEP_SEQUENCE:  return "sequence";
+    case DEP_RESOURCE:  return "resource";
+    default:            return "unknown";
+    }
+}
+
+
+bool
+TestDag::FindNode(size_t numNodes, TestRef tr, size_t &node)
+{
+    // Seek the closest preceding match, a test may appear again when it is
+    // rerun to re-establish resources
+    for (size_t n = MIN(numNodes, mNodes.size()); n > 0; n--) {
+        if (mNodes[n - 1] == tr) {
+            node = (n - 1);
+            return true;
+        }
+    }
+    return false;
+}
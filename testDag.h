@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _TESTDAG_H_
+#define _TESTDAG_H_
+
+#include <vector>
+#include "testRef.h"
+
+
+/// The kinds of dependency one test may have upon another
+typedef enum {
+    DEP_CONFIG,     // x.y.0 upon x.0.0: needs the config it established
+    DEP_SEQUENCE,   // x.y.z upon x.y.(z-1): needs the state it left behind
+    DEP_RESOURCE,   // x.y.0 upon x.0.0: needs its RsrcMngr objs to be alive
+    DEPTYPE_FENCE   // always must be last element
+} DepType;
+
+/// A directed edge, the owning node depends upon node index 'on'
+struct DepEdge {
+    size_t  on;
+    DepType type;
+};
+
+
+/**
+* This class makes explicit the test dependencies that the x.y.z numbering
+* only implies, see https://github.com/nvmecompliance/tnvme/wiki/Test-Numbering.
+* The nodes are an ordered test set as returned by Group::GetTestSet(), thus
+* a node only ever depends upon nodes preceding it. Besides answering which
+* tests must be skipped when another does not succeed, the DAG reveals which
+* test re-establishes the resources a subsequent independent branch needs.
+*
+* @note This class will not throw exceptions.
+*/
+class TestDag
+{
+public:
+    TestDag();
+    virtual ~TestDag();
+
+    /**
+     * Discard any previous graph and derive the nodes and edges anew.
+     * @param tests Pass the ordered test set the graph describes
+     */
+    void Build(const std::vector<TestRef> &tests);
+
+    size_t GetNumNodes() { return mNodes.size(); }
+    TestRef GetTest(size_t node) { return mNodes[node]; }
+    const std::vector<DepEdge> &GetDeps(size_t node) { return mEdges[node]; }
+
+    /**
+     * @param node Pass the node to consider
+     * @param ancestor Pass the node which may be depended upon
+     * @return true if node directly or transitively depends upon ancestor
+     */
+    bool DependsOn(size_t node, size_t ancestor);
+
+    /**
+     * Find the node which creates the resources the spec'd node consumes.
+     * @param node Pass the node to consider
+     * @param provider Returns the node index of the provider
+     * @return true if node has a resource dependency, otherwise false
+     */
+    bool GetResourceProvider(size_t node, size_t &provider);
+
+    /// Log the graph at debug verbosity
+    void Log();
+
+    static const char *DepTypeStr(DepType type);
+
+
+private:
+    std::vector<TestRef> mNodes;
+    /// mEdges[n] lists every direct dependency of mNodes[n]
+    std::vector<std::vector<DepEdge> > mEdges;
+
+    bool FindNode(size_t numNodes, TestRef tr, size_t &node);
+};
+
+
+#endif
@@ -24,6 +24,7 @@ using namespace std;
 TestRef::TestRef()
 {
     group = 0; xLev = 0; yLev = 0; zLev = 0;
+    rerun = false;
 }
 
 
@@ -37,6 +38,7 @@ void
 TestRef::Init(size_t g, size_t x, size_t y, size_t z)
 {
     group = g; xLev = x; yLev = y; zLev = z;
+    rerun = false;
 }
 
 
@@ -30,6 +30,9 @@ struct TestRef {
     size_t  xLev;
     size_t  yLev;
     size_t  zLev;
+    /// Reruns the test only to recreate resources the following tests need,
+    /// it isn't a result of its own; see Group::AdvanceDependencies()
+    bool    rerun;
 
     TestRef();
     TestRef(size_t g, size_t x, size_t y, size_t z);
@@ -59,6 +59,12 @@ public:
      */
     void addResult(TestResult testResult, int amount = 1);
 
+    /**
+     * @param testResult the result to retrieve the count of
+     * @return The count for the given test result
+     */
+    int getResult(TestResult testResult) const { return results[testResult]; }
+
     /**
      * Do all currently reported results signify passing status?
      *
@@ -74,6 +80,13 @@ public:
      */
     void report(const size_t numIters, const int numGrps) const;
 
+    /**
+     * @param testResult Pass the result to describe
+     * @return The description of the result, i.e. "passed"
+     */
+    static const char *getDesc(TestResult testResult)
+        { return resultDesc[testResult]; }
+
 protected:
     virtual TestResults &assign(const TestResults &other);
 
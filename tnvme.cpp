@@ -31,6 +31,14 @@
 #include "globals.h"
 #include "Utils/kernelAPI.h"
 #include "Utils/fileSystem.h"
+#include "Utils/ioStats.h"
+#include "Utils/ioTrace.h"
+#include "Utils/dumpArchive.h"
+#include "Queues/timeouts.h"
+#include "Queues/writeShadow.h"
+#include "checkpoint.h"
+#include "resultsWriter.h"
+#include "Utils/workload.h"
 
 
 // ------------------------------EDIT HERE---------------------------------
@@ -65,43 +73,69 @@
 
 char revision_warning[1024];
 
-void
-InstantiateGroups(vector<Group *> &groups)
-{
+/// Groups are only constructed, along with all their tests, when selected
+typedef Group *(*GroupFactory)(size_t grpNum);
+template <class T> Group *NewGroup(size_t grpNum) { return new T(grpNum); }
+
+static const GroupFactory GROUP_FACTORY[] = {
     // Appending new groups is the most favorable action here
-    groups.push_back(new GrpPciRegisters::GrpPciRegisters(groups.size()));
-    groups.push_back(new GrpCtrlRegisters::GrpCtrlRegisters(groups.size()));
-    groups.push_back(new GrpBasicInit::GrpBasicInit(groups.size()));
-    groups.push_back(new GrpResets::GrpResets(groups.size()));
-    groups.push_back(new GrpGeneralCmds::GrpGeneralCmds(groups.size()));
+    &NewGroup<GrpPciRegisters::GrpPciRegisters>,
+    &NewGroup<GrpCtrlRegisters::GrpCtrlRegisters>,
+    &NewGroup<GrpBasicInit::GrpBasicInit>,
+    &NewGroup<GrpResets::GrpResets>,
+    &NewGroup<GrpGeneralCmds::GrpGeneralCmds>,
     // Following is assigned grp ID=5
-    groups.push_back(new GrpQueues::GrpQueues(groups.size()));
-    groups.push_back(new GrpNVMReadCmd::GrpNVMReadCmd(groups.size()));
-    groups.push_back(new GrpNVMWriteCmd::GrpNVMWriteCmd(groups.size()));
-    groups.push_back(new GrpNVMWriteReadCombo::GrpNVMWriteReadCombo(groups.size()));
-    groups.push_back(new GrpNVMFlushCmd::GrpNVMFlushCmd(groups.size()));
+    &NewGroup<GrpQueues::GrpQueues>,
+    &NewGroup<GrpNVMReadCmd::GrpNVMReadCmd>,
+    &NewGroup<GrpNVMWriteCmd::GrpNVMWriteCmd>,
+    &NewGroup<GrpNVMWriteReadCombo::GrpNVMWriteReadCombo>,
+    &NewGroup<GrpNVMFlushCmd::GrpNVMFlushCmd>,
     // Following is assigned grp ID=10
-    groups.push_back(new GrpInterrupts::GrpInterrupts(groups.size()));
-    groups.push_back(new GrpNVMWriteUncorrectCmd::GrpNVMWriteUncorrectCmd(groups.size()));
-    groups.push_back(new GrpNVMDatasetMgmtCmd::GrpNVMDatasetMgmtCmd(groups.size()));
-    groups.push_back(new GrpNVMCompareCmd::GrpNVMCompareCmd(groups.size()));
-    groups.push_back(new GrpAdminDeleteIOCQCmd::GrpAdminDeleteIOCQCmd(groups.size()));
+    &NewGroup<GrpInterrupts::GrpInterrupts>,
+    &NewGroup<GrpNVMWriteUncorrectCmd::GrpNVMWriteUncorrectCmd>,
+    &NewGroup<GrpNVMDatasetMgmtCmd::GrpNVMDatasetMgmtCmd>,
+    &NewGroup<GrpNVMCompareCmd::GrpNVMCompareCmd>,
+    &NewGroup<GrpAdminDeleteIOCQCmd::GrpAdminDeleteIOCQCmd>,
     // Following is assigned grp ID=15
-    groups.push_back(new GrpAdminDeleteIOSQCmd::GrpAdminDeleteIOSQCmd(groups.size()));
-    groups.push_back(new GrpAdminCreateIOCQCmd::GrpAdminCreateIOCQCmd(groups.size()));
-    groups.push_back(new GrpAdminCreateIOSQCmd::GrpAdminCreateIOSQCmd(groups.size()));
-    groups.push_back(new GrpAdminCreateIOQCmd::GrpAdminCreateIOQCmd(groups.size()));
-    groups.push_back(new GrpAdminGetLogPgCmd::GrpAdminGetLogPgCmd(groups.size()));
+    &NewGroup<GrpAdminDeleteIOSQCmd::GrpAdminDeleteIOSQCmd>,
+    &NewGroup<GrpAdminCreateIOCQCmd::GrpAdminCreateIOCQCmd>,
+    &NewGroup<GrpAdminCreateIOSQCmd::GrpAdminCreateIOSQCmd>,
+    &NewGroup<GrpAdminCreateIOQCmd::GrpAdminCreateIOQCmd>,
+    &NewGroup<GrpAdminGetLogPgCmd::GrpAdminGetLogPgCmd>,
     // Following is assigned grp ID=20
-    groups.push_back(new GrpAdminIdentifyCmd::GrpAdminIdentifyCmd(groups.size()));
-    groups.push_back(new GrpAdminSetFeatCmd::GrpAdminSetFeatCmd(groups.size()));
-    groups.push_back(new GrpAdminGetFeatCmd::GrpAdminGetFeatCmd(groups.size()));
-    groups.push_back(new GrpAdminSetGetFeatCombo::GrpAdminSetGetFeatCombo(groups.size()));
-    groups.push_back(new GrpAdminAsyncCmd::GrpAdminAsyncCmd(groups.size()));
+    &NewGroup<GrpAdminIdentifyCmd::GrpAdminIdentifyCmd>,
+    &NewGroup<GrpAdminSetFeatCmd::GrpAdminSetFeatCmd>,
+    &NewGroup<GrpAdminGetFeatCmd::GrpAdminGetFeatCmd>,
+    &NewGroup<GrpAdminSetGetFeatCombo::GrpAdminSetGetFeatCombo>,
+    &NewGroup<GrpAdminAsyncCmd::GrpAdminAsyncCmd>,
     // Following is assigned grp ID=25
-    groups.push_back(new GrpReservationsHostA::GrpReservationsHostA(groups.size()));
-    groups.push_back(new GrpReservationsHostB::GrpReservationsHostB(groups.size()));
-    groups.push_back(new GrpAdminNamespaceManagement::GrpAdminNamespaceManagement(groups.size()));
+    &NewGroup<GrpReservationsHostA::GrpReservationsHostA>,
+    &NewGroup<GrpReservationsHostB::GrpReservationsHostB>,
+    &NewGroup<GrpAdminNamespaceManagement::GrpAdminNamespaceManagement>
+};
+#define NUM_GROUPS  (sizeof(GROUP_FACTORY) / sizeof(GroupFactory))
+
+
+void
+InstantiateGroups(vector<Group *> &groups)
+{
+    // Reserve a slot per group, GetGroup() constructs it upon 1st use
+    groups.assign(NUM_GROUPS, NULL);
+}
+
+
+/**
+ * Construct the spec'd group, and thereby its tests, if not already done.
+ * @param groups Pass the structure populated by InstantiateGroups()
+ * @param grpNum Pass the group number, must be < groups.size()
+ * @return The group object
+ */
+Group *
+GetGroup(vector<Group *> &groups, size_t grpNum)
+{
+    if (groups[grpNum] == NULL)
+        groups[grpNum] = GROUP_FACTORY[grpNum](grpNum);
+    return groups[grpNum];
 }
 // ------------------------------EDIT HERE---------------------------------
 
@@ -156,9 +190,30 @@ Usage(void) {
     printf("                                      tests; verifying fields are zero value\n");
     printf("  -c(--setad)                         Set the AD bit for Dataset Management\n");
     printf("                                      tests\n");
+    printf("  -B(--bench)                         Execute the optional benchmark tests;\n");
+    printf("                                      measuring rather than verifying the DUT\n");
     printf("  -y(--restore)                       Upon test failure, allow an individual\n");
     printf("                                      test to restore the configuration of the\n");
     printf("                                      DUT as was detected at group start\n");
+    printf("  -K(--checkpoint) <filename>         Persist the progress of --test in file\n");
+    printf("                                      after every test completes\n");
+    printf("  -R(--resume)                        Continue the --test run interrupted at\n");
+    printf("                                      the --checkpoint file's progress; the\n");
+    printf("                                      cmd line must otherwise be identical\n");
+    printf("  -O(--results) <basename>            Stream a JSON record per test to file\n");
+    printf("                                      <basename>.jsonl as tests complete and\n");
+    printf("                                      write JUnit XML to <basename>.xml\n");
+    printf("  -Y(--trace) <filename>              Record every ioctl to dnvme, the cmds\n");
+    printf("                                      and CE's, into a binary trace file\n");
+    printf("  -P(--replay) <filename>[:max]       Reissue the cmd stream of a --trace\n");
+    printf("                                      file w/o the test logic; :max ignores\n");
+    printf("                                      the original timing. Must be only option\n");
+    printf("  -A(--archive) <filename>            Write every dump of the run, compressed,\n");
+    printf("                                      into a single archive file rather than\n");
+    printf("                                      into individual files\n");
+    printf("  -X(--extract) <filename>[:<dir>]    Recreate the dump files of an --archive\n");
+    printf("                                      beneath <dir>, default is the current\n");
+    printf("                                      dir. Must be only option\n");
     printf("  -m(--fwimage)                       Supply a FW image to allow testing of\n");
     printf("                                      FW activate and FW image dnld cmds.\n");
     printf("                                      Recommend supply identical FW image as\n");
@@ -187,6 +242,16 @@ Usage(void) {
     printf("                                      access width <acc>={l | w | b} type\n");
     printf("                                      (Require: <size> < 8)\n");
     printf("                                      <offset:size> requires base 16 values\n");
+    printf("  -x(--mempolicy) <policy>[,<policy>] Back data buffers and discontig IOQ's by\n");
+    printf("                                      <policy>={huge2m | huge1g | numa |\n");
+    printf("                                      prefault}; numa binds to the DUT's node\n");
+    printf("  -j(--soak) <wraps:sec>              Keep IOQ pairs full in the IOQ rollover\n");
+    printf("                                      tests until <wraps> wraps or <sec> secs\n");
+    printf("                                      elapse; 0=no limit. Requires base 10\n");
+    printf("  -T(--adaptiveto)                    Replace the fixed CALC_TIMEOUT_ms() by\n");
+    printf("                                      timeouts adapted from the latencies\n");
+    printf("                                      observed during the run; waits cut\n");
+    printf("                                      short by adapting fail the test\n");
 }
 
 
@@ -205,7 +270,8 @@ main(int argc, char *argv[])
     bool deviceFound = false;
     bool accessingHdw = true;
     uint64_t regVal = 0;
-    const char *short_opt = "hsnbclpyzia::t::v:o:d:k:f:r:w:q:e:m:u:g:";
+    const char *short_opt =
+        "hsnbclpyzia::t::v:o:d:k:f:r:w:q:e:m:u:g:x:j:TBK:RO:Y:P:A:X:";
     static struct option long_opt[] = {
         // {name,           has_arg,            flag,   val}
         {   "detail",       optional_argument,  NULL,   'a'},
@@ -223,6 +289,14 @@ main(int argc, char *argv[])
         {   "dump",         required_argument,  NULL,   'u'},
         {   "golden",       required_argument,  NULL,   'g'},
         {   "fwimage",      required_argument,  NULL,   'm'},
+        {   "mempolicy",    required_argument,  NULL,   'x'},
+        {   "soak",         required_argument,  NULL,   'j'},
+        {   "checkpoint",   required_argument,  NULL,   'K'},
+        {   "results",      required_argument,  NULL,   'O'},
+        {   "trace",        required_argument,  NULL,   'Y'},
+        {   "replay",       required_argument,  NULL,   'P'},
+        {   "archive",      required_argument,  NULL,   'A'},
+        {   "extract",      required_argument,  NULL,   'X'},
 
         {   "help",         no_argument,        NULL,   'h'},
         {   "summary",      no_argument,        NULL,   's'},
@@ -234,6 +308,9 @@ main(int argc, char *argv[])
         {   "postfail",     no_argument,        NULL,   'n'},
         {   "rsvdfields",   no_argument,        NULL,   'b'},
         {   "setad",        no_argument,        NULL,   'c'},
+        {   "adaptiveto",   no_argument,        NULL,   'T'},
+        {   "bench",        no_argument,        NULL,   'B'},
+        {   "resume",       no_argument,        NULL,   'R'},
         {   NULL,           no_argument,        NULL,    0}
     };
 
@@ -363,6 +440,20 @@ main(int argc, char *argv[])
             }
             break;
 
+        case 'x':
+            if (ParseMemPolicyCmdLine(gCmdLine.memPolicy, optarg) == false) {
+                printf("Unable to parse --mempolicy cmd line\n");
+                exit(1);
+            }
+            break;
+
+        case 'j':
+            if (ParseSoakCmdLine(gCmdLine.soak, optarg) == false) {
+                printf("Unable to parse --soak cmd line\n");
+                exit(1);
+            }
+            break;
+
         case 'd':
             work = optarg;
             for (size_t i = 0; i < devices.size(); i++) {
@@ -418,6 +509,37 @@ main(int argc, char *argv[])
             gCmdLine.dump = optarg;
             break;
 
+        case 'K':
+            gCmdLine.checkpoint = optarg;
+            break;
+
+        case 'O':
+            gCmdLine.results = optarg;
+            break;
+
+        case 'Y':
+            gCmdLine.trace = optarg;
+            break;
+
+        case 'P':
+            if (ParseReplayCmdLine(gCmdLine.replay, optarg) == false) {
+                printf("Unable to parse --replay cmd line\n");
+                exit(1);
+            }
+            break;
+
+        case 'A':
+            gCmdLine.archive = optarg;
+            break;
+
+        case 'X':
+            if (ParseExtractCmdLine(gCmdLine.extract, optarg) == false) {
+                printf("Unable to parse --extract cmd line\n");
+                exit(1);
+            }
+            accessingHdw = false;
+            break;
+
         default:
         case 'h':   Usage();                            exit(0);
         case '?':   Usage();                            exit(1);
@@ -428,6 +550,9 @@ main(int argc, char *argv[])
         case 'b':   gCmdLine.rsvdfields = true;         break;
         case 'c':   gCmdLine.setAD = true;              break;
         case 'y':   gCmdLine.restore = true;            break;
+        case 'T':   gCmdLine.adaptiveTO = true;         break;
+        case 'B':   gCmdLine.bench = true;              break;
+        case 'R':   gCmdLine.resume = true;             break;
         }
     }
 
@@ -440,9 +565,22 @@ main(int argc, char *argv[])
         Usage();
         exit(1);
     }
+    if (gCmdLine.resume && gCmdLine.checkpoint.empty()) {
+        printf("Option --resume requires --checkpoint <filename>\n");
+        exit(1);
+    }
 
     try {   // Everything below has the ability to throw exceptions
 
+        // Tracing starts before the device is opened to capture everything
+        if (gCmdLine.trace.empty() == false) {
+            if (IoTrace::Start(gCmdLine.trace) == false) {
+                printf("Unable to trace into \"%s\"\n",
+                    gCmdLine.trace.c_str());
+                exit(1);
+            }
+        }
+
         // Instantiates and initializes all globals defined within globals.h
         if (BuildTestFoundation(groups) == false) {
             printf("Unable to build the test foundation\n");
@@ -456,12 +594,28 @@ main(int argc, char *argv[])
                     gCmdLine.dump.c_str());
                 exit(1);
             }
+            if (gCmdLine.archive.empty() == false) {
+                if (DumpArchive::Open(gCmdLine.archive) == false) {
+                    printf("Unable to archive dumps into \"%s\"\n",
+                        gCmdLine.archive.c_str());
+                    exit(1);
+                }
+            }
+
+            MemBuffer::SetAllocPolicy(gCmdLine.memPolicy, gCmdLine.device);
 
             if (BuildSingletons() == false) {
                 printf("Unable to instantiate mandatory framework objects\n");
                 exit(1);
             }
 
+            if (gRegisters->Read(CTLSPC_CAP, regVal) == false) {
+                printf("Unable to read CAP to seed cmd timeouts\n");
+                exit(1);
+            }
+            Timeouts::Init(gCmdLine.adaptiveTO,
+                (uint8_t)((regVal & CAP_TO) >> 24));
+
             printf("Checking for unintended device under low powered states\n");
             if (gRegisters->Read(PCISPC_PMCS, regVal) == false) {
                 printf("Mandatory PMCAP PCI capabilities is missing\n");
@@ -472,7 +626,21 @@ main(int argc, char *argv[])
         }
 
         // Process the user's cmd line parameters
-        if (gCmdLine.golden.req) {
+        if (gCmdLine.extract.req) {
+            if ((exitCode = !DumpArchive::Extract(gCmdLine.extract.file,
+                gCmdLine.extract.dir))) {
+                printf("FAILURE: extracting dump archive\n");
+            } else {
+                printf("SUCCESS: extracting dump archive\n");
+            }
+        } else if (gCmdLine.replay.req) {
+            if ((exitCode = !IoTrace::Replay(gDutFd, gCmdLine.replay.file,
+                gCmdLine.replay.maxSpeed))) {
+                printf("FAILURE: replay diverged from trace\n");
+            } else {
+                printf("SUCCESS: replay\n");
+            }
+        } else if (gCmdLine.golden.req) {
             if ((exitCode = !CompareGolden(gCmdLine.golden))) {
                 printf("FAILURE: Comparing golden data\n");
             } else {
@@ -492,17 +660,19 @@ main(int argc, char *argv[])
             }
         } else if (gCmdLine.summary) {
             for (size_t i = 0; i < groups.size(); i++) {
-                FORMAT_GROUP_DESCRIPTION(work, groups[i])
+                Group *grp = GetGroup(groups, i);
+                FORMAT_GROUP_DESCRIPTION(work, grp)
                 printf("%s\n", work.c_str());
-                printf("%s", groups[i]->GetGroupSummary(false).c_str());
+                printf("%s", grp->GetGroupSummary(false).c_str());
             }
 
         } else if (gCmdLine.detail.req) {
             if (gCmdLine.detail.t.group == UINT_MAX) {
                 for (size_t i = 0; i < groups.size(); i++) {
-                    FORMAT_GROUP_DESCRIPTION(work, groups[i])
+                    Group *grp = GetGroup(groups, i);
+                    FORMAT_GROUP_DESCRIPTION(work, grp)
                     printf("%s\n", work.c_str());
-                    printf("%s", groups[i]->GetGroupSummary(true).c_str());
+                    printf("%s", grp->GetGroupSummary(true).c_str());
                 }
 
             } else {    // user spec'd a group they are interested in
@@ -512,7 +682,8 @@ main(int argc, char *argv[])
                 } else {
                     for (size_t i = 0; i < groups.size(); i++) {
                         if (i == gCmdLine.detail.t.group) {
-                            FORMAT_GROUP_DESCRIPTION(work, groups[i])
+                            Group *grp = GetGroup(groups, i);
+                            FORMAT_GROUP_DESCRIPTION(work, grp)
                             printf("%s\n", work.c_str());
 
                             if ((gCmdLine.detail.t.xLev == UINT_MAX) ||
@@ -520,10 +691,10 @@ main(int argc, char *argv[])
                                 (gCmdLine.detail.t.zLev == UINT_MAX)) {
                                 // Want info on all tests within group
                                 printf("%s",
-                                    groups[i]->GetGroupSummary(true).c_str());
+                                    grp->GetGroupSummary(true).c_str());
                             } else {
                                 // Want info on spec'd test within group
-                                printf("%s", groups[i]->GetTestDescription(true,
+                                printf("%s", grp->GetTestDescription(true,
                                     gCmdLine.detail.t).c_str());
                                 break;
                             }
@@ -548,11 +719,20 @@ main(int argc, char *argv[])
             // At this point we cannot enable the ctrlr because that requires
             // ACQ/ASQ's to be created, ctrlr simply won't become ready w/o them
         } else if (gCmdLine.test.req) {
+            if (gCmdLine.results.empty() == false) {
+                if (ResultsWriter::Open(gCmdLine.results) == false)
+                    printf("Unable to stream results, continuing without\n");
+            }
             if ((exitCode = !ExecuteTests(gCmdLine, groups))) {
                 printf("FAILURE: testing\n");
             } else {
                 printf("SUCCESS: testing\n");
             }
+            if (ResultsWriter::Close() == false)
+                printf("Unable to write results: %s\n",
+                    gCmdLine.results.c_str());
+            Timeouts::Report();
+            WriteShadow::Report();
             printf("%s", revision_warning);
         }
     } catch (...) {
@@ -560,6 +740,11 @@ main(int argc, char *argv[])
     }
 
     // cleanup duties
+    IoTrace::Stop();
+    if (DumpArchive::Close() == false)
+        printf("Dump archive may be incomplete: %s\n",
+            gCmdLine.archive.c_str());
+    FileSystem::WaitForCleanup();
     DestroyTestFoundation(groups);
     DestroySingletons();
     gCmdLine.skiptest.clear();
@@ -670,7 +855,7 @@ BuildTestFoundation(vector<Group *> &groups)
     }
 
     // Validate the dnvme was compiled with the same version of API as tnvme
-    ret = ioctl(gDutFd, NVME_IOCTL_GET_DRIVER_METRICS, &driverMetrics);
+    ret = IoStats::Ioctl(gDutFd, NVME_IOCTL_GET_DRIVER_METRICS, &driverMetrics);
     if (ret < 0) {
         LOG_ERR("Unable to extract driver version information");
         return false;
@@ -702,8 +887,8 @@ BuildTestFoundation(vector<Group *> &groups)
 void
 DestroyTestFoundation(vector<Group *> &groups)
 {
-    // Deallocate heap usage
-    for (size_t i = 0; i < groups.size(); i++) {
+    // Deallocate heap usage, never instantiated groups remain NULL
+    while (groups.size()) {
         delete groups.back();
         groups.pop_back();
     }
@@ -717,6 +902,39 @@ DestroyTestFoundation(vector<Group *> &groups)
 }
 
 
+/**
+ * Persist the progress of ExecuteTests(), if requested by cmd line option
+ * --checkpoint; failing to do so is reported but never stops testing.
+ * @param cl Pass the cmd line parameters
+ * @param ckpt Pass the loop/group/completed test cursor to persist, its
+ *        elapsed_us must hold the time spent by prior attempts
+ * @param start Pass the time at which this attempt started
+ * @param numGrps Pass the number of groups started so far
+ * @param results Pass the results accumulated so far
+ * @param failedTests Pass the failed tests so far
+ * @param skippedTests Pass the skipped tests so far
+ */
+void
+SaveCheckpoint(struct CmdLine &cl, CheckpointState ckpt,
+    const struct timeval &start, int numGrps, const TestResults &results,
+    const vector<TestRef> &failedTests, const vector<TestRef> &skippedTests)
+{
+    struct timeval now;
+
+    if (cl.checkpoint.empty())
+        return;
+
+    if (gettimeofday(&now, NULL) == 0)
+        ckpt.elapsed_us += Workload::ElapsedUsec(start, now);
+    ckpt.numGrps = numGrps;
+    ckpt.results = results;
+    ckpt.failedTests = failedTests;
+    ckpt.skippedTests = skippedTests;
+    if (Checkpoint::Save(cl.checkpoint, ckpt) == false)
+        LOG_WARN("Unable to checkpoint, a --resume would repeat tests");
+}
+
+
 /**
  * A function to execute the desired test case(s). Param ignore
  * indicates that when an error is reported from a test case, it is ignored to
@@ -734,6 +952,7 @@ ExecuteTests(struct CmdLine &cl, vector<Group *> &groups)
     int64_t tstIdx = 0;
     int64_t skipped = 0;
     size_t iLoop;
+    size_t iLoopStart = 0;
     int numGrps = 0;
     TestResults results = TestResults();
     TestRef targetTst;
@@ -741,6 +960,11 @@ ExecuteTests(struct CmdLine &cl, vector<Group *> &groups)
     bool tstSetOK;
     vector<TestRef> failedTests;
     vector<TestRef> skippedTests;
+    bool dutPristine = false;   // untouched since the last group's reset?
+    CheckpointState ckpt;
+    bool resuming = false;
+    struct timeval start;
+    struct timeval now;
 
     if ((cl.test.t.group != UINT_MAX) && (cl.test.t.group >= groups.size())) {
         LOG_ERR("Specified test group does not exist");
@@ -765,10 +989,45 @@ ExecuteTests(struct CmdLine &cl, vector<Group *> &groups)
             cl.test.t.group, cl.test.t.xLev, cl.test.t.yLev, cl.test.t.zLev);
     }
 
-    for (iLoop = 0; iLoop < cl.loop; iLoop++) {
+    if (cl.resume) {
+        if (Checkpoint::Load(cl.checkpoint, ckpt) == false) {
+            LOG_ERR("Unable to resume from checkpoint");
+            goto ABORT_OUT;
+        } else if ((ckpt.target == cl.test.t) == false) {
+            LOG_ERR("Checkpoint targets test %s, not that of the cmd line",
+                ckpt.target.ToString().c_str());
+            goto ABORT_OUT;
+        } else if (ckpt.numLoops != cl.loop) {
+            LOG_ERR("Checkpoint loops %ld times, not %ld", ckpt.numLoops,
+                cl.loop);
+            goto ABORT_OUT;
+        }
+        LOG_NRM("Resuming loop #%ld, group %ld, after %ld completed test(s)",
+            ckpt.loop, ckpt.group, ckpt.done.size());
+        iLoopStart = ckpt.loop;
+        numGrps = ckpt.numGrps;
+        results = ckpt.results;
+        failedTests = ckpt.failedTests;
+        skippedTests = ckpt.skippedTests;
+        resuming = true;
+    } else {
+        ckpt.elapsed_us = 0;
+    }
+    ckpt.target = cl.test.t;
+    ckpt.numLoops = cl.loop;
+    if (gettimeofday(&start, NULL) != 0) {
+        LOG_ERR("Cannot retrieve system time");
+        goto ABORT_OUT;
+    }
+
+    for (iLoop = iLoopStart; iLoop < cl.loop; iLoop++) {
         LOG_NRM("Start loop execution #%ld", iLoop);
+        ResultsWriter::SetLoop(iLoop);
 
         for (size_t iGrp = 0; iGrp < groups.size(); iGrp++) {
+            if (resuming && (iGrp < ckpt.group))
+                continue;
+
             LOG_DBG("Processing test(s) for group %ld", iGrp);
             if (cl.test.t.group == UINT_MAX) {
                 targetTst.Init(iGrp, UINT_MAX, UINT_MAX, UINT_MAX);
@@ -782,42 +1041,106 @@ ExecuteTests(struct CmdLine &cl, vector<Group *> &groups)
             LOG_NRM("Executing a new group, start from known point");
             if (FileSystem::CleanDumpDir() == false)
                 LOG_WARN("Unable to cleanup dump between group runs");
-            if (gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY) == false)
+            // Groups whose tests were all skipped never touched the DUT,
+            // resetting again would only cost time; --restore may touch it
+            if (dutPristine && (cl.restore == false)) {
+                LOG_NRM("DUT untouched since last reset, eliding reset");
+            } else if (gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY) == false) {
                 goto ABORT_OUT;
+            }
+            dutPristine = true;
 
-            tstSetOK = groups[iGrp]->GetTestSet(targetTst, testsToRun, tstIdx);
+            Group *grp = GetGroup(groups, iGrp);
+            tstSetOK = grp->GetTestSet(targetTst, testsToRun, tstIdx);
             if (tstSetOK == false) {
                 LOG_ERR("Unable to get execution test set");
                 goto ABORT_OUT;
             }
 
-            numGrps++;
+            // Tests completed prior to the interruption only run again when
+            // remaining tests depend upon them, passing they aren't recounted
+            int64_t numReplay = 0;
+            if (resuming && ckpt.done.size()) {
+                grp->ResumeTestSet(ckpt.done, testsToRun, tstIdx, numReplay);
+            } else {
+                numGrps++;
+                ckpt.done.clear();
+            }
+            resuming = false;
+
+            size_t firstRecord = ResultsWriter::GetNumRecords();
             TestResult result = TR_FENCE;
             while (result != TR_NOTFOUND) {
-                result = groups[iGrp]->RunTest(testsToRun, tstIdx, cl.skiptest,
+                int64_t ranIdx = tstIdx;
+                result = grp->RunTest(testsToRun, tstIdx, cl.skiptest,
                     skipped, cl.preserve, failedTests, skippedTests);
+                if ((result != TR_SKIPPING) && (result != TR_NOTFOUND))
+                    dutPristine = false;
+                if (result == TR_NOTFOUND)
+                    break;
 
-                if (result == TR_SKIPPING)
+                // Record every test RunTest() advanced past as completed
+                int64_t nextIdx = ((tstIdx == -1) ?
+                    (int64_t)testsToRun.size() : tstIdx);
+                bool rerun = testsToRun[ranIdx].rerun;
+                for (int64_t i = ranIdx; i < nextIdx; i++) {
+                    if ((i >= numReplay) && (testsToRun[i].rerun == false))
+                        ckpt.done.push_back(testsToRun[i]);
+                }
+                if (rerun) {
+                    // Only the tests a rerun caused to be skipped count
+                    if (skipped)
+                        results.addResult(TR_SKIPPING, skipped);
+                } else if ((ranIdx < numReplay) && (result == TR_SUCCESS)) {
+                    // Already counted prior to resuming
+                } else if (result == TR_SKIPPING) {
                     results.addResult(result, skipped);
-                else {
+                } else {
                     results.addResult(result);
-                    if (result == TR_FAIL) {
+                    if (result == TR_FAIL)
                         results.addResult(TR_SKIPPING, skipped);
-                        if (cl.ignore) {
-                            LOG_WARN("Detected error, but forced to ignore");
-                        } else {
-                            goto EARLY_OUT;
-                        }
+                }
+
+                ckpt.loop = iLoop;
+                ckpt.group = iGrp;
+                SaveCheckpoint(cl, ckpt, start, numGrps, results, failedTests,
+                    skippedTests);
+
+                if (result == TR_FAIL) {
+                    if (cl.ignore) {
+                        LOG_WARN("Detected error, but forced to ignore");
+                    } else {
+                        ResultsWriter::LogSummary(grp->GetClassName(),
+                            firstRecord);
+                        goto EARLY_OUT;
                     }
                 }
             }
+            ResultsWriter::LogSummary(grp->GetClassName(), firstRecord);
+
+            ckpt.group = (iGrp + 1);
+            ckpt.done.clear();
+            SaveCheckpoint(cl, ckpt, start, numGrps, results, failedTests,
+                skippedTests);
         }
 
+        resuming = false;   // the interrupted loop may have no group left
+
         // Report each iteration results
         results.report(iLoop, numGrps);
 
         if (failedTests.size() || skippedTests.size())
             ReportExecution(failedTests, skippedTests);
+
+        ckpt.loop = (iLoop + 1);
+        ckpt.group = 0;
+        SaveCheckpoint(cl, ckpt, start, numGrps, results, failedTests,
+            skippedTests);
+    }
+    if (gettimeofday(&now, NULL) == 0) {
+        LOG_NRM("Elapsed time, all attempts: %llu sec",
+            (unsigned long long)((ckpt.elapsed_us +
+            Workload::ElapsedUsec(start, now)) / 1000000));
     }
     return results.allTestsPass();
 
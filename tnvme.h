@@ -47,6 +47,8 @@ using namespace std;
 
 #define MAX_CHAR_PER_LINE_DESCRIPTION       63
 
+// CALC_TIMEOUT_ms() is the caller's budget; when --adaptiveto is spec'd the
+// CQ wait routines substitute a timeout learned by Queues/timeouts.h
 #define DFLT_TIMEOUT_ms                     10000   // 10s
 #define PER_CMD_TIMEOUT_ms                  20
 #define CALC_TIMEOUT_ms(numCmds)    \
@@ -169,6 +171,32 @@ struct FWImage {
     vector<uint8_t>     data;   // Array of raw FW binary bytes to program
 };
 
+struct Soak {
+    bool                req;        // Requested by cmd line
+    uint64_t            wraps;      // Stop after this many wraps, 0=no limit
+    uint32_t            seconds;    // Stop after this many sec's, 0=no limit
+};
+
+struct Replay {
+    bool                req;        // Requested by cmd line
+    string              file;       // Trace file recorded by --trace
+    bool                maxSpeed;   // Ignore the trace's original timing
+};
+
+struct Extract {
+    bool                req;        // Requested by cmd line
+    string              file;       // Archive recorded by --archive
+    string              dir;        // Recreate the dump files beneath here
+};
+
+struct MemPolicy {
+    bool                req;        // Requested by cmd line
+    bool                huge2MB;    // Back large buffers with 2MB hugepages
+    bool                huge1GB;    // Back large buffers with 1GB hugepages
+    bool                numa;       // Bind buffers to the DUT's NUMA node
+    bool                prefault;   // Touch every page at allocation time
+};
+
 
 struct CmdLine {
     bool            summary;
@@ -179,6 +207,9 @@ struct CmdLine {
     bool            rsvdfields;
     bool            preserve;
     bool            setAD;
+    bool            adaptiveTO;
+    bool            bench;
+    bool            resume;
     size_t          loop;
     SpecRev         rev;
     TestTarget      detail;
@@ -193,6 +224,14 @@ struct CmdLine {
     NumQueues       numQueues;
     ErrorRegs       errRegs;
     string          dump;
+    string          checkpoint;
+    string          results;
+    string          trace;
+    string          archive;
+    MemPolicy       memPolicy;
+    Soak            soak;
+    Replay          replay;
+    Extract         extract;
 };
 
 extern char revision_warning[1024];
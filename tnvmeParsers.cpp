@@ -1156,3 +1156,157 @@ ParseQueuesCmdLine(NumQueues &numQueues, const char *optarg)
 
     return true;
 }
+
+
+/**
+ * A function to specifically handle parsing cmd lines of the form
+ * "--mempolicy <policy>[,<policy>...]" where <policy> is one of
+ * {huge2m | huge1g | numa | prefault}.
+ * @param memPolicy Pass a structure to populate with parsing results
+ * @param optarg Pass the 'optarg' argument from the getopt_long() API.
+ * @return true upon successful parsing, otherwise false.
+ */
+bool
+ParseMemPolicyCmdLine(MemPolicy &memPolicy, const char *optarg)
+{
+    string swork;
+    string policy;
+    size_t pos;
+
+    memPolicy.req = true;
+    memPolicy.huge2MB = false;
+    memPolicy.huge1GB = false;
+    memPolicy.numa = false;
+    memPolicy.prefault = false;
+
+    swork = optarg;
+    do {
+        pos = swork.find_first_of(',');
+        policy = swork.substr(0, pos);
+        if (policy.compare("huge2m") == 0) {
+            memPolicy.huge2MB = true;
+        } else if (policy.compare("huge1g") == 0) {
+            memPolicy.huge1GB = true;
+        } else if (policy.compare("numa") == 0) {
+            memPolicy.numa = true;
+        } else if (policy.compare("prefault") == 0) {
+            memPolicy.prefault = true;
+        } else {
+            LOG_ERR("Unrecognized <policy>=%s", policy.c_str());
+            return false;
+        }
+        if (pos != string::npos)
+            swork = swork.substr(pos + 1);
+    } while (pos != string::npos);
+
+    return true;
+}
+
+
+/**
+ * A function to specifically handle parsing cmd lines of the form
+ * "--soak <wraps:sec>".
+ * @param soak Pass a structure to populate with parsing results
+ * @param optarg Pass the 'optarg' argument from the getopt_long() API.
+ * @return true upon successful parsing, otherwise false.
+ */
+bool
+ParseSoakCmdLine(Soak &soak, const char *optarg)
+{
+    char *endptr;
+    string swork;
+    unsigned long long tmp;
+
+    soak.req = true;
+    soak.wraps = 0;
+    soak.seconds = 0;
+
+    // Parsing <wraps:sec>
+    swork = optarg;
+    tmp = strtoull(swork.c_str(), &endptr, 10);
+    if (*endptr != ':') {
+        LOG_ERR("Unrecognized format <wraps:sec>=%s", optarg);
+        return false;
+    }
+    soak.wraps = tmp;
+
+    // Parsing <sec>
+    swork = swork.substr(swork.find_first_of(':') + 1, swork.length());
+    if (swork.length() == 0) {
+        LOG_ERR("Missing <sec> format string");
+        return false;
+    }
+    tmp = strtoull(swork.c_str(), &endptr, 10);
+    if (*endptr != '\0') {
+        LOG_ERR("Unrecognized format <sec>=%s", optarg);
+        return false;
+    } else if (tmp > ((uint32_t)(-1))) {
+        LOG_ERR("<sec> > allowed max value of %u", ((uint32_t)(-1)));
+        return false;
+    }
+    soak.seconds = (uint32_t)tmp;
+
+    if ((soak.wraps == 0) && (soak.seconds == 0)) {
+        LOG_ERR("Either <wraps> or <sec> must be non-zero, never ending soak");
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * A function to specifically handle parsing cmd lines of the form
+ * "--replay <filename>[:max]".
+ * @param replay Pass a structure to populate with parsing results
+ * @param optarg Pass the 'optarg' argument from the getopt_long() API.
+ * @return true upon successful parsing, otherwise false.
+ */
+bool
+ParseReplayCmdLine(Replay &replay, const char *optarg)
+{
+    size_t colLoc;
+
+    replay.req = true;
+    replay.file = optarg;
+    replay.maxSpeed = false;
+
+    // Parsing <filename>[:max]
+    if ((colLoc = replay.file.find_last_of(':')) != string::npos) {
+        if (replay.file.substr(colLoc + 1) != "max") {
+            LOG_ERR("Unrecognized format <filename>[:max]=%s", optarg);
+            return false;
+        }
+        replay.maxSpeed = true;
+        replay.file = replay.file.substr(0, colLoc);
+    }
+    if (replay.file.length() == 0) {
+        LOG_ERR("Missing <filename> format string");
+        return false;
+    }
+    return true;
+}
+
+
+bool
+ParseExtractCmdLine(Extract &extract, const char *optarg)
+{
+    size_t colLoc;
+
+    extract.req = true;
+    extract.file = optarg;
+    extract.dir = ".";
+
+    // Parsing <filename>[:<dir>]
+    if ((colLoc = extract.file.find_last_of(':')) != string::npos) {
+        extract.dir = extract.file.substr(colLoc + 1);
+        extract.file = extract.file.substr(0, colLoc);
+    }
+    if (extract.file.length() == 0) {
+        LOG_ERR("Missing <filename> format string");
+        return false;
+    } else if (extract.dir.length() == 0) {
+        LOG_ERR("Missing <dir> format string");
+        return false;
+    }
+    return true;
+}
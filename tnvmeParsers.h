@@ -31,6 +31,10 @@ bool ParseRmmapCmdLine(RmmapIo &rmmap, const char *optarg);
 bool ParseWmmapCmdLine(WmmapIo &wmmap, const char *optarg);
 bool ParseQueuesCmdLine(NumQueues &numQueues, const char *optarg);
 bool ParseErrorCmdLine(ErrorRegs &errRegs, const char *optarg);
+bool ParseMemPolicyCmdLine(MemPolicy &memPolicy, const char *optarg);
+bool ParseSoakCmdLine(Soak &soak, const char *optarg);
+bool ParseReplayCmdLine(Replay &replay, const char *optarg);
+bool ParseExtractCmdLine(Extract &extract, const char *optarg);
 bool SeekSpecificXMLNode(xmlpp::TextReader &xmlFile, string nodeName,
     int nodeDepth, string &nodeVal, vector<string> &nodeAttrib);
 bool ExtractFormatXMLValue(xmlpp::TextReader &xmlFile, FormatDUT &cmd,
@@ -20,6 +20,7 @@
 
 
 SharedTrackablePtr Trackable::NullTrackablePtr;
+uint64_t Trackable::mNumAlive = 0;
 
 
 Trackable::Trackable(ObjType objBeingCreated)
@@ -28,11 +29,19 @@ Trackable::Trackable(ObjType objBeingCreated)
         throw FrmwkEx(HERE, "Illegal constructor");
 
     mObjType = objBeingCreated;
+    mNumAlive++;
+}
+
+
+Trackable::Trackable(const Trackable &other) : mObjType(other.mObjType)
+{
+    mNumAlive++;
 }
 
 
 Trackable::~Trackable()
 {
+    mNumAlive--;
     LOG_DBG("Destroying trackable obj: %s", GetObjName(mObjType).c_str());
 }
 
@@ -66,6 +75,7 @@ Trackable::GetObjName(ObjType obj)
     case OBJ_NVMCMD:        name = "NVMCmd";             break;
     case OBJ_WRITE:         name = "Write";              break;
     case OBJ_READ:          name = "Read";               break;
+    case OBJ_COMPARE:       name = "Compare";            break;
     case OBJ_FLUSH:         name = "Flush";              break;
     case OBJ_DATASETMGMT:   name = "DatasetMgmt";        break;
     case OBJ_WRITEZEROES:         name = "WriteZeroes";               break; // Not yet implemented
@@ -63,6 +63,7 @@ public:
         OBJ_NVMCMD,             // NVM cmd set; non descriptive general cmd
         OBJ_WRITE,              // NVM cmd set; write cmd
         OBJ_READ,               // NVM cmd set; write cmd
+        OBJ_COMPARE,            // NVM cmd set; compare cmd
         OBJ_FLUSH,              // NVM cmd set; flush cmd
         OBJ_DATASETMGMT,        // NVM cmd set; dataset mgmt cmd
 		OBJ_WRITEZEROES,		// NVM Spec 1.1 cmds
@@ -82,8 +83,15 @@ public:
      * @param objBeingCreated Pass the type of object this child class is
      */
     Trackable(ObjType objBeingCreated);
+    Trackable(const Trackable &other);
     virtual ~Trackable();
 
+    /**
+     * @return The number of trackable objects presently alive, in support of
+     *      detecting objects a test leaves behind; see Group::RunTest()
+     */
+    static uint64_t GetNumAlive() { return mNumAlive; }
+
     /// Used to compare for NULL pointers being returned by allocations
     static SharedTrackablePtr NullTrackablePtr;
 
@@ -95,6 +103,8 @@ private:
     Trackable() {}
 
     ObjType mObjType;
+
+    static uint64_t mNumAlive;
 };
 
 